@@ -67,6 +67,10 @@ public:
 	{
 		this->CameraFrustrum = frustrum; this->RecalculateMatrix();
 	}
+	const Frustrum& GetFrustrum() const
+	{
+		return this->CameraFrustrum;
+	}
 
 protected:
 	/**
@@ -0,0 +1,195 @@
+/**
+* @file Attacks.cpp
+*
+* @brief Building the attack tables and finding the magic numbers of the sliding
+*        pieces when the program starts
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Attacks.h"
+
+#include <vector>
+
+namespace Attacks {
+	Bitboard PawnTable[ColorCount][SquareCount];
+	Bitboard KnightTable[SquareCount];
+	Bitboard KingTable[SquareCount];
+	Magic BishopMagics[SquareCount];
+	Magic RookMagics[SquareCount];
+	Bitboard BetweenTable[SquareCount][SquareCount];
+	Bitboard LineTable[SquareCount][SquareCount];
+}
+
+namespace {
+	//Attacks of all occupancies of every square, 2^12 for a rook in a corner down to 2^5
+	Bitboard RookAttackTable[0x19000];
+	Bitboard BishopAttackTable[0x1480];
+
+	const int RookDirections[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	const int BishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+	//Xorshift generator, fixed seeds make the magic search take the same few steps every start
+	class MagicRandom {
+	public:
+		explicit MagicRandom(std::uint64_t seed) : State(seed) {}
+
+		std::uint64_t Next()
+		{
+			State ^= State >> 12;
+			State ^= State << 25;
+			State ^= State >> 27;
+			return State * 2685821657736338717ULL;
+		}
+
+		//Numbers with few bits set make good magic candidates
+		std::uint64_t NextSparse() { return Next() & Next() & Next(); }
+
+	private:
+		std::uint64_t State;
+	};
+
+	/**
+	* @brief Attacks of a piece sliding along the directions until it leaves the
+	*        board or hits an occupied square, which is attacked as well
+	*/
+	Bitboard SlidingAttacks(Square square, Bitboard occupied, const int (&directions)[4][2])
+	{
+		Bitboard attacks = 0;
+		for (const auto& direction : directions) {
+			int file = FileOf(square) + direction[0];
+			int rank = RankOf(square) + direction[1];
+			while (IsOnBoard(file, rank)) {
+				const Bitboard bit = SquareBit(MakeSquare(file, rank));
+				attacks |= bit;
+				if (occupied & bit)
+					break;
+				file += direction[0];
+				rank += direction[1];
+			}
+		}
+		return attacks;
+	}
+
+	//Squares reached by the steps from the square that stay on the board
+	Bitboard StepAttacks(Square square, const int (*steps)[2], int stepCount)
+	{
+		Bitboard attacks = 0;
+		for (int i = 0; i < stepCount; i++) {
+			const int file = FileOf(square) + steps[i][0];
+			const int rank = RankOf(square) + steps[i][1];
+			if (IsOnBoard(file, rank))
+				attacks |= SquareBit(MakeSquare(file, rank));
+		}
+		return attacks;
+	}
+
+	/**
+	* @brief Finds a magic number for every square, so all occupancies of its mask
+	*        that give different attacks land on different entries of the table
+	*/
+	void InitMagics(Attacks::Magic* magics, Bitboard* table, const int (&directions)[4][2])
+	{
+		static const std::uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+		const Bitboard rank1 = 0xFFULL, rank8 = rank1 << 56;
+		const Bitboard fileA = 0x0101010101010101ULL, fileH = fileA << 7;
+
+		std::vector<Bitboard> occupancy(4096), reference(4096);
+		std::vector<int> epoch(4096, 0);
+		int attempt = 0;
+		Bitboard* nextTable = table;
+
+		for (int s = 0; s < SquareCount; s++) {
+			const Square square = static_cast<Square>(s);
+			Attacks::Magic& magic = magics[s];
+			const Bitboard edges = ((rank1 | rank8) & ~(rank1 << 8 * RankOf(square))) |
+								   ((fileA | fileH) & ~(fileA << FileOf(square)));
+			magic.Mask = SlidingAttacks(square, 0, directions) & ~edges;
+			magic.Shift = 64 - PopCount(magic.Mask);
+			magic.Table = nextTable;
+
+			//Every subset of the mask with the attacks it gives
+			int size = 0;
+			Bitboard subset = 0;
+			do {
+				occupancy[size] = subset;
+				reference[size] = SlidingAttacks(square, subset, directions);
+				size++;
+				subset = (subset - magic.Mask) & magic.Mask;
+			} while (subset != 0);
+
+			//Candidates are tried until one maps the subsets without a harmful collision. The
+			//epoch marks the entries written by the current candidate, so the table is not cleared
+			MagicRandom random(seeds[RankOf(square)]);
+			for (int i = 0; i < size;) {
+				do magic.Number = random.NextSparse();
+				while (PopCount((magic.Number * magic.Mask) >> 56) < 6);
+
+				attempt++;
+				for (i = 0; i < size; i++) {
+					const unsigned index = magic.GetIndex(occupancy[i]);
+					if (epoch[index] < attempt) {
+						epoch[index] = attempt;
+						nextTable[index] = reference[i];
+					}
+					else if (nextTable[index] != reference[i])
+						break;
+				}
+			}
+			nextTable += size;
+		}
+	}
+
+	void InitStepTables()
+	{
+		static const int knightSteps[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 },
+											   { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+		static const int kingSteps[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 },
+											 { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+		static const int whitePawnSteps[2][2] = { { -1, 1 }, { 1, 1 } };
+		static const int blackPawnSteps[2][2] = { { -1, -1 }, { 1, -1 } };
+
+		for (int s = 0; s < SquareCount; s++) {
+			const Square square = static_cast<Square>(s);
+			Attacks::KnightTable[s] = StepAttacks(square, knightSteps, 8);
+			Attacks::KingTable[s] = StepAttacks(square, kingSteps, 8);
+			Attacks::PawnTable[White][s] = StepAttacks(square, whitePawnSteps, 2);
+			Attacks::PawnTable[Black][s] = StepAttacks(square, blackPawnSteps, 2);
+		}
+	}
+
+	void InitLineTables()
+	{
+		for (int a = 0; a < SquareCount; a++) {
+			const Square from = static_cast<Square>(a);
+			for (int b = 0; b < SquareCount; b++) {
+				const Square to = static_cast<Square>(b);
+				Attacks::BetweenTable[a][b] = 0;
+				Attacks::LineTable[a][b] = 0;
+				if (a == b)
+					continue;
+				for (const auto* lines : { &RookDirections, &BishopDirections }) {
+					const auto& directions = *lines;
+					if (!(SlidingAttacks(from, 0, directions) & SquareBit(to)))
+						continue;
+					//The line is where the empty board attacks of both squares overlap, plus the squares
+					Attacks::LineTable[a][b] = (SlidingAttacks(from, 0, directions) & SlidingAttacks(to, 0, directions)) |
+											   SquareBit(from) | SquareBit(to);
+					Attacks::BetweenTable[a][b] = SlidingAttacks(from, SquareBit(to), directions) &
+												  SlidingAttacks(to, SquareBit(from), directions);
+				}
+			}
+		}
+	}
+
+	//Builds the tables before main, so the lookups never check whether they exist
+	struct TableInitializer {
+		TableInitializer()
+		{
+			InitStepTables();
+			InitMagics(Attacks::RookMagics, RookAttackTable, RookDirections);
+			InitMagics(Attacks::BishopMagics, BishopAttackTable, BishopDirections);
+			InitLineTables();
+		}
+	} Initializer;
+}
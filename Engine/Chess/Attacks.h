@@ -0,0 +1,66 @@
+/**
+* @file Attacks.h
+*
+* @brief Precomputed attack tables. Pawns, knights and kings look their attacks
+*        up by square. Sliding pieces use magic bitboards: the occupied squares on
+*        the rays of a square are multiplied by a magic number, and the top bits
+*        of the product index a table holding the attacks for that occupancy.
+*        The tables are built once when the program starts.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef ATTACKS_H_
+#define ATTACKS_H_
+
+#include "ChessTypes.h"
+
+namespace Attacks {
+	//Magic hashing of the occupancy relevant to a sliding piece on one square
+	struct Magic {
+		Bitboard Mask;				//Squares on the rays that can block, the board edges excluded
+		Bitboard Number;
+		const Bitboard* Table;		//Attacks for every occupancy of the mask
+		unsigned Shift;
+
+		inline unsigned GetIndex(Bitboard occupied) const
+		{
+			return static_cast<unsigned>(((occupied & Mask) * Number) >> Shift);
+		}
+	};
+
+	//The tables, filled at startup. Use the functions below to read them
+	extern Bitboard PawnTable[ColorCount][SquareCount];
+	extern Bitboard KnightTable[SquareCount];
+	extern Bitboard KingTable[SquareCount];
+	extern Magic BishopMagics[SquareCount];
+	extern Magic RookMagics[SquareCount];
+	extern Bitboard BetweenTable[SquareCount][SquareCount];
+	extern Bitboard LineTable[SquareCount][SquareCount];
+
+	//Squares a pawn of the color attacks from the square
+	inline Bitboard Pawn(Color color, Square square) { return PawnTable[color][square]; }
+	inline Bitboard Knight(Square square) { return KnightTable[square]; }
+	inline Bitboard King(Square square) { return KingTable[square]; }
+
+	inline Bitboard Bishop(Square square, Bitboard occupied)
+	{
+		const Magic& magic = BishopMagics[square];
+		return magic.Table[magic.GetIndex(occupied)];
+	}
+
+	inline Bitboard Rook(Square square, Bitboard occupied)
+	{
+		const Magic& magic = RookMagics[square];
+		return magic.Table[magic.GetIndex(occupied)];
+	}
+
+	inline Bitboard Queen(Square square, Bitboard occupied) { return Bishop(square, occupied) | Rook(square, occupied); }
+
+	//Squares strictly between two squares on a rank, file or diagonal, empty otherwise
+	inline Bitboard Between(Square from, Square to) { return BetweenTable[from][to]; }
+	//The whole rank, file or diagonal through two squares, empty when they share none
+	inline Bitboard Line(Square from, Square to) { return LineTable[from][to]; }
+}
+
+#endif // ATTACKS_H_
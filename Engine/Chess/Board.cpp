@@ -0,0 +1,86 @@
+/**
+* @file Board.cpp
+*
+* @brief Keeping the bitboards and the mailbox of a board in step
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Board.h"
+
+#include <cassert>
+
+Board::Board()
+{
+	Clear();
+}
+
+void Board::Clear()
+{
+	Mailbox.fill(NoPiece);
+	for (Bitboard& pieces : ByType)
+		pieces = 0;
+	for (Bitboard& pieces : ByColor)
+		pieces = 0;
+}
+
+void Board::SetStartPosition()
+{
+	static const PieceType backRank[8] = { Rook, Knight, Bishop, Queen, King, Bishop, Knight, Rook };
+
+	Clear();
+	for (int file = 0; file < 8; file++) {
+		PutPiece(MakePiece(White, backRank[file]), MakeSquare(file, 0));
+		PutPiece(MakePiece(White, Pawn), MakeSquare(file, 1));
+		PutPiece(MakePiece(Black, Pawn), MakeSquare(file, 6));
+		PutPiece(MakePiece(Black, backRank[file]), MakeSquare(file, 7));
+	}
+}
+
+void Board::PutPiece(Piece piece, Square square)
+{
+	assert(piece != NoPiece && IsEmpty(square));
+	const Bitboard bit = SquareBit(square);
+	Mailbox[square] = piece;
+	ByType[TypeOf(piece)] |= bit;
+	ByColor[ColorOf(piece)] |= bit;
+}
+
+void Board::RemovePiece(Square square)
+{
+	const Piece piece = Mailbox[square];
+	assert(piece != NoPiece);
+	const Bitboard bit = SquareBit(square);
+	Mailbox[square] = NoPiece;
+	ByType[TypeOf(piece)] &= ~bit;
+	ByColor[ColorOf(piece)] &= ~bit;
+}
+
+void Board::MovePiece(Square from, Square to)
+{
+	const Piece piece = Mailbox[from];
+	assert(piece != NoPiece && IsEmpty(to));
+	const Bitboard fromTo = SquareBit(from) | SquareBit(to);
+	Mailbox[from] = NoPiece;
+	Mailbox[to] = piece;
+	ByType[TypeOf(piece)] ^= fromTo;
+	ByColor[ColorOf(piece)] ^= fromTo;
+}
+
+bool Board::IsConsistent() const
+{
+	Bitboard byType[PieceTypeCount] = {};
+	Bitboard byColor[ColorCount] = {};
+	for (int square = 0; square < SquareCount; square++) {
+		const Piece piece = Mailbox[square];
+		if (piece == NoPiece)
+			continue;
+		byType[TypeOf(piece)] |= SquareBit(static_cast<Square>(square));
+		byColor[ColorOf(piece)] |= SquareBit(static_cast<Square>(square));
+	}
+	for (int type = 0; type < PieceTypeCount; type++)
+		if (byType[type] != ByType[type])
+			return false;
+	return byColor[White] == ByColor[White] && byColor[Black] == ByColor[Black] &&
+		   (ByColor[White] & ByColor[Black]) == 0;
+}
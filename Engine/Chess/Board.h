@@ -0,0 +1,52 @@
+/**
+* @file Board.h
+*
+* @brief Placement of the pieces on a chess board. Every piece type and color has
+*        a bitboard of the squares it stands on, and a mailbox maps each square to
+*        the piece on it, so occupancy and piece lookups are O(1) either way.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include "ChessTypes.h"
+
+#include <array>
+
+class Board
+{
+public:
+	//An empty board
+	Board();
+
+	void Clear();
+	//The pieces of the initial position, white on ranks 1 and 2
+	void SetStartPosition();
+
+	//Places a piece on an empty square
+	void PutPiece(Piece piece, Square square);
+	//Takes the piece off an occupied square
+	void RemovePiece(Square square);
+	//Moves the piece on an occupied square to an empty one
+	void MovePiece(Square from, Square to);
+
+	inline Piece GetPiece(Square square) const { return Mailbox[square]; }
+	inline bool IsEmpty(Square square) const { return Mailbox[square] == NoPiece; }
+
+	inline Bitboard GetPieces(Color color, PieceType type) const { return ByType[type] & ByColor[color]; }
+	inline Bitboard GetPieces(PieceType type) const { return ByType[type]; }
+	inline Bitboard GetPieces(Color color) const { return ByColor[color]; }
+	inline Bitboard GetOccupied() const { return ByColor[White] | ByColor[Black]; }
+
+	//Whether the bitboards and the mailbox describe the same placement, for debug checks
+	bool IsConsistent() const;
+
+private:
+	std::array<Piece, SquareCount> Mailbox;
+	Bitboard ByType[PieceTypeCount];
+	Bitboard ByColor[ColorCount];
+};
+
+#endif // BOARD_H_
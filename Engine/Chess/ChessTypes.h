@@ -0,0 +1,87 @@
+/**
+* @file ChessTypes.h
+*
+* @brief Squares, pieces and 64 bit square sets of the chess board model. Square 0
+*        is a1 and square 63 is h8, so bit n of a bitboard is square n and the
+*        files run along the low bits of every rank.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef CHESSTYPES_H_
+#define CHESSTYPES_H_
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//Set of squares, bit n is square n
+typedef std::uint64_t Bitboard;
+
+enum Color { White, Black, ColorCount };
+
+enum PieceType { Pawn, Knight, Bishop, Rook, Queen, King, PieceTypeCount, NoPieceType = PieceTypeCount };
+
+//Pieces of both colors, the black pieces follow the white ones in PieceType order
+enum Piece {
+	WhitePawn, WhiteKnight, WhiteBishop, WhiteRook, WhiteQueen, WhiteKing,
+	BlackPawn, BlackKnight, BlackBishop, BlackRook, BlackQueen, BlackKing,
+	PieceCount, NoPiece = PieceCount
+};
+
+enum Square {
+	A1, B1, C1, D1, E1, F1, G1, H1,
+	A2, B2, C2, D2, E2, F2, G2, H2,
+	A3, B3, C3, D3, E3, F3, G3, H3,
+	A4, B4, C4, D4, E4, F4, G4, H4,
+	A5, B5, C5, D5, E5, F5, G5, H5,
+	A6, B6, C6, D6, E6, F6, G6, H6,
+	A7, B7, C7, D7, E7, F7, G7, H7,
+	A8, B8, C8, D8, E8, F8, G8, H8,
+	SquareCount, NoSquare = SquareCount
+};
+
+inline Square MakeSquare(int file, int rank) { return static_cast<Square>(rank * 8 + file); }
+inline int FileOf(Square square) { return square & 7; }
+inline int RankOf(Square square) { return square >> 3; }
+inline bool IsOnBoard(int file, int rank) { return file >= 0 && file < 8 && rank >= 0 && rank < 8; }
+
+inline Piece MakePiece(Color color, PieceType type) { return static_cast<Piece>(color * PieceTypeCount + type); }
+inline Color ColorOf(Piece piece) { return static_cast<Color>(piece / PieceTypeCount); }
+inline PieceType TypeOf(Piece piece) { return static_cast<PieceType>(piece % PieceTypeCount); }
+inline Color operator~(Color color) { return static_cast<Color>(color ^ Black); }
+
+inline Bitboard SquareBit(Square square) { return Bitboard(1) << square; }
+
+inline int PopCount(Bitboard bitboard)
+{
+#ifdef _MSC_VER
+	return static_cast<int>(__popcnt64(bitboard));
+#else
+	return __builtin_popcountll(bitboard);
+#endif
+}
+
+//Lowest square of a set that is not empty
+inline Square LowestSquare(Bitboard bitboard)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bitboard);
+	return static_cast<Square>(index);
+#else
+	return static_cast<Square>(__builtin_ctzll(bitboard));
+#endif
+}
+
+//Takes the lowest square out of a set that is not empty
+inline Square PopLowestSquare(Bitboard& bitboard)
+{
+	const Square square = LowestSquare(bitboard);
+	bitboard &= bitboard - 1;
+	return square;
+}
+
+#endif // CHESSTYPES_H_
@@ -0,0 +1,25 @@
+/**
+* @file Evaluate.cpp
+*
+* @brief Tapered material and piece-square evaluation
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Evaluate.h"
+
+#include <cassert>
+
+int Evaluate(const Position& position)
+{
+	assert(position.GetPieceSquareScore() == position.ComputePieceSquareScore() &&
+		   position.GetPhase() == position.ComputePhase());
+	const int score = PieceSquare::Taper(position.GetPieceSquareScore(), position.GetPhase());
+	return position.GetSideToMove() == White ? score : -score;
+}
+
+int EvaluateFull(const Position& position)
+{
+	const int score = PieceSquare::Taper(position.ComputePieceSquareScore(), position.ComputePhase());
+	return position.GetSideToMove() == White ? score : -score;
+}
@@ -0,0 +1,26 @@
+/**
+* @file Evaluate.h
+*
+* @brief Static evaluation of a position from material and piece-square tables,
+*        tapered from the middlegame to the endgame, in centipawns
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef EVALUATE_H_
+#define EVALUATE_H_
+
+#include "Position.h"
+
+/**
+* @brief Scores the position from the sums the position keeps up to date as it moves.
+*        Debug builds check them against EvaluateFull().
+*
+* @param position - Position to score
+* @return int - Score for the side to move, positive when it stands better
+*/
+int Evaluate(const Position& position);
+//Scores the position by summing the values of all its pieces
+int EvaluateFull(const Position& position);
+
+#endif // EVALUATE_H_
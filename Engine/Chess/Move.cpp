@@ -0,0 +1,22 @@
+/**
+* @file Move.cpp
+*
+* @brief Writing moves in UCI notation
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Move.h"
+
+std::string Move::ToUci() const
+{
+	if (IsNull())
+		return "0000";
+	const Square from = GetFrom();
+	const Square to = GetTo();
+	std::string text = { static_cast<char>('a' + FileOf(from)), static_cast<char>('1' + RankOf(from)),
+						 static_cast<char>('a' + FileOf(to)), static_cast<char>('1' + RankOf(to)) };
+	if (GetKind() == Promotion)
+		text += "nbrq"[GetPromotion() - Knight];
+	return text;
+}
@@ -0,0 +1,50 @@
+/**
+* @file Move.h
+*
+* @brief A chess move packed into 16 bits: the from and to squares, the kind of
+*        move and the piece a pawn is promoted to. Castling is stored as the move
+*        of the king, so every move reads like its UCI notation.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MOVE_H_
+#define MOVE_H_
+
+#include "ChessTypes.h"
+
+#include <cstdint>
+#include <string>
+
+enum MoveKind { NormalMove, Promotion, EnPassant, Castling };
+
+class Move
+{
+public:
+	//The null move, never generated
+	Move() : Data(0) {}
+	Move(Square from, Square to, MoveKind kind = NormalMove, PieceType promotion = Knight)
+		: Data(static_cast<std::uint16_t>(from | to << 6 | (promotion - Knight) << 12 | kind << 14)) {}
+
+	inline Square GetFrom() const { return static_cast<Square>(Data & 63); }
+	inline Square GetTo() const { return static_cast<Square>(Data >> 6 & 63); }
+	inline MoveKind GetKind() const { return static_cast<MoveKind>(Data >> 14); }
+	//Piece a promotion creates, only meaningful for promotions
+	inline PieceType GetPromotion() const { return static_cast<PieceType>((Data >> 12 & 3) + Knight); }
+
+	inline bool IsNull() const { return Data == 0; }
+	inline bool operator==(const Move& other) const { return Data == other.Data; }
+	inline bool operator!=(const Move& other) const { return Data != other.Data; }
+
+	//The packed move, for tables that store moves in 16 bits
+	inline std::uint16_t GetData() const { return Data; }
+	static inline Move FromData(std::uint16_t data) { Move move; move.Data = data; return move; }
+
+	//Long algebraic notation as UCI uses it, like e2e4 or e7e8q
+	std::string ToUci() const;
+
+private:
+	std::uint16_t Data;
+};
+
+#endif // MOVE_H_
@@ -0,0 +1,164 @@
+/**
+* @file MoveGen.cpp
+*
+* @brief Generating the legal moves of a position from its check and pin masks
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MoveGen.h"
+#include "Attacks.h"
+
+namespace {
+	//Adds a move to every target square
+	inline void AddMoves(MoveList& moves, Square from, Bitboard targets)
+	{
+		while (targets)
+			moves.Add(Move(from, PopLowestSquare(targets)));
+	}
+
+	//Adds a pawn move, as the four promotions when it reaches the last rank
+	inline void AddPawnMove(MoveList& moves, Square from, Square to, GenerationType type)
+	{
+		if (RankOf(to) == 0 || RankOf(to) == 7) {
+			moves.Add(Move(from, to, Promotion, Queen));
+			if (type == Captures)
+				return;
+			moves.Add(Move(from, to, Promotion, Knight));
+			moves.Add(Move(from, to, Promotion, Rook));
+			moves.Add(Move(from, to, Promotion, Bishop));
+		}
+		else moves.Add(Move(from, to));
+	}
+
+	//Whether a square is attacked by the color, with the given squares occupied
+	inline bool IsAttacked(const Board& board, Square square, Color by, Bitboard occupied)
+	{
+		return (Attacks::Pawn(~by, square) & board.GetPieces(by, Pawn)) ||
+			   (Attacks::Knight(square) & board.GetPieces(by, Knight)) ||
+			   (Attacks::King(square) & board.GetPieces(by, King)) ||
+			   (Attacks::Bishop(square, occupied) & (board.GetPieces(by, Bishop) | board.GetPieces(by, Queen))) ||
+			   (Attacks::Rook(square, occupied) & (board.GetPieces(by, Rook) | board.GetPieces(by, Queen)));
+	}
+}
+
+/**
+* @brief In double check only the king moves. Otherwise every piece is limited to the
+*        check mask, the squares that capture or block a single checker, and pinned
+*        pieces to the line through their king and pinner. En passant removes two pieces
+*        from a rank, so it is tested by looking for sliders at the king after the capture.
+*        Generating captures only narrows the target squares to the pieces of the other side,
+*        pawns also push to promote.
+*/
+void GenerateLegalMoves(const Position& position, MoveList& moves, GenerationType type)
+{
+	const Board& board = position.GetBoard();
+	const Color us = position.GetSideToMove();
+	const Color them = ~us;
+	const Bitboard ours = board.GetPieces(us);
+	const Bitboard theirs = board.GetPieces(them);
+	const Bitboard occupied = ours | theirs;
+	const Square king = position.GetKingSquare(us);
+	const Bitboard theirDiagonal = board.GetPieces(them, Bishop) | board.GetPieces(them, Queen);
+	const Bitboard theirStraight = board.GetPieces(them, Rook) | board.GetPieces(them, Queen);
+	const Bitboard checkers = position.GetAttackersTo(king, occupied) & theirs;
+
+	//The king may not stay on the line of a slider by stepping back along it, so it is taken off the board
+	const Bitboard targetSquares = type == Captures ? theirs : ~ours;
+	Bitboard kingTargets = Attacks::King(king) & targetSquares;
+	const Bitboard withoutKing = occupied ^ SquareBit(king);
+	while (kingTargets) {
+		const Square to = PopLowestSquare(kingTargets);
+		if (!IsAttacked(board, to, them, withoutKing))
+			moves.Add(Move(king, to));
+	}
+	if (checkers & (checkers - 1))
+		return;
+
+	const Bitboard checkMask = checkers ? Attacks::Between(king, LowestSquare(checkers)) | checkers : ~Bitboard(0);
+	const Bitboard targetMask = checkMask & targetSquares;
+
+	//A piece is pinned when it is the only piece between the king and a slider of the other side
+	Bitboard pinned = 0;
+	Bitboard pinners = (Attacks::Bishop(king, theirs) & theirDiagonal) | (Attacks::Rook(king, theirs) & theirStraight);
+	while (pinners) {
+		const Bitboard between = Attacks::Between(king, PopLowestSquare(pinners)) & occupied;
+		if (!(between & (between - 1)))
+			pinned |= between & ours;
+	}
+
+	//Pinned knights can never move
+	for (Bitboard pieces = board.GetPieces(us, Knight) & ~pinned; pieces;) {
+		const Square from = PopLowestSquare(pieces);
+		AddMoves(moves, from, Attacks::Knight(from) & targetMask);
+	}
+	for (Bitboard pieces = (board.GetPieces(us, Bishop) | board.GetPieces(us, Queen)); pieces;) {
+		const Square from = PopLowestSquare(pieces);
+		Bitboard targets = Attacks::Bishop(from, occupied) & targetMask;
+		if (pinned & SquareBit(from))
+			targets &= Attacks::Line(king, from);
+		AddMoves(moves, from, targets);
+	}
+	for (Bitboard pieces = (board.GetPieces(us, Rook) | board.GetPieces(us, Queen)); pieces;) {
+		const Square from = PopLowestSquare(pieces);
+		Bitboard targets = Attacks::Rook(from, occupied) & targetMask;
+		if (pinned & SquareBit(from))
+			targets &= Attacks::Line(king, from);
+		AddMoves(moves, from, targets);
+	}
+
+	const int forward = us == White ? 8 : -8;
+	const int startRank = us == White ? 1 : 6;
+	const int promotionRank = us == White ? 6 : 1;
+	for (Bitboard pieces = board.GetPieces(us, Pawn); pieces;) {
+		const Square from = PopLowestSquare(pieces);
+		Bitboard targets = Attacks::Pawn(us, from) & theirs;
+		const Square push = static_cast<Square>(from + forward);
+		if (type == Captures) {
+			if (RankOf(from) == promotionRank && !(occupied & SquareBit(push)))
+				targets |= SquareBit(push);
+		}
+		else if (!(occupied & SquareBit(push))) {
+			targets |= SquareBit(push);
+			const Square doublePush = static_cast<Square>(push + forward);
+			if (RankOf(from) == startRank && !(occupied & SquareBit(doublePush)))
+				targets |= SquareBit(doublePush);
+		}
+		targets &= checkMask;
+		if (pinned & SquareBit(from))
+			targets &= Attacks::Line(king, from);
+		while (targets)
+			AddPawnMove(moves, from, PopLowestSquare(targets), type);
+	}
+
+	const Square enPassant = position.GetEnPassantSquare();
+	if (enPassant != NoSquare) {
+		const Square captured = static_cast<Square>(enPassant ^ 8);
+		//The capture has to take the checker or block its line, the moved pawn can not reveal a check
+		if ((checkMask & SquareBit(enPassant)) || (checkers & SquareBit(captured))) {
+			for (Bitboard pieces = Attacks::Pawn(them, enPassant) & board.GetPieces(us, Pawn); pieces;) {
+				const Square from = PopLowestSquare(pieces);
+				const Bitboard after = (occupied ^ SquareBit(from) ^ SquareBit(captured)) | SquareBit(enPassant);
+				if (!(Attacks::Bishop(king, after) & theirDiagonal) && !(Attacks::Rook(king, after) & theirStraight))
+					moves.Add(Move(from, enPassant, EnPassant));
+			}
+		}
+	}
+
+	//Castling needs the squares between king and rook empty and the king path not attacked
+	if (checkers || type == Captures)
+		return;
+	const int rights = position.GetCastlingRights() & (us == White ? WhiteKingSide | WhiteQueenSide
+																	: BlackKingSide | BlackQueenSide);
+	if (!rights)
+		return;
+	const int rank = us == White ? 0 : 7;
+	if ((rights & (WhiteKingSide | BlackKingSide)) &&
+		!(occupied & (SquareBit(MakeSquare(5, rank)) | SquareBit(MakeSquare(6, rank)))) &&
+		!IsAttacked(board, MakeSquare(5, rank), them, occupied) && !IsAttacked(board, MakeSquare(6, rank), them, occupied))
+		moves.Add(Move(king, MakeSquare(6, rank), Castling));
+	if ((rights & (WhiteQueenSide | BlackQueenSide)) &&
+		!(occupied & (SquareBit(MakeSquare(1, rank)) | SquareBit(MakeSquare(2, rank)) | SquareBit(MakeSquare(3, rank)))) &&
+		!IsAttacked(board, MakeSquare(3, rank), them, occupied) && !IsAttacked(board, MakeSquare(2, rank), them, occupied))
+		moves.Add(Move(king, MakeSquare(2, rank), Castling));
+}
@@ -0,0 +1,47 @@
+/**
+* @file MoveGen.h
+*
+* @brief Legal move generation. The king and the checking and pinning pieces are
+*        looked at once per position, so every generated move is legal without
+*        making it: pinned pieces only move along their pin, in check only moves
+*        that capture or block the checker are made, and the king never steps
+*        onto an attacked square.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MOVEGEN_H_
+#define MOVEGEN_H_
+
+#include "Position.h"
+
+//Moves of one position, on the stack. No position has more than 218 legal moves
+struct MoveList {
+	static constexpr int Capacity = 256;
+
+	Move Moves[Capacity];
+	int Count = 0;
+
+	inline void Add(Move move) { Moves[Count++] = move; }
+	inline int GetSize() const { return Count; }
+	inline const Move* begin() const { return Moves; }
+	inline const Move* end() const { return Moves + Count; }
+	inline Move* begin() { return Moves; }
+	inline Move* end() { return Moves + Count; }
+};
+
+enum GenerationType {
+	AllMoves,
+	Captures		//Captures and queen promotions, for the quiescence search
+};
+
+/**
+* @brief Generates the legal moves of the side to move
+*
+* @param position - Position to generate the moves of
+* @param moves - List the moves are added to
+* @param type - Which of the legal moves to generate
+*/
+void GenerateLegalMoves(const Position& position, MoveList& moves, GenerationType type = AllMoves);
+
+#endif // MOVEGEN_H_
@@ -0,0 +1,421 @@
+/**
+* @file Nnue.cpp
+*
+* @brief Loading, writing and running the network, and the accumulators kept along a line of moves
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Nnue.h"
+#include "NnueKernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NNUE_X86
+#endif
+
+namespace {
+	const char NetworkMagic[4] = { 'N', 'N', 'U', 'E' };
+
+	//Sections of the file in the order they are stored
+	enum Section {
+		FeatureBiasSection, FeatureWeightSection, PsqtWeightSection, Layer1BiasSection, Layer1WeightSection,
+		Layer2BiasSection, Layer2WeightSection, OutputBiasSection, OutputWeightSection, SectionCount
+	};
+
+	//Bytes of every section
+	const std::size_t SectionSizes[SectionCount] = {
+		Nnue::HiddenSize * sizeof(std::int16_t),
+		std::size_t(Nnue::FeatureCount) * Nnue::HiddenSize * sizeof(std::int16_t),
+		Nnue::FeatureCount * sizeof(std::int32_t),
+		Nnue::Layer1Size * sizeof(std::int32_t),
+		Nnue::Layer1Size * 2 * Nnue::HiddenSize * sizeof(std::int8_t),
+		Nnue::Layer2Size * sizeof(std::int32_t),
+		Nnue::Layer2Size * Nnue::Layer1Size * sizeof(std::int8_t),
+		sizeof(std::int32_t),
+		Nnue::Layer2Size * sizeof(std::int8_t),
+	};
+
+	inline std::size_t AlignUp(std::size_t offset)
+	{
+		return (offset + Nnue::Network::Alignment - 1) / Nnue::Network::Alignment * Nnue::Network::Alignment;
+	}
+
+	//Offset of every section from the start of the file, and the size of the whole file at the end
+	struct FileLayout {
+		std::size_t Offsets[SectionCount + 1];
+
+		FileLayout()
+		{
+			std::size_t offset = AlignUp(sizeof(Nnue::NetworkFileHeader));
+			for (int i = 0; i < SectionCount; i++) {
+				Offsets[i] = offset;
+				offset = AlignUp(offset + SectionSizes[i]);
+			}
+			Offsets[SectionCount] = offset;
+		}
+	};
+
+	Nnue::SimdLevel DetectSimdLevel()
+	{
+#if defined(NNUE_X86) && (defined(__GNUC__) || defined(__clang__))
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+			return Nnue::Avx2Simd;
+		if (__builtin_cpu_supports("sse4.1"))
+			return Nnue::Sse41Simd;
+#elif defined(NNUE_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool sse41 = (info[2] & (1 << 19)) != 0;
+		//AVX2 also needs the system to save the upper halves of the registers
+		const bool avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		if (avx && maxLeaf >= 7) {
+			__cpuidex(info, 7, 0);
+			if (info[1] & (1 << 5))
+				return Nnue::Avx2Simd;
+		}
+		if (sse41)
+			return Nnue::Sse41Simd;
+#endif
+		return Nnue::ScalarSimd;
+	}
+
+	const Nnue::Kernels::Table* GetKernelTable(Nnue::SimdLevel level)
+	{
+		switch (level) {
+		case Nnue::Avx2Simd:
+			return &Nnue::Kernels::Avx2;
+		case Nnue::Sse41Simd:
+			return &Nnue::Kernels::Sse41;
+		default:
+			return &Nnue::Kernels::Scalar;
+		}
+	}
+
+	const Nnue::SimdLevel SupportedLevel = DetectSimdLevel();
+	Nnue::SimdLevel ActiveLevel = SupportedLevel;
+	const Nnue::Kernels::Table* ActiveKernels = GetKernelTable(SupportedLevel);
+
+	//SplitMix64, the same generator as the Zobrist keys
+	std::uint64_t NextRandom(std::uint64_t& state)
+	{
+		std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	template <typename T>
+	void FillRandom(std::vector<T>& values, std::size_t count, int range, std::uint64_t& state)
+	{
+		values.resize(count);
+		for (T& value : values)
+			value = static_cast<T>(static_cast<int>(NextRandom(state) % (2 * range + 1)) - range);
+	}
+
+	template <typename T>
+	bool WriteSection(std::ofstream& stream, const std::vector<T>& values, Section section, std::size_t offset)
+	{
+		if (values.size() * sizeof(T) != SectionSizes[section])
+			return false;
+		stream.seekp(static_cast<std::streamoff>(offset));
+		stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(SectionSizes[section]));
+		return true;
+	}
+}
+
+namespace Nnue {
+	SimdLevel GetSupportedSimdLevel()
+	{
+		return SupportedLevel;
+	}
+
+	void SetSimdLevel(SimdLevel level)
+	{
+		ActiveLevel = std::min(level, SupportedLevel);
+		ActiveKernels = GetKernelTable(ActiveLevel);
+	}
+
+	SimdLevel GetSimdLevel()
+	{
+		return ActiveLevel;
+	}
+
+	const char* GetSimdName(SimdLevel level)
+	{
+		static const char* const names[SimdLevelCount] = { "scalar", "sse4.1", "avx2" };
+		return level < SimdLevelCount ? names[level] : "unknown";
+	}
+
+	NetworkWeights NetworkWeights::Generate(std::uint32_t seed, int outputRange)
+	{
+		NetworkWeights weights;
+		std::uint64_t state = seed;
+		FillRandom(weights.FeatureBiases, HiddenSize, 16, state);
+		for (std::int16_t& bias : weights.FeatureBiases)
+			bias += 48;
+		FillRandom(weights.FeatureWeights, std::size_t(FeatureCount) * HiddenSize, 8, state);
+		FillRandom(weights.Layer1Biases, Layer1Size, 256, state);
+		FillRandom(weights.Layer1Weights, Layer1Size * 2 * HiddenSize, 16, state);
+		FillRandom(weights.Layer2Biases, Layer2Size, 256, state);
+		FillRandom(weights.Layer2Weights, Layer2Size * Layer1Size, 16, state);
+		weights.OutputBias.assign(1, 0);
+		FillRandom(weights.OutputWeights, Layer2Size, std::max(outputRange, 0), state);
+
+		//Every side sees its own pieces as positive, the evaluation halves the difference of both sides
+		weights.PsqtWeights.resize(FeatureCount);
+		for (const Color perspective : { White, Black })
+			for (int king = 0; king < SquareCount; king++)
+				for (int piece = 0; piece < PieceCount; piece++) {
+					if (TypeOf(static_cast<Piece>(piece)) == King)
+						continue;
+					for (int square = 0; square < SquareCount; square++) {
+						const int value = PieceSquare::Values.Scores[piece][square].Middlegame * OutputScale;
+						const int index = FeatureIndex(perspective, static_cast<Square>(king), static_cast<Piece>(piece),
+													   static_cast<Square>(square));
+						weights.PsqtWeights[index] = perspective == White ? value : -value;
+					}
+				}
+		weights.Description = "piece-square, seed " + std::to_string(seed);
+		return weights;
+	}
+
+	Network::Network()
+		: Header(nullptr), FeatureBiases(nullptr), FeatureWeights(nullptr), PsqtWeights(nullptr),
+		  Layer1Biases(nullptr), Layer1Weights(nullptr), Layer2Biases(nullptr), Layer2Weights(nullptr),
+		  OutputBias(nullptr), OutputWeights(nullptr)
+	{
+	}
+
+	bool Network::Load(const std::string& filePath)
+	{
+		Close();
+		if (!File.Open(filePath))
+			return false;
+
+		const auto* header = reinterpret_cast<const NetworkFileHeader*>(File.GetData());
+		if (File.GetSize() < sizeof(NetworkFileHeader) || std::memcmp(header->Magic, NetworkMagic, 4) != 0) {
+			std::cout << filePath << " is not a network file\n";
+			File.Close();
+			return false;
+		}
+		if (header->Version != Version || header->FeatureCount != FeatureCount || header->HiddenSize != HiddenSize ||
+			header->Layer1Size != Layer1Size || header->Layer2Size != Layer2Size) {
+			std::cout << filePath << " has an unsupported network version or architecture\n";
+			File.Close();
+			return false;
+		}
+		const FileLayout layout;
+		if (File.GetSize() < layout.Offsets[SectionCount]) {
+			std::cout << filePath << " is truncated\n";
+			File.Close();
+			return false;
+		}
+
+		const unsigned char* data = File.GetData();
+		Header = header;
+		FeatureBiases = reinterpret_cast<const std::int16_t*>(data + layout.Offsets[FeatureBiasSection]);
+		FeatureWeights = reinterpret_cast<const std::int16_t*>(data + layout.Offsets[FeatureWeightSection]);
+		PsqtWeights = reinterpret_cast<const std::int32_t*>(data + layout.Offsets[PsqtWeightSection]);
+		Layer1Biases = reinterpret_cast<const std::int32_t*>(data + layout.Offsets[Layer1BiasSection]);
+		Layer1Weights = reinterpret_cast<const std::int8_t*>(data + layout.Offsets[Layer1WeightSection]);
+		Layer2Biases = reinterpret_cast<const std::int32_t*>(data + layout.Offsets[Layer2BiasSection]);
+		Layer2Weights = reinterpret_cast<const std::int8_t*>(data + layout.Offsets[Layer2WeightSection]);
+		OutputBias = reinterpret_cast<const std::int32_t*>(data + layout.Offsets[OutputBiasSection]);
+		OutputWeights = reinterpret_cast<const std::int8_t*>(data + layout.Offsets[OutputWeightSection]);
+		return true;
+	}
+
+	void Network::Close()
+	{
+		File.Close();
+		Header = nullptr;
+	}
+
+	/**
+	* @brief Writes a network into the network file format
+	*
+	* @param filePath - Path to the file to write
+	* @param weights - Weights of all layers, every one of the size of its layer
+	* @return bool - Whether the file could be written or not
+	*/
+	bool Network::Write(const std::string& filePath, const NetworkWeights& weights)
+	{
+		std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+		if (!stream) {
+			std::cout << "Could not open " << filePath << " for writing\n";
+			return false;
+		}
+
+		NetworkFileHeader header = {};
+		std::memcpy(header.Magic, NetworkMagic, 4);
+		header.Version = Version;
+		header.FeatureCount = FeatureCount;
+		header.HiddenSize = HiddenSize;
+		header.Layer1Size = Layer1Size;
+		header.Layer2Size = Layer2Size;
+		std::strncpy(header.Description, weights.Description.c_str(), sizeof(header.Description) - 1);
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		const FileLayout layout;
+		const std::size_t* offsets = layout.Offsets;
+		const bool sizesMatch =
+			WriteSection(stream, weights.FeatureBiases, FeatureBiasSection, offsets[FeatureBiasSection]) &&
+			WriteSection(stream, weights.FeatureWeights, FeatureWeightSection, offsets[FeatureWeightSection]) &&
+			WriteSection(stream, weights.PsqtWeights, PsqtWeightSection, offsets[PsqtWeightSection]) &&
+			WriteSection(stream, weights.Layer1Biases, Layer1BiasSection, offsets[Layer1BiasSection]) &&
+			WriteSection(stream, weights.Layer1Weights, Layer1WeightSection, offsets[Layer1WeightSection]) &&
+			WriteSection(stream, weights.Layer2Biases, Layer2BiasSection, offsets[Layer2BiasSection]) &&
+			WriteSection(stream, weights.Layer2Weights, Layer2WeightSection, offsets[Layer2WeightSection]) &&
+			WriteSection(stream, weights.OutputBias, OutputBiasSection, offsets[OutputBiasSection]) &&
+			WriteSection(stream, weights.OutputWeights, OutputWeightSection, offsets[OutputWeightSection]);
+		if (!sizesMatch) {
+			std::cout << "The weights do not match the sizes of the network layers\n";
+			return false;
+		}
+		//The padding after the last section makes the file as long as the loader expects
+		const char padding[Alignment] = {};
+		const std::size_t end = offsets[OutputWeightSection] + SectionSizes[OutputWeightSection];
+		stream.write(padding, static_cast<std::streamsize>(offsets[SectionCount] - end));
+		if (!stream) {
+			std::cout << "Could not write " << filePath << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	void Network::Refresh(const Position& position, Color perspective, Accumulator& accumulator) const
+	{
+		const Board& board = position.GetBoard();
+		const Square king = position.GetKingSquare(perspective);
+		const std::int16_t* columns[MaxActiveFeatures];
+		int count = 0;
+		std::int32_t psqt = 0;
+		Bitboard pieces = board.GetOccupied() & ~board.GetPieces(King);
+		while (pieces && count < MaxActiveFeatures) {
+			const Square square = PopLowestSquare(pieces);
+			const int index = FeatureIndex(perspective, king, board.GetPiece(square), square);
+			columns[count++] = FeatureWeights + std::size_t(index) * HiddenSize;
+			psqt += PsqtWeights[index];
+		}
+		ActiveKernels->UpdateAccumulator(accumulator.Values[perspective], FeatureBiases, columns, count, nullptr, 0);
+		accumulator.Psqt[perspective] = psqt;
+	}
+
+	void Network::Update(const Accumulator& previous, Accumulator& accumulator, Color perspective,
+						 const int* added, int addedCount, const int* removed, int removedCount) const
+	{
+		const std::int16_t* addedColumns[2];
+		const std::int16_t* removedColumns[2];
+		std::int32_t psqt = previous.Psqt[perspective];
+		for (int i = 0; i < addedCount; i++) {
+			addedColumns[i] = FeatureWeights + std::size_t(added[i]) * HiddenSize;
+			psqt += PsqtWeights[added[i]];
+		}
+		for (int i = 0; i < removedCount; i++) {
+			removedColumns[i] = FeatureWeights + std::size_t(removed[i]) * HiddenSize;
+			psqt -= PsqtWeights[removed[i]];
+		}
+		ActiveKernels->UpdateAccumulator(accumulator.Values[perspective], previous.Values[perspective],
+										 addedColumns, addedCount, removedColumns, removedCount);
+		accumulator.Psqt[perspective] = psqt;
+	}
+
+	int Network::Evaluate(const Accumulator& accumulator, Color sideToMove) const
+	{
+		const Kernels::Table& kernels = *ActiveKernels;
+
+		//The side to move comes first, so the layers see the position from the side they score it for
+		alignas(64) std::uint8_t transformed[2 * HiddenSize];
+		kernels.ClipAccumulator(accumulator.Values[sideToMove], transformed);
+		kernels.ClipAccumulator(accumulator.Values[~sideToMove], transformed + HiddenSize);
+
+		alignas(64) std::int32_t sums[Layer1Size];
+		alignas(64) std::uint8_t hidden1[Layer1Size];
+		kernels.Affine(transformed, 2 * HiddenSize, Layer1Weights, Layer1Biases, Layer1Size, sums);
+		for (int i = 0; i < Layer1Size; i++)
+			hidden1[i] = static_cast<std::uint8_t>(std::clamp(sums[i] >> WeightShift, 0, ClipMax));
+
+		alignas(64) std::uint8_t hidden2[Layer2Size];
+		kernels.Affine(hidden1, Layer1Size, Layer2Weights, Layer2Biases, Layer2Size, sums);
+		for (int i = 0; i < Layer2Size; i++)
+			hidden2[i] = static_cast<std::uint8_t>(std::clamp(sums[i] >> WeightShift, 0, ClipMax));
+
+		std::int32_t output = *OutputBias;
+		for (int i = 0; i < Layer2Size; i++)
+			output += hidden2[i] * OutputWeights[i];
+		const std::int32_t psqt = (accumulator.Psqt[sideToMove] - accumulator.Psqt[~sideToMove]) / 2;
+		return (output + psqt) / OutputScale;
+	}
+
+	AccumulatorStack::AccumulatorStack()
+		: Net(nullptr), Accumulators(MaxDepth), Current(0)
+	{
+	}
+
+	void AccumulatorStack::Reset(const Network& network, const Position& position)
+	{
+		Net = &network;
+		Current = 0;
+		Net->Refresh(position, White, Accumulators[0]);
+		Net->Refresh(position, Black, Accumulators[0]);
+	}
+
+	void AccumulatorStack::Push(const Position& position, Move move, const MoveUndo& undo)
+	{
+		const Board& board = position.GetBoard();
+		const Color us = ~position.GetSideToMove();
+		const Square from = move.GetFrom();
+		const Square to = move.GetTo();
+		const Piece moved = board.GetPiece(to);
+		const bool kingMoved = TypeOf(moved) == King;
+
+		//The pieces the move put on and took off the board, kings are not features
+		Piece addedPieces[2] = { NoPiece, NoPiece }, removedPieces[2] = { NoPiece, NoPiece };
+		Square addedSquares[2] = { NoSquare, NoSquare }, removedSquares[2] = { NoSquare, NoSquare };
+		int addedCount = 0, removedCount = 0;
+		if (move.GetKind() == Castling) {
+			const bool kingSide = FileOf(to) == 6;
+			addedPieces[addedCount] = MakePiece(us, Rook);
+			addedSquares[addedCount++] = static_cast<Square>(kingSide ? to - 1 : to + 1);
+			removedPieces[removedCount] = MakePiece(us, Rook);
+			removedSquares[removedCount++] = static_cast<Square>(kingSide ? to + 1 : to - 2);
+		}
+		else {
+			if (!kingMoved) {
+				addedPieces[addedCount] = moved;
+				addedSquares[addedCount++] = to;
+				removedPieces[removedCount] = move.GetKind() == Promotion ? MakePiece(us, Pawn) : moved;
+				removedSquares[removedCount++] = from;
+			}
+			if (undo.Captured != NoPiece) {
+				removedPieces[removedCount] = undo.Captured;
+				removedSquares[removedCount++] = move.GetKind() == EnPassant ? static_cast<Square>(to ^ 8) : to;
+			}
+		}
+
+		const Accumulator& previous = Accumulators[Current];
+		Accumulator& accumulator = Accumulators[++Current];
+		for (const Color perspective : { White, Black }) {
+			//Every feature of a side depends on its king, so a king move starts that side over
+			if (kingMoved && perspective == us) {
+				Net->Refresh(position, perspective, accumulator);
+				continue;
+			}
+			const Square king = position.GetKingSquare(perspective);
+			int added[2], removed[2];
+			for (int i = 0; i < addedCount; i++)
+				added[i] = FeatureIndex(perspective, king, addedPieces[i], addedSquares[i]);
+			for (int i = 0; i < removedCount; i++)
+				removed[i] = FeatureIndex(perspective, king, removedPieces[i], removedSquares[i]);
+			Net->Update(previous, accumulator, perspective, added, addedCount, removed, removedCount);
+		}
+	}
+}
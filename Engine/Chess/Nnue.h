@@ -0,0 +1,197 @@
+/**
+* @file Nnue.h
+*
+* @brief Efficiently updatable neural network evaluation. The input layer has one
+*        feature for every king square of a side and every piece other than a king
+*        on every square, seen from that side (HalfKP). Every position keeps, for
+*        both sides, the sum of the weight columns of its active features in int16
+*        accumulators, which a move only changes by the few features it touches.
+*        The clipped accumulators of the side to move and the other side feed two
+*        small dense layers of int8 weights and a single output, which add up with
+*        a linear piece-square part to the score. The dense layers run on AVX2 or
+*        SSE4.1 when the processor has them, with a scalar fallback that gives the
+*        same results.
+*
+* File layout (little endian):
+*   NetworkFileHeader
+*   feature biases, feature weights, piece-square weights, the biases and the
+*   weights of both dense layers and of the output, each of them starting on a
+*   Network::Alignment boundary
+* The file is memory mapped and the weights are used in place.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef NNUE_H_
+#define NNUE_H_
+
+#include "Position.h"
+
+#include <MappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Nnue {
+	//Pieces other than kings of either side, on every square, for every square of the king
+	const int PieceKinds = 10;
+	const int FeatureCount = SquareCount * PieceKinds * SquareCount;
+	const int HiddenSize = 256;				//Accumulator values of one side
+	const int Layer1Size = 32;
+	const int Layer2Size = 32;
+	const int MaxActiveFeatures = 30;		//Every piece but the two kings
+	const int WeightShift = 6;				//The dense layers have weights scaled by 2^6
+	const int OutputScale = 16;				//Output units per centipawn
+	const int ClipMax = 127;
+
+	enum SimdLevel { ScalarSimd, Sse41Simd, Avx2Simd, SimdLevelCount };
+
+	//The best level the processor supports
+	SimdLevel GetSupportedSimdLevel();
+	//Level the networks run at, the best supported one unless set lower. Not while networks evaluate
+	void SetSimdLevel(SimdLevel level);
+	SimdLevel GetSimdLevel();
+	const char* GetSimdName(SimdLevel level);
+
+	/**
+	* @brief Index of a feature seen from one side, with the board flipped for black
+	*        so both sides see their own pieces from the first rank
+	*
+	* @param perspective - Side the feature is seen from
+	* @param king - Square of the king of that side
+	* @param piece - Piece other than a king
+	* @param square - Square of the piece
+	*/
+	inline int FeatureIndex(Color perspective, Square king, Piece piece, Square square)
+	{
+		const int flip = perspective == White ? 0 : 56;
+		const int kind = (ColorOf(piece) == perspective ? 0 : 5) + TypeOf(piece);
+		return ((king ^ flip) * PieceKinds + kind) * SquareCount + (square ^ flip);
+	}
+
+	struct NetworkFileHeader {
+		char Magic[4];					// "NNUE"
+		std::uint32_t Version;
+		std::uint32_t FeatureCount;
+		std::uint32_t HiddenSize;
+		std::uint32_t Layer1Size;
+		std::uint32_t Layer2Size;
+		std::uint32_t Reserved[2];
+		char Description[32];			// null terminated
+	};
+	static_assert(sizeof(NetworkFileHeader) == 64, "NetworkFileHeader must not be padded");
+
+	//The weights of a network in memory, to write into a network file
+	struct NetworkWeights {
+		std::vector<std::int16_t> FeatureBiases;		//HiddenSize
+		std::vector<std::int16_t> FeatureWeights;		//FeatureCount columns of HiddenSize
+		std::vector<std::int32_t> PsqtWeights;			//FeatureCount, in output units
+		std::vector<std::int32_t> Layer1Biases;			//Layer1Size
+		std::vector<std::int8_t> Layer1Weights;			//Layer1Size rows of 2 * HiddenSize
+		std::vector<std::int32_t> Layer2Biases;			//Layer2Size
+		std::vector<std::int8_t> Layer2Weights;			//Layer2Size rows of Layer1Size
+		std::vector<std::int32_t> OutputBias;			//1
+		std::vector<std::int8_t> OutputWeights;			//Layer2Size
+		std::string Description;
+
+		/**
+		* @brief A network that needs no training: its piece-square part holds the
+		*        middlegame material and piece-square values of the handcrafted
+		*        evaluation, the other layers hold seeded noise
+		*
+		* @param seed - Seed of the noise
+		* @param outputRange - Largest output weight, 0 leaves the score to the piece-square part alone
+		*/
+		static NetworkWeights Generate(std::uint32_t seed, int outputRange);
+	};
+
+	//Sums of the active features of both sides
+	struct alignas(64) Accumulator {
+		std::int16_t Values[ColorCount][HiddenSize];
+		std::int32_t Psqt[ColorCount];
+	};
+
+	class Network
+	{
+	public:
+		static constexpr std::uint32_t Version = 1;
+		static constexpr std::size_t Alignment = 64;
+
+		Network();
+		~Network() = default;
+
+		Network(const Network&) = delete;
+		Network& operator=(const Network&) = delete;
+
+		//Maps the file and validates it, the weights stay mapped until Close()
+		bool Load(const std::string& filePath);
+		void Close();
+		inline bool IsLoaded() const { return Header != nullptr; }
+		inline const char* GetDescription() const { return Header->Description; }
+		//Writes the weights into a network file
+		static bool Write(const std::string& filePath, const NetworkWeights& weights);
+
+		//Sets the accumulator of one side from all pieces of the position
+		void Refresh(const Position& position, Color perspective, Accumulator& accumulator) const;
+		/**
+		* @brief Sets the accumulator of one side from the one before a move, removing
+		*        and adding the features the move changed
+		*
+		* @param added, removed - Feature indices, up to two of each
+		*/
+		void Update(const Accumulator& previous, Accumulator& accumulator, Color perspective,
+					const int* added, int addedCount, const int* removed, int removedCount) const;
+
+		/**
+		* @brief Scores a position from its accumulator
+		*
+		* @param accumulator - Accumulator of the position, both sides up to date
+		* @param sideToMove - Side the score is for
+		* @return int - Centipawns for the side to move
+		*/
+		int Evaluate(const Accumulator& accumulator, Color sideToMove) const;
+
+	private:
+		MappedFile File;
+		const NetworkFileHeader* Header;
+		const std::int16_t* FeatureBiases;
+		const std::int16_t* FeatureWeights;
+		const std::int32_t* PsqtWeights;
+		const std::int32_t* Layer1Biases;
+		const std::int8_t* Layer1Weights;
+		const std::int32_t* Layer2Biases;
+		const std::int8_t* Layer2Weights;
+		const std::int32_t* OutputBias;
+		const std::int8_t* OutputWeights;
+	};
+
+	//Accumulators of the positions of a line of moves, the last one is the current position
+	class AccumulatorStack
+	{
+	public:
+		AccumulatorStack();
+
+		//Starts a line at the position
+		void Reset(const Network& network, const Position& position);
+		//Adds the position after a move, a king move refreshes the side of the king
+		void Push(const Position& position, Move move, const MoveUndo& undo);
+		//Goes back to the position before the last move
+		inline void Pop() { Current--; }
+
+		inline int Evaluate(const Position& position) const
+		{
+			return Net->Evaluate(Accumulators[Current], position.GetSideToMove());
+		}
+		inline const Accumulator& Top() const { return Accumulators[Current]; }
+
+	private:
+		static const int MaxDepth = 256;
+
+		const Network* Net;
+		std::vector<Accumulator> Accumulators;
+		int Current;
+	};
+}
+
+#endif // NNUE_H_
@@ -0,0 +1,185 @@
+/**
+* @file NnueKernels.cpp
+*
+* @brief Scalar, SSE4.1 and AVX2 versions of the network loops. The vector versions
+*        are compiled for their instruction set function by function, so the rest of
+*        the program runs on processors without them.
+*
+* @author Aleksander Solhaug
+*/
+
+#include "NnueKernels.h"
+#include "Nnue.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define NNUE_X86
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#else
+//MSVC compiles every intrinsic without being told the instruction set
+#define NNUE_TARGET(isa)
+#endif
+#endif
+
+namespace {
+	void ScalarUpdateAccumulator(std::int16_t* output, const std::int16_t* input,
+								 const std::int16_t* const* added, int addedCount,
+								 const std::int16_t* const* removed, int removedCount)
+	{
+		//int16 wraps around like the vector additions do
+		for (int i = 0; i < Nnue::HiddenSize; i++) {
+			int value = input[i];
+			for (int j = 0; j < addedCount; j++)
+				value += added[j][i];
+			for (int j = 0; j < removedCount; j++)
+				value -= removed[j][i];
+			output[i] = static_cast<std::int16_t>(value);
+		}
+	}
+
+	void ScalarClipAccumulator(const std::int16_t* input, std::uint8_t* output)
+	{
+		for (int i = 0; i < Nnue::HiddenSize; i++)
+			output[i] = static_cast<std::uint8_t>(std::clamp<int>(input[i], 0, Nnue::ClipMax));
+	}
+
+	void ScalarAffine(const std::uint8_t* input, int inputSize, const std::int8_t* weights,
+					  const std::int32_t* biases, int outputSize, std::int32_t* output)
+	{
+		for (int i = 0; i < outputSize; i++) {
+			const std::int8_t* row = weights + i * inputSize;
+			std::int32_t sum = biases[i];
+			for (int j = 0; j < inputSize; j++)
+				sum += input[j] * row[j];
+			output[i] = sum;
+		}
+	}
+
+#ifdef NNUE_X86
+	//Accumulator values kept in registers at once, a block of them is loaded, updated and stored
+	const int BlockRegisters = 8;
+
+	NNUE_TARGET("sse4.1")
+	void Sse41UpdateAccumulator(std::int16_t* output, const std::int16_t* input,
+								const std::int16_t* const* added, int addedCount,
+								const std::int16_t* const* removed, int removedCount)
+	{
+		const int blockSize = BlockRegisters * 8;
+		for (int block = 0; block < Nnue::HiddenSize; block += blockSize) {
+			__m128i values[BlockRegisters];
+			for (int k = 0; k < BlockRegisters; k++)
+				values[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(input + block) + k);
+			for (int j = 0; j < addedCount; j++)
+				for (int k = 0; k < BlockRegisters; k++)
+					values[k] = _mm_add_epi16(values[k], _mm_load_si128(reinterpret_cast<const __m128i*>(added[j] + block) + k));
+			for (int j = 0; j < removedCount; j++)
+				for (int k = 0; k < BlockRegisters; k++)
+					values[k] = _mm_sub_epi16(values[k], _mm_load_si128(reinterpret_cast<const __m128i*>(removed[j] + block) + k));
+			for (int k = 0; k < BlockRegisters; k++)
+				_mm_store_si128(reinterpret_cast<__m128i*>(output + block) + k, values[k]);
+		}
+	}
+
+	NNUE_TARGET("sse4.1")
+	void Sse41ClipAccumulator(const std::int16_t* input, std::uint8_t* output)
+	{
+		//Packing saturates to 127 from above, the maximum with zero clips from below
+		const __m128i zero = _mm_setzero_si128();
+		for (int i = 0; i < Nnue::HiddenSize; i += 16) {
+			const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(input + i));
+			const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+			_mm_store_si128(reinterpret_cast<__m128i*>(output + i), _mm_max_epi8(_mm_packs_epi16(low, high), zero));
+		}
+	}
+
+	NNUE_TARGET("sse4.1")
+	void Sse41Affine(const std::uint8_t* input, int inputSize, const std::int8_t* weights,
+					 const std::int32_t* biases, int outputSize, std::int32_t* output)
+	{
+		//The inputs are at most 127, so a pair of products never saturates the int16 sums of maddubs
+		const __m128i ones = _mm_set1_epi16(1);
+		for (int i = 0; i < outputSize; i++) {
+			const std::int8_t* row = weights + i * inputSize;
+			__m128i sum = _mm_setzero_si128();
+			for (int j = 0; j < inputSize; j += 16) {
+				const __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(input + j));
+				const __m128i w = _mm_load_si128(reinterpret_cast<const __m128i*>(row + j));
+				sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+			}
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+			output[i] = biases[i] + _mm_cvtsi128_si32(sum);
+		}
+	}
+
+	NNUE_TARGET("avx2")
+	void Avx2UpdateAccumulator(std::int16_t* output, const std::int16_t* input,
+							   const std::int16_t* const* added, int addedCount,
+							   const std::int16_t* const* removed, int removedCount)
+	{
+		const int blockSize = BlockRegisters * 16;
+		for (int block = 0; block < Nnue::HiddenSize; block += blockSize) {
+			__m256i values[BlockRegisters];
+			for (int k = 0; k < BlockRegisters; k++)
+				values[k] = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + block) + k);
+			for (int j = 0; j < addedCount; j++)
+				for (int k = 0; k < BlockRegisters; k++)
+					values[k] = _mm256_add_epi16(values[k], _mm256_load_si256(reinterpret_cast<const __m256i*>(added[j] + block) + k));
+			for (int j = 0; j < removedCount; j++)
+				for (int k = 0; k < BlockRegisters; k++)
+					values[k] = _mm256_sub_epi16(values[k], _mm256_load_si256(reinterpret_cast<const __m256i*>(removed[j] + block) + k));
+			for (int k = 0; k < BlockRegisters; k++)
+				_mm256_store_si256(reinterpret_cast<__m256i*>(output + block) + k, values[k]);
+		}
+	}
+
+	NNUE_TARGET("avx2")
+	void Avx2ClipAccumulator(const std::int16_t* input, std::uint8_t* output)
+	{
+		//Packing works within the 128 bit halves, the permutation puts the quarters back in order
+		const __m256i zero = _mm256_setzero_si256();
+		for (int i = 0; i < Nnue::HiddenSize; i += 32) {
+			const __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i));
+			const __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i + 16));
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(output + i), _mm256_max_epi8(packed, zero));
+		}
+	}
+
+	NNUE_TARGET("avx2")
+	void Avx2Affine(const std::uint8_t* input, int inputSize, const std::int8_t* weights,
+					const std::int32_t* biases, int outputSize, std::int32_t* output)
+	{
+		const __m256i ones = _mm256_set1_epi16(1);
+		for (int i = 0; i < outputSize; i++) {
+			const std::int8_t* row = weights + i * inputSize;
+			__m256i sum = _mm256_setzero_si256();
+			for (int j = 0; j < inputSize; j += 32) {
+				const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + j));
+				const __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(row + j));
+				sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+			}
+			__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+			half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+			half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+			output[i] = biases[i] + _mm_cvtsi128_si32(half);
+		}
+	}
+#endif
+}
+
+namespace Nnue {
+	namespace Kernels {
+		const Table Scalar = { ScalarUpdateAccumulator, ScalarClipAccumulator, ScalarAffine };
+#ifdef NNUE_X86
+		const Table Sse41 = { Sse41UpdateAccumulator, Sse41ClipAccumulator, Sse41Affine };
+		const Table Avx2 = { Avx2UpdateAccumulator, Avx2ClipAccumulator, Avx2Affine };
+#else
+		const Table Sse41 = Scalar;
+		const Table Avx2 = Scalar;
+#endif
+	}
+}
@@ -0,0 +1,37 @@
+/**
+* @file NnueKernels.h
+*
+* @brief The loops the network spends its time in, once for every instruction set.
+*        All versions give the same results, the network calls the ones of the
+*        level set with Nnue::SetSimdLevel().
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef NNUEKERNELS_H_
+#define NNUEKERNELS_H_
+
+#include <cstdint>
+
+namespace Nnue {
+	namespace Kernels {
+		struct Table {
+			//Output is input plus the added columns minus the removed ones, HiddenSize values each
+			void (*UpdateAccumulator)(std::int16_t* output, const std::int16_t* input,
+									  const std::int16_t* const* added, int addedCount,
+									  const std::int16_t* const* removed, int removedCount);
+			//Clamps HiddenSize accumulator values to 0..ClipMax
+			void (*ClipAccumulator)(const std::int16_t* input, std::uint8_t* output);
+			//Output is biases plus weights times input, the weights in rows of inputSize, a multiple of 32
+			void (*Affine)(const std::uint8_t* input, int inputSize, const std::int8_t* weights,
+						   const std::int32_t* biases, int outputSize, std::int32_t* output);
+		};
+
+		extern const Table Scalar;
+		//Only filled with the vector versions on x86, elsewhere they are the scalar ones
+		extern const Table Sse41;
+		extern const Table Avx2;
+	}
+}
+
+#endif // NNUEKERNELS_H_
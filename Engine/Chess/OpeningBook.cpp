@@ -0,0 +1,216 @@
+/**
+* @file OpeningBook.cpp
+*
+* @brief Looking up, picking and writing the moves of a Polyglot book
+*
+* @author Aleksander Solhaug
+*/
+
+#include "OpeningBook.h"
+#include "Attacks.h"
+#include "MoveGen.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	//Reads a big endian number of the given bytes
+	inline std::uint64_t ReadBigEndian(const unsigned char* bytes, int count)
+	{
+		std::uint64_t value = 0;
+		for (int i = 0; i < count; i++)
+			value = value << 8 | bytes[i];
+		return value;
+	}
+
+	inline void WriteBigEndian(unsigned char* bytes, std::uint64_t value, int count)
+	{
+		for (int i = count - 1; i >= 0; i--) {
+			bytes[i] = static_cast<unsigned char>(value);
+			value >>= 8;
+		}
+	}
+}
+
+std::uint64_t PolyglotKey(const Position& position)
+{
+	const Board& board = position.GetBoard();
+	std::uint64_t key = 0;
+	for (int color = White; color < ColorCount; color++)
+		for (int type = Pawn; type < PieceTypeCount; type++) {
+			const int piece = 2 * type + (color == White ? 1 : 0);
+			for (Bitboard pieces = board.GetPieces(static_cast<Color>(color), static_cast<PieceType>(type)); pieces != 0;)
+				key ^= PolyglotRandom64[64 * piece + PopLowestSquare(pieces)];
+		}
+
+	//The castling rights are in the order white king side, white queen side, black king side, black queen side
+	const int castlingRights = position.GetCastlingRights();
+	for (int right = 0; right < 4; right++)
+		if (castlingRights & 1 << right)
+			key ^= PolyglotRandom64[PolyglotCastlingOffset + right];
+
+	//The en passant file only counts when a pawn of the side to move stands next to the pawn that moved
+	const Color side = position.GetSideToMove();
+	const Square enPassant = position.GetEnPassantSquare();
+	if (enPassant != NoSquare && (Attacks::Pawn(~side, enPassant) & board.GetPieces(side, Pawn)))
+		key ^= PolyglotRandom64[PolyglotEnPassantOffset + FileOf(enPassant)];
+
+	if (side == White)
+		key ^= PolyglotRandom64[PolyglotTurnOffset];
+	return key;
+}
+
+bool OpeningBook::HasStandardKeys()
+{
+	//Keys the book format publishes: the start position, then 1.e4 d5 2.e5 f5 3.Ke2 Kf7 and 1.a4 b5 2.h4 b4 3.c4 bxc3 4.Ra3,
+	//with en passant squares a pawn can and can not capture on
+	static const struct {
+		const char* Fen;
+		std::uint64_t Key;
+	} published[] = {
+		{ "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", StartPositionKey },
+		{ "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 0x823c9b50fd114196 },
+		{ "rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", 0x0756b94461c50fb0 },
+		{ "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR b KQkq - 0 2", 0x662fafb965db29d4 },
+		{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 0x22a48b5a8e47ff78 },
+		{ "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR b kq - 0 3", 0x652a607ca3f242c1 },
+		{ "rnbq1bnr/ppp1pkpp/8/3pPp2/8/8/PPPPKPPP/RNBQ1BNR w - - 0 4", 0x00fdd303c946bdd9 },
+		{ "rnbqkbnr/p1pppppp/8/8/PpP4P/8/1P1PPPP1/RNBQKBNR b KQkq c3 0 3", 0x3c8123ea7b067637 },
+		{ "rnbqkbnr/p1pppppp/8/8/P6P/R1p5/1P1PPPP1/1NBQKBNR b Kkq - 0 4", 0x5c3f9b829b279560 }
+	};
+	Position position;
+	for (const auto& test : published)
+		if (!position.SetFen(test.Fen) || PolyglotKey(position) != test.Key)
+			return false;
+	return true;
+}
+
+/**
+* @brief Maps the book into memory
+*
+* @param filePath - Path to the book
+* @return bool - Whether the book could be mapped or not
+*/
+bool OpeningBook::Load(const std::string& filePath)
+{
+	if (!HasStandardKeys()) {
+		std::cout << "The Polyglot random numbers do not give the published keys, " << filePath << " is not read\n";
+		return false;
+	}
+	if (!File.Open(filePath))
+		return false;
+	if (File.GetSize() % EntrySize != 0) {
+		std::cout << filePath << " is not a Polyglot book\n";
+		File.Close();
+		return false;
+	}
+	return true;
+}
+
+void OpeningBook::GetMoves(const Position& position, std::vector<BookMove>& moves) const
+{
+	moves.clear();
+	const std::uint64_t key = GetKey(position);
+	const std::size_t count = GetEntryCount();
+	std::size_t index = FindFirst(key);
+	if (index == count || GetEntry(index).Key != key)
+		return;
+
+	//The stored moves only say which squares they are between, the legal moves of the position tell their kind
+	MoveList legalMoves;
+	GenerateLegalMoves(position, legalMoves);
+	for (; index < count; index++) {
+		const Entry entry = GetEntry(index);
+		if (entry.Key != key)
+			break;
+		for (const Move move : legalMoves)
+			if (EncodeMove(move) == entry.EncodedMove) {
+				moves.push_back({ move, entry.Weight });
+				break;
+			}
+	}
+}
+
+Move OpeningBook::PickMove(const Position& position, std::uint64_t random) const
+{
+	std::vector<BookMove> moves;
+	GetMoves(position, moves);
+	std::uint64_t total = 0;
+	for (const BookMove& move : moves)
+		total += move.Weight;
+	if (total == 0)
+		return Move();
+
+	std::uint64_t pick = random % total;
+	for (const BookMove& move : moves) {
+		if (pick < static_cast<std::uint64_t>(move.Weight))
+			return move.BookedMove;
+		pick -= move.Weight;
+	}
+	return Move();
+}
+
+std::uint16_t OpeningBook::EncodeMove(Move move)
+{
+	const Square from = move.GetFrom();
+	Square to = move.GetTo();
+	int promotion = 0;
+	if (move.GetKind() == Castling)
+		to = MakeSquare(FileOf(to) == 6 ? 7 : 0, RankOf(to));
+	else if (move.GetKind() == Promotion)
+		promotion = move.GetPromotion() - Knight + 1;
+	return static_cast<std::uint16_t>(FileOf(to) | RankOf(to) << 3 | FileOf(from) << 6 | RankOf(from) << 9 |
+									  promotion << 12);
+}
+
+bool OpeningBook::Write(const std::string& filePath, std::vector<Entry>& entries)
+{
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.Key != b.Key ? a.Key < b.Key : a.Weight > b.Weight;
+	});
+
+	std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		std::cout << "Could not open " << filePath << " for writing\n";
+		return false;
+	}
+	std::vector<unsigned char> bytes(entries.size() * EntrySize);
+	for (std::size_t i = 0; i < entries.size(); i++) {
+		unsigned char* entry = &bytes[i * EntrySize];
+		WriteBigEndian(entry, entries[i].Key, 8);
+		WriteBigEndian(entry + 8, entries[i].EncodedMove, 2);
+		WriteBigEndian(entry + 10, entries[i].Weight, 2);
+		WriteBigEndian(entry + 12, entries[i].Learn, 4);
+	}
+	stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!stream) {
+		std::cout << "Could not write " << filePath << "\n";
+		return false;
+	}
+	return true;
+}
+
+std::size_t OpeningBook::FindFirst(std::uint64_t key) const
+{
+	std::size_t low = 0;
+	std::size_t high = GetEntryCount();
+	while (low < high) {
+		const std::size_t middle = low + (high - low) / 2;
+		if (ReadBigEndian(File.GetData() + middle * EntrySize, 8) < key)
+			low = middle + 1;
+		else high = middle;
+	}
+	return low;
+}
+
+OpeningBook::Entry OpeningBook::GetEntry(std::size_t index) const
+{
+	const unsigned char* bytes = File.GetData() + index * EntrySize;
+	Entry entry;
+	entry.Key = ReadBigEndian(bytes, 8);
+	entry.EncodedMove = static_cast<std::uint16_t>(ReadBigEndian(bytes + 8, 2));
+	entry.Weight = static_cast<std::uint16_t>(ReadBigEndian(bytes + 10, 2));
+	entry.Learn = static_cast<std::uint32_t>(ReadBigEndian(bytes + 12, 4));
+	return entry;
+}
@@ -0,0 +1,124 @@
+/**
+* @file OpeningBook.h
+*
+* @brief Opening book in the Polyglot .bin format, memory mapped and looked up in
+*        place. The file is a list of 16 byte entries sorted by the key of their
+*        position, so the moves of a position are found by a binary search.
+*
+* Entry layout (big endian):
+*   key    8 bytes  - key of the position
+*   move   2 bytes  - to file in bits 0-2, to rank 3-5, from file 6-8, from rank 9-11,
+*                     promotion in 12-14 (0 none, 1 knight to 4 queen). Castling is
+*                     written as the king capturing its own rook
+*   weight 2 bytes  - how often the move is played, relative to the others of the position
+*   learn  4 bytes  - unused, written as 0
+*
+* The keys are Polyglot keys, the XOR of the published random numbers of the pieces
+* on their squares, the castling rights, the en passant file when a pawn of the side
+* to move can capture there and white to move. Books of other Polyglot tools find
+* the same positions. HasStandardKeys() checks the random numbers against the keys
+* the format publishes for its test positions, books are not read or written without them.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef OPENINGBOOK_H_
+#define OPENINGBOOK_H_
+
+#include "Position.h"
+
+#include <MappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//12 pieces on 64 squares, 4 castling rights, 8 en passant files and the side to move
+const int PolyglotRandomCount = 781;
+const int PolyglotCastlingOffset = 768;
+const int PolyglotEnPassantOffset = 772;
+const int PolyglotTurnOffset = 780;
+
+//The random numbers of Polyglot keys, in the order the book format publishes them
+extern const std::uint64_t PolyglotRandom64[PolyglotRandomCount];
+
+/**
+* @brief Polyglot key of a position. The pieces are numbered black pawn, white pawn,
+*        black knight and on up to white king, and a piece on a square takes random
+*        number 64 * piece + 8 * rank + file
+*
+* @param position - Position to make the key of
+* @return std::uint64_t - The key
+*/
+std::uint64_t PolyglotKey(const Position& position);
+
+struct BookMove {
+	Move BookedMove;
+	int Weight;
+};
+
+class OpeningBook
+{
+public:
+	static const std::size_t EntrySize = 16;
+	//Polyglot key of the start position, as the book format publishes it
+	static const std::uint64_t StartPositionKey = 0x463b96181691fc9c;
+
+	//An entry as it is stored, with the byte order of the machine
+	struct Entry {
+		std::uint64_t Key;
+		std::uint16_t EncodedMove;
+		std::uint16_t Weight;
+		std::uint32_t Learn;
+	};
+
+	OpeningBook() = default;
+	~OpeningBook() = default;
+
+	//Maps the book, the entries stay mapped until Close(). Fails without HasStandardKeys()
+	bool Load(const std::string& filePath);
+	inline void Close() { File.Close(); }
+	inline bool IsLoaded() const { return File.IsOpen(); }
+	inline std::size_t GetEntryCount() const { return File.GetSize() / EntrySize; }
+
+	/**
+	* @brief Looks up the moves of a position
+	*
+	* @param position - Position to look up
+	* @param moves - Set to the legal moves the book has for the position, with their weights
+	*/
+	void GetMoves(const Position& position, std::vector<BookMove>& moves) const;
+	/**
+	* @brief Picks one of the moves the book has for a position, every move with a
+	*        chance in proportion to its weight
+	*
+	* @param position - Position to pick a move for
+	* @param random - Uniformly distributed random number
+	* @return Move - The picked move, the null move when the book has none for the position
+	*/
+	Move PickMove(const Position& position, std::uint64_t random) const;
+
+	//Key a position is stored under
+	static inline std::uint64_t GetKey(const Position& position) { return PolyglotKey(position); }
+	//Whether PolyglotKey() gives the published test positions their keys, so the keys match other Polyglot books
+	static bool HasStandardKeys();
+	//Move as it is stored in an entry
+	static std::uint16_t EncodeMove(Move move);
+	/**
+	* @brief Writes entries into a book, sorted by key and by weight within a key
+	*
+	* @param filePath - Path to the file to write
+	* @param entries - Entries of the book in any order, sorted by the call
+	* @return bool - Whether the file could be written or not
+	*/
+	static bool Write(const std::string& filePath, std::vector<Entry>& entries);
+
+private:
+	//Index of the first entry with a key not below the key
+	std::size_t FindFirst(std::uint64_t key) const;
+	Entry GetEntry(std::size_t index) const;
+
+	MappedFile File;
+};
+
+#endif // OPENINGBOOK_H_
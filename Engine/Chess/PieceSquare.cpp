@@ -0,0 +1,118 @@
+/**
+* @file PieceSquare.cpp
+*
+* @brief The material and piece-square values
+*
+* @author Aleksander Solhaug
+*/
+
+#include "PieceSquare.h"
+
+namespace {
+	constexpr int MiddlegameValues[PieceTypeCount] = { 100, 320, 330, 500, 900, 0 };
+	//Pawns grow worth more as they near promotion with fewer pieces to stop them, and minor pieces less
+	constexpr int EndgameValues[PieceTypeCount] = { 120, 300, 320, 520, 950, 0 };
+
+	//Middlegame bonus of a white piece on each square, written with rank 8 at the top as the
+	//board is seen by white. Black pieces read the tables mirrored
+	constexpr int MiddlegameTables[PieceTypeCount][SquareCount] = {
+		{	//Pawn
+			  0,   0,   0,   0,   0,   0,   0,   0,
+			 50,  50,  50,  50,  50,  50,  50,  50,
+			 10,  10,  20,  30,  30,  20,  10,  10,
+			  5,   5,  10,  25,  25,  10,   5,   5,
+			  0,   0,   0,  20,  20,   0,   0,   0,
+			  5,  -5, -10,   0,   0, -10,  -5,   5,
+			  5,  10,  10, -20, -20,  10,  10,   5,
+			  0,   0,   0,   0,   0,   0,   0,   0 },
+		{	//Knight
+			-50, -40, -30, -30, -30, -30, -40, -50,
+			-40, -20,   0,   0,   0,   0, -20, -40,
+			-30,   0,  10,  15,  15,  10,   0, -30,
+			-30,   5,  15,  20,  20,  15,   5, -30,
+			-30,   0,  15,  20,  20,  15,   0, -30,
+			-30,   5,  10,  15,  15,  10,   5, -30,
+			-40, -20,   0,   5,   5,   0, -20, -40,
+			-50, -40, -30, -30, -30, -30, -40, -50 },
+		{	//Bishop
+			-20, -10, -10, -10, -10, -10, -10, -20,
+			-10,   0,   0,   0,   0,   0,   0, -10,
+			-10,   0,   5,  10,  10,   5,   0, -10,
+			-10,   5,   5,  10,  10,   5,   5, -10,
+			-10,   0,  10,  10,  10,  10,   0, -10,
+			-10,  10,  10,  10,  10,  10,  10, -10,
+			-10,   5,   0,   0,   0,   0,   5, -10,
+			-20, -10, -10, -10, -10, -10, -10, -20 },
+		{	//Rook
+			  0,   0,   0,   0,   0,   0,   0,   0,
+			  5,  10,  10,  10,  10,  10,  10,   5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			 -5,   0,   0,   0,   0,   0,   0,  -5,
+			  0,   0,   0,   5,   5,   0,   0,   0 },
+		{	//Queen
+			-20, -10, -10,  -5,  -5, -10, -10, -20,
+			-10,   0,   0,   0,   0,   0,   0, -10,
+			-10,   0,   5,   5,   5,   5,   0, -10,
+			 -5,   0,   5,   5,   5,   5,   0,  -5,
+			  0,   0,   5,   5,   5,   5,   0,  -5,
+			-10,   5,   5,   5,   5,   5,   0, -10,
+			-10,   0,   5,   0,   0,   0,   0, -10,
+			-20, -10, -10,  -5,  -5, -10, -10, -20 },
+		{	//King, sheltered behind its pawns
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-30, -40, -40, -50, -50, -40, -40, -30,
+			-20, -30, -30, -40, -40, -30, -30, -20,
+			-10, -20, -20, -20, -20, -20, -20, -10,
+			 20,  20,   0,   0,   0,   0,  20,  20,
+			 20,  30,  10,   0,   0,  10,  30,  20 },
+	};
+
+	//In the endgame pawns are pushed for promotion and the king comes to the center to fight.
+	//The other pieces keep the squares they like in the middlegame
+	constexpr int PawnEndgameTable[SquareCount] = {
+		  0,   0,   0,   0,   0,   0,   0,   0,
+		 80,  80,  80,  80,  80,  80,  80,  80,
+		 50,  50,  50,  50,  50,  50,  50,  50,
+		 30,  30,  30,  30,  30,  30,  30,  30,
+		 15,  15,  15,  15,  15,  15,  15,  15,
+		  5,   5,   5,   5,   5,   5,   5,   5,
+		  0,   0,   0,   0,   0,   0,   0,   0,
+		  0,   0,   0,   0,   0,   0,   0,   0 };
+	constexpr int KingEndgameTable[SquareCount] = {
+		-50, -40, -30, -20, -20, -30, -40, -50,
+		-30, -20, -10,   0,   0, -10, -20, -30,
+		-30, -10,  20,  30,  30,  20, -10, -30,
+		-30, -10,  30,  40,  40,  30, -10, -30,
+		-30, -10,  30,  40,  40,  30, -10, -30,
+		-30, -10,  20,  30,  30,  20, -10, -30,
+		-30, -30,   0,   0,   0,   0, -30, -30,
+		-50, -30, -30, -30, -30, -30, -30, -50 };
+
+	constexpr PieceSquare::Table GenerateTable()
+	{
+		PieceSquare::Table table = {};
+		for (int type = 0; type < PieceTypeCount; type++) {
+			const int* endgame = type == Pawn ? PawnEndgameTable : type == King ? KingEndgameTable : MiddlegameTables[type];
+			for (int square = 0; square < SquareCount; square++) {
+				//The tables are written from rank 8 down, so a white square is flipped vertically to read them
+				const TaperedScore white = { MiddlegameValues[type] + MiddlegameTables[type][square ^ 56],
+											 EndgameValues[type] + endgame[square ^ 56] };
+				const TaperedScore black = { MiddlegameValues[type] + MiddlegameTables[type][square],
+											 EndgameValues[type] + endgame[square] };
+				table.Scores[type][square] = white;
+				table.Scores[PieceTypeCount + type][square] = { -black.Middlegame, -black.Endgame };
+			}
+		}
+		return table;
+	}
+}
+
+namespace PieceSquare {
+	const int PhaseWeights[PieceTypeCount] = { 0, 1, 1, 2, 4, 0 };
+	constexpr Table Values = GenerateTable();
+}
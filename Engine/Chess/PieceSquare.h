@@ -0,0 +1,61 @@
+/**
+* @file PieceSquare.h
+*
+* @brief Material and piece-square values of every piece on every square, as a
+*        middlegame and an endgame score. The evaluation blends the two by the
+*        phase of the game, which falls from the opening to the endgame as the
+*        pieces other than pawns come off the board. Both sums only change with
+*        the pieces a move touches, so positions keep them up to date as they move.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef PIECESQUARE_H_
+#define PIECESQUARE_H_
+
+#include "ChessTypes.h"
+
+//A middlegame and an endgame score, from the view of white
+struct TaperedScore {
+	int Middlegame;
+	int Endgame;
+
+	inline TaperedScore& operator+=(const TaperedScore& other)
+	{
+		Middlegame += other.Middlegame;
+		Endgame += other.Endgame;
+		return *this;
+	}
+	inline TaperedScore& operator-=(const TaperedScore& other)
+	{
+		Middlegame -= other.Middlegame;
+		Endgame -= other.Endgame;
+		return *this;
+	}
+	inline bool operator==(const TaperedScore& other) const
+	{
+		return Middlegame == other.Middlegame && Endgame == other.Endgame;
+	}
+};
+
+namespace PieceSquare {
+	//Phase of the starting position, every knight and bishop counts 1, every rook 2 and every queen 4
+	const int MaxPhase = 24;
+	extern const int PhaseWeights[PieceTypeCount];
+
+	struct Table {
+		TaperedScore Scores[PieceCount][SquareCount];
+	};
+
+	//Material and square bonus of every piece on every square, black pieces count negative
+	extern const Table Values;
+
+	//Blends the two scores by the phase, the middlegame score at MaxPhase and the endgame score at 0
+	inline int Taper(const TaperedScore& score, int phase)
+	{
+		phase = phase < MaxPhase ? phase : MaxPhase;
+		return (score.Middlegame * phase + score.Endgame * (MaxPhase - phase)) / MaxPhase;
+	}
+}
+
+#endif // PIECESQUARE_H_
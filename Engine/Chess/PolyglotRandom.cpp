@@ -0,0 +1,20 @@
+/**
+* @file PolyglotRandom.cpp
+*
+* @brief The random numbers of Polyglot keys. They are fixed by the book format
+*        and have to be the published ones exactly, in the published order:
+*          0   - 767  pieces on squares, 64 * piece + 8 * rank + file
+*          768 - 771  castling rights, white king side to black queen side
+*          772 - 779  en passant files a to h
+*          780        white to move
+*        The table is still to be copied in from the Polyglot book format. Until it
+*        is, OpeningBook::HasStandardKeys() fails on the published test keys and
+*        books are neither read nor written, rather than stored under keys no other
+*        Polyglot tool knows.
+*
+* @author Aleksander Solhaug
+*/
+
+#include "OpeningBook.h"
+
+const std::uint64_t PolyglotRandom64[PolyglotRandomCount] = {};
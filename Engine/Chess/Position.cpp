@@ -0,0 +1,460 @@
+/**
+* @file Position.cpp
+*
+* @brief Making and unmaking moves, and reading and writing positions as FEN
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Position.h"
+#include "Attacks.h"
+#include "MoveGen.h"
+#include "Zobrist.h"
+
+#include <cstring>
+#include <sstream>
+#include <tuple>
+
+const char* Position::StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+namespace {
+	const char PieceLetters[] = "PNBRQKpnbrqk";
+
+	//Piece type of an uppercase letter of Standard Algebraic Notation, NoPieceType for any other character
+	inline PieceType SanPieceType(char letter)
+	{
+		const char* found = letter != '\0' ? std::strchr("PNBRQK", letter) : nullptr;
+		return found ? static_cast<PieceType>(found - "PNBRQK") : NoPieceType;
+	}
+
+	//Castling rights kept when a piece moves from or to the square, a king or rook
+	//moving away or a rook being captured loses them
+	struct CastlingMaskTable {
+		int Masks[SquareCount];
+		CastlingMaskTable()
+		{
+			for (int& mask : Masks)
+				mask = AllCastlingRights;
+			Masks[E1] &= ~(WhiteKingSide | WhiteQueenSide);
+			Masks[H1] &= ~WhiteKingSide;
+			Masks[A1] &= ~WhiteQueenSide;
+			Masks[E8] &= ~(BlackKingSide | BlackQueenSide);
+			Masks[H8] &= ~BlackKingSide;
+			Masks[A8] &= ~BlackQueenSide;
+		}
+	} const CastlingMask;
+
+	//Rook squares of a castling move, from the square the king moves to
+	inline void GetCastlingRook(Square kingTo, Square& rookFrom, Square& rookTo)
+	{
+		const bool kingSide = FileOf(kingTo) == 6;
+		rookFrom = static_cast<Square>(kingSide ? kingTo + 1 : kingTo - 2);
+		rookTo = static_cast<Square>(kingSide ? kingTo - 1 : kingTo + 1);
+	}
+}
+
+Position::Position()
+{
+	SetStartPosition();
+}
+
+void Position::SetStartPosition()
+{
+	SetFen(StartFen);
+}
+
+bool Position::SetFen(const std::string& fen)
+{
+	std::istringstream stream(fen);
+	std::string placement, side, castling, enPassant;
+	if (!(stream >> placement >> side >> castling >> enPassant))
+		return false;
+
+	Position position(*this);
+	position.Placement.Clear();
+	int file = 0, rank = 7;
+	for (const char c : placement) {
+		if (c == '/') {
+			if (file != 8 || rank == 0)
+				return false;
+			file = 0;
+			rank--;
+		}
+		else if (c >= '1' && c <= '8')
+			file += c - '0';
+		else {
+			const char* letter = std::char_traits<char>::find(PieceLetters, PieceCount, c);
+			if (letter == nullptr || file > 7)
+				return false;
+			position.Placement.PutPiece(static_cast<Piece>(letter - PieceLetters), MakeSquare(file, rank));
+			file++;
+		}
+		if (file > 8)
+			return false;
+	}
+	if (file != 8 || rank != 0)
+		return false;
+	if (PopCount(position.Placement.GetPieces(White, King)) != 1 ||
+		PopCount(position.Placement.GetPieces(Black, King)) != 1)
+		return false;
+
+	if (side != "w" && side != "b")
+		return false;
+	position.SideToMove = side == "w" ? White : Black;
+
+	position.CastlingRights = 0;
+	for (const char c : castling) {
+		switch (c) {
+		case 'K': position.CastlingRights |= WhiteKingSide; break;
+		case 'Q': position.CastlingRights |= WhiteQueenSide; break;
+		case 'k': position.CastlingRights |= BlackKingSide; break;
+		case 'q': position.CastlingRights |= BlackQueenSide; break;
+		case '-': break;
+		default: return false;
+		}
+	}
+	//Rights without the king and rook on their squares can never be used
+	for (const auto& [right, king, rook] : { std::make_tuple(WhiteKingSide, E1, H1), std::make_tuple(WhiteQueenSide, E1, A1),
+											 std::make_tuple(BlackKingSide, E8, H8), std::make_tuple(BlackQueenSide, E8, A8) }) {
+		const Color color = right <= WhiteQueenSide ? White : Black;
+		if (position.Placement.GetPiece(king) != MakePiece(color, King) ||
+			position.Placement.GetPiece(rook) != MakePiece(color, Rook))
+			position.CastlingRights &= ~right;
+	}
+
+	//The en passant square is only kept when a pawn can capture on it
+	position.EnPassantSquare = NoSquare;
+	if (enPassant != "-") {
+		if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] < '1' || enPassant[1] > '8')
+			return false;
+		const Square square = MakeSquare(enPassant[0] - 'a', enPassant[1] - '1');
+		if (Attacks::Pawn(~position.SideToMove, square) & position.Placement.GetPieces(position.SideToMove, Pawn))
+			position.EnPassantSquare = square;
+	}
+
+	position.HalfmoveClock = 0;
+	position.FullmoveNumber = 1;
+	stream >> position.HalfmoveClock >> position.FullmoveNumber;
+	position.Key = position.ComputeKey();
+	position.PieceSquareScore = position.ComputePieceSquareScore();
+	position.Phase = position.ComputePhase();
+
+	*this = position;
+	return true;
+}
+
+void Position::SetBoard(const Board& board, Color sideToMove)
+{
+	Placement = board;
+	SideToMove = sideToMove;
+	CastlingRights = 0;
+	EnPassantSquare = NoSquare;
+	HalfmoveClock = 0;
+	FullmoveNumber = 1;
+	Key = ComputeKey();
+	PieceSquareScore = ComputePieceSquareScore();
+	Phase = ComputePhase();
+}
+
+std::string Position::GetFen() const
+{
+	std::string fen;
+	for (int rank = 7; rank >= 0; rank--) {
+		int empty = 0;
+		for (int file = 0; file < 8; file++) {
+			const Piece piece = Placement.GetPiece(MakeSquare(file, rank));
+			if (piece == NoPiece) {
+				empty++;
+				continue;
+			}
+			if (empty > 0)
+				fen += static_cast<char>('0' + empty);
+			empty = 0;
+			fen += PieceLetters[piece];
+		}
+		if (empty > 0)
+			fen += static_cast<char>('0' + empty);
+		if (rank > 0)
+			fen += '/';
+	}
+
+	fen += SideToMove == White ? " w " : " b ";
+	if (CastlingRights & WhiteKingSide) fen += 'K';
+	if (CastlingRights & WhiteQueenSide) fen += 'Q';
+	if (CastlingRights & BlackKingSide) fen += 'k';
+	if (CastlingRights & BlackQueenSide) fen += 'q';
+	if (CastlingRights == 0) fen += '-';
+
+	if (EnPassantSquare == NoSquare)
+		fen += " -";
+	else {
+		fen += ' ';
+		fen += static_cast<char>('a' + FileOf(EnPassantSquare));
+		fen += static_cast<char>('1' + RankOf(EnPassantSquare));
+	}
+	return fen + " " + std::to_string(HalfmoveClock) + " " + std::to_string(FullmoveNumber);
+}
+
+std::uint64_t Position::ComputeKey() const
+{
+	std::uint64_t key = 0;
+	for (Bitboard pieces = Placement.GetOccupied(); pieces;) {
+		const Square square = PopLowestSquare(pieces);
+		key ^= Zobrist::Keys.Pieces[Placement.GetPiece(square)][square];
+	}
+	key ^= Zobrist::Keys.Castling[CastlingRights];
+	if (EnPassantSquare != NoSquare)
+		key ^= Zobrist::Keys.EnPassantFile[FileOf(EnPassantSquare)];
+	if (SideToMove == Black)
+		key ^= Zobrist::Keys.BlackToMove;
+	return key;
+}
+
+TaperedScore Position::ComputePieceSquareScore() const
+{
+	TaperedScore score = { 0, 0 };
+	for (Bitboard pieces = Placement.GetOccupied(); pieces;) {
+		const Square square = PopLowestSquare(pieces);
+		score += PieceSquare::Values.Scores[Placement.GetPiece(square)][square];
+	}
+	return score;
+}
+
+int Position::ComputePhase() const
+{
+	int phase = 0;
+	for (int type = Knight; type <= Queen; type++)
+		phase += PieceSquare::PhaseWeights[type] * PopCount(Placement.GetPieces(static_cast<PieceType>(type)));
+	return phase;
+}
+
+Bitboard Position::GetAttackersTo(Square square, Bitboard occupied) const
+{
+	const Bitboard diagonal = Placement.GetPieces(Bishop) | Placement.GetPieces(Queen);
+	const Bitboard straight = Placement.GetPieces(Rook) | Placement.GetPieces(Queen);
+	return (Attacks::Pawn(Black, square) & Placement.GetPieces(White, Pawn)) |
+		   (Attacks::Pawn(White, square) & Placement.GetPieces(Black, Pawn)) |
+		   (Attacks::Knight(square) & Placement.GetPieces(Knight)) |
+		   (Attacks::King(square) & Placement.GetPieces(King)) |
+		   (Attacks::Bishop(square, occupied) & diagonal) |
+		   (Attacks::Rook(square, occupied) & straight);
+}
+
+void Position::MakeMove(Move move, MoveUndo& undo)
+{
+	const Square from = move.GetFrom();
+	const Square to = move.GetTo();
+	const Color us = SideToMove;
+	const Piece piece = Placement.GetPiece(from);
+	const auto& keys = Zobrist::Keys.Pieces;
+	const auto& scores = PieceSquare::Values.Scores;
+	undo.Captured = NoPiece;
+	undo.CastlingRights = CastlingRights;
+	undo.EnPassantSquare = EnPassantSquare;
+	undo.HalfmoveClock = HalfmoveClock;
+	undo.Key = Key;
+	undo.PieceSquareScore = PieceSquareScore;
+	undo.Phase = Phase;
+
+	//The key drops the castling rights and en passant square here and takes the new ones at the end
+	Key ^= Zobrist::Keys.Castling[CastlingRights] ^ keys[piece][from] ^ keys[piece][to];
+	PieceSquareScore += scores[piece][to];
+	PieceSquareScore -= scores[piece][from];
+	if (EnPassantSquare != NoSquare)
+		Key ^= Zobrist::Keys.EnPassantFile[FileOf(EnPassantSquare)];
+	HalfmoveClock++;
+	EnPassantSquare = NoSquare;
+	switch (move.GetKind()) {
+	case Castling: {
+		Square rookFrom, rookTo;
+		GetCastlingRook(to, rookFrom, rookTo);
+		const Piece rook = MakePiece(us, Rook);
+		Placement.MovePiece(from, to);
+		Placement.MovePiece(rookFrom, rookTo);
+		Key ^= keys[rook][rookFrom] ^ keys[rook][rookTo];
+		PieceSquareScore += scores[rook][rookTo];
+		PieceSquareScore -= scores[rook][rookFrom];
+		break;
+	}
+	case EnPassant: {
+		//The captured pawn stands behind the square moved to
+		const Square captured = static_cast<Square>(to ^ 8);
+		undo.Captured = Placement.GetPiece(captured);
+		Placement.RemovePiece(captured);
+		Placement.MovePiece(from, to);
+		Key ^= keys[undo.Captured][captured];
+		PieceSquareScore -= scores[undo.Captured][captured];
+		HalfmoveClock = 0;
+		break;
+	}
+	default:
+		if (!Placement.IsEmpty(to)) {
+			undo.Captured = Placement.GetPiece(to);
+			Placement.RemovePiece(to);
+			Key ^= keys[undo.Captured][to];
+			PieceSquareScore -= scores[undo.Captured][to];
+			Phase -= PieceSquare::PhaseWeights[TypeOf(undo.Captured)];
+			HalfmoveClock = 0;
+		}
+		Placement.MovePiece(from, to);
+		if (TypeOf(piece) != Pawn)
+			break;
+		HalfmoveClock = 0;
+		if (move.GetKind() == Promotion) {
+			const Piece promoted = MakePiece(us, move.GetPromotion());
+			Placement.RemovePiece(to);
+			Placement.PutPiece(promoted, to);
+			Key ^= keys[piece][to] ^ keys[promoted][to];
+			PieceSquareScore += scores[promoted][to];
+			PieceSquareScore -= scores[piece][to];
+			Phase += PieceSquare::PhaseWeights[move.GetPromotion()];
+		}
+		else if ((from ^ to) == 16) {
+			const Square passed = static_cast<Square>((from + to) / 2);
+			if (Attacks::Pawn(us, passed) & Placement.GetPieces(~us, Pawn)) {
+				EnPassantSquare = passed;
+				Key ^= Zobrist::Keys.EnPassantFile[FileOf(passed)];
+			}
+		}
+	}
+
+	CastlingRights &= CastlingMask.Masks[from] & CastlingMask.Masks[to];
+	Key ^= Zobrist::Keys.Castling[CastlingRights] ^ Zobrist::Keys.BlackToMove;
+	if (us == Black)
+		FullmoveNumber++;
+	SideToMove = ~us;
+}
+
+void Position::UnmakeMove(Move move, const MoveUndo& undo)
+{
+	const Square from = move.GetFrom();
+	const Square to = move.GetTo();
+	SideToMove = ~SideToMove;
+	if (SideToMove == Black)
+		FullmoveNumber--;
+
+	switch (move.GetKind()) {
+	case Castling: {
+		Square rookFrom, rookTo;
+		GetCastlingRook(to, rookFrom, rookTo);
+		Placement.MovePiece(rookTo, rookFrom);
+		Placement.MovePiece(to, from);
+		break;
+	}
+	case EnPassant:
+		Placement.MovePiece(to, from);
+		Placement.PutPiece(undo.Captured, static_cast<Square>(to ^ 8));
+		break;
+	default:
+		if (move.GetKind() == Promotion) {
+			Placement.RemovePiece(to);
+			Placement.PutPiece(MakePiece(SideToMove, Pawn), to);
+		}
+		Placement.MovePiece(to, from);
+		if (undo.Captured != NoPiece)
+			Placement.PutPiece(undo.Captured, to);
+	}
+
+	CastlingRights = undo.CastlingRights;
+	EnPassantSquare = undo.EnPassantSquare;
+	HalfmoveClock = undo.HalfmoveClock;
+	Key = undo.Key;
+	PieceSquareScore = undo.PieceSquareScore;
+	Phase = undo.Phase;
+}
+
+void Position::MakeNullMove(MoveUndo& undo)
+{
+	undo.Captured = NoPiece;
+	undo.CastlingRights = CastlingRights;
+	undo.EnPassantSquare = EnPassantSquare;
+	undo.HalfmoveClock = HalfmoveClock;
+	undo.Key = Key;
+	if (EnPassantSquare != NoSquare)
+		Key ^= Zobrist::Keys.EnPassantFile[FileOf(EnPassantSquare)];
+	Key ^= Zobrist::Keys.BlackToMove;
+	EnPassantSquare = NoSquare;
+	//The positions before the null move can not repeat after it, the clock tells the search where to stop looking
+	HalfmoveClock = 0;
+	SideToMove = ~SideToMove;
+}
+
+void Position::UnmakeNullMove(const MoveUndo& undo)
+{
+	SideToMove = ~SideToMove;
+	EnPassantSquare = undo.EnPassantSquare;
+	HalfmoveClock = undo.HalfmoveClock;
+	Key = undo.Key;
+}
+
+Move Position::ParseUciMove(const std::string& text) const
+{
+	MoveList moves;
+	GenerateLegalMoves(*this, moves);
+	for (const Move move : moves)
+		if (move.ToUci() == text)
+			return move;
+	return Move();
+}
+
+Move Position::ParseSanMove(const std::string& text) const
+{
+	std::string san = text;
+	while (!san.empty() && std::strchr("+#!?", san.back()))
+		san.pop_back();
+
+	MoveList moves;
+	GenerateLegalMoves(*this, moves);
+	if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+		const bool kingSide = san.size() == 3;
+		for (const Move move : moves)
+			if (move.GetKind() == Castling && (FileOf(move.GetTo()) == 6) == kingSide)
+				return move;
+		return Move();
+	}
+
+	//The piece letter comes first and the promotion last, pawn moves have no piece letter
+	PieceType type = SanPieceType(san.empty() ? '\0' : san[0]);
+	const std::size_t start = type == NoPieceType ? 0 : 1;
+	if (type == NoPieceType)
+		type = Pawn;
+	PieceType promotion = NoPieceType;
+	if (type == Pawn && !san.empty() && SanPieceType(san.back()) != NoPieceType) {
+		promotion = SanPieceType(san.back());
+		san.pop_back();
+		if (!san.empty() && san.back() == '=')
+			san.pop_back();
+	}
+	if (san.size() < start + 2)
+		return Move();
+	const int toFile = san[san.size() - 2] - 'a';
+	const int toRank = san[san.size() - 1] - '1';
+	if (!IsOnBoard(toFile, toRank))
+		return Move();
+
+	//Whatever stands between the piece and the square narrows down the square moved from
+	int fromFile = -1, fromRank = -1;
+	for (std::size_t i = start; i + 2 < san.size(); i++) {
+		if (san[i] >= 'a' && san[i] <= 'h')
+			fromFile = san[i] - 'a';
+		else if (san[i] >= '1' && san[i] <= '8')
+			fromRank = san[i] - '1';
+		else if (san[i] != 'x' && san[i] != '-')
+			return Move();
+	}
+
+	const Square to = MakeSquare(toFile, toRank);
+	Move found;
+	for (const Move move : moves) {
+		const Square from = move.GetFrom();
+		if (move.GetTo() != to || move.GetKind() == Castling || TypeOf(Placement.GetPiece(from)) != type ||
+			(fromFile >= 0 && FileOf(from) != fromFile) || (fromRank >= 0 && RankOf(from) != fromRank))
+			continue;
+		if (move.GetKind() == Promotion ? move.GetPromotion() != promotion : promotion != NoPieceType)
+			continue;
+		if (!found.IsNull())
+			return Move();
+		found = move;
+	}
+	return found;
+}
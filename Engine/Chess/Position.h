@@ -0,0 +1,127 @@
+/**
+* @file Position.h
+*
+* @brief A chess position: the placement of the pieces, the side to move, the
+*        castling rights and the en passant square. Moves are made and unmade in
+*        place, the state a move can not be undone from is kept by the caller in a
+*        MoveUndo, so searching a tree copies nothing but a few bytes per move.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef POSITION_H_
+#define POSITION_H_
+
+#include "Board.h"
+#include "Move.h"
+#include "PieceSquare.h"
+
+#include <cstdint>
+#include <string>
+
+enum CastlingRight {
+	WhiteKingSide = 1, WhiteQueenSide = 2, BlackKingSide = 4, BlackQueenSide = 8,
+	AllCastlingRights = 15
+};
+
+//What a move destroys, to restore the position when it is unmade
+struct MoveUndo {
+	Piece Captured;
+	int CastlingRights;
+	Square EnPassantSquare;
+	int HalfmoveClock;
+	std::uint64_t Key;
+	TaperedScore PieceSquareScore;
+	int Phase;
+};
+
+class Position
+{
+public:
+	static const char* StartFen;
+
+	//The initial position
+	Position();
+
+	void SetStartPosition();
+	/**
+	* @brief Sets up the position from Forsyth-Edwards Notation. The move counters
+	*        may be left out.
+	*
+	* @param fen - The position, like StartFen
+	* @return bool - Whether the notation was valid, the position is unchanged when it was not
+	*/
+	bool SetFen(const std::string& fen);
+	std::string GetFen() const;
+	/**
+	* @brief Sets up the position from a placement of pieces, without castling rights
+	*        or an en passant square and with the move counters at their start
+	*
+	* @param board - The pieces, with a king of either color
+	* @param sideToMove - Side to move in the position
+	*/
+	void SetBoard(const Board& board, Color sideToMove);
+
+	inline const Board& GetBoard() const { return Placement; }
+	inline Color GetSideToMove() const { return SideToMove; }
+	inline int GetCastlingRights() const { return CastlingRights; }
+	//Square a pawn can capture en passant on, NoSquare when no pawn can
+	inline Square GetEnPassantSquare() const { return EnPassantSquare; }
+	inline int GetHalfmoveClock() const { return HalfmoveClock; }
+	inline int GetFullmoveNumber() const { return FullmoveNumber; }
+	inline Square GetKingSquare(Color color) const { return LowestSquare(Placement.GetPieces(color, King)); }
+
+	//Zobrist key of the position, kept up to date by every move
+	inline std::uint64_t GetKey() const { return Key; }
+	//Zobrist key of the position computed from all its pieces, to check the kept key against
+	std::uint64_t ComputeKey() const;
+	//Sum of the material and piece-square values of all pieces, kept up to date by every move
+	inline const TaperedScore& GetPieceSquareScore() const { return PieceSquareScore; }
+	//Phase of the game from the pieces other than pawns on the board, kept up to date by every move
+	inline int GetPhase() const { return Phase; }
+	//The sums computed from all pieces, to check the kept ones against
+	TaperedScore ComputePieceSquareScore() const;
+	int ComputePhase() const;
+
+	//Pieces of both colors attacking the square, with the given squares occupied
+	Bitboard GetAttackersTo(Square square, Bitboard occupied) const;
+	//Pieces of the other side giving check to the side to move
+	inline Bitboard GetCheckers() const
+	{
+		const Square king = GetKingSquare(SideToMove);
+		return GetAttackersTo(king, Placement.GetOccupied()) & Placement.GetPieces(~SideToMove);
+	}
+	inline bool IsInCheck() const { return GetCheckers() != 0; }
+
+	//Makes a legal move, the undo record has to be passed to UnmakeMove()
+	void MakeMove(Move move, MoveUndo& undo);
+	//Takes back the last move made
+	void UnmakeMove(Move move, const MoveUndo& undo);
+	//Passes the turn to the other side, for null move pruning. Not allowed in check
+	void MakeNullMove(MoveUndo& undo);
+	void UnmakeNullMove(const MoveUndo& undo);
+
+	//The legal move written in UCI notation, the null move when there is none
+	Move ParseUciMove(const std::string& text) const;
+	/**
+	* @brief Reads a move in Standard Algebraic Notation, like Nbd7, exd5, e8=Q+ or O-O.
+	*        Check marks and annotations like ! and ? are ignored.
+	*
+	* @param text - The move
+	* @return Move - The legal move, the null move when there is none or the text fits several
+	*/
+	Move ParseSanMove(const std::string& text) const;
+
+private:
+	Board Placement;
+	Color SideToMove;
+	int CastlingRights;
+	Square EnPassantSquare;
+	int HalfmoveClock;			//Moves since the last capture or pawn move
+	int FullmoveNumber;
+	std::uint64_t Key;
+	TaperedScore PieceSquareScore;
+	int Phase;
+};
+
+#endif // POSITION_H_
@@ -0,0 +1,498 @@
+/**
+* @file Search.cpp
+*
+* @brief Principal variation search with quiescence, move ordering, null move pruning
+*        and threads sharing a transposition table
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Search.h"
+#include "Evaluate.h"
+#include "Nnue.h"
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+	//Move ordering classes, every move of a class is tried before the moves of the next one
+	const int FirstMoveScore = 1 << 30;
+	const int CaptureScore = 1 << 20;
+	const int KillerScore = 1 << 19;
+	const int HistoryLimit = 1 << 18;		//History is halved when it grows past this, so it stays below the killers
+
+	//Helper threads skip some iterations, so they search other depths than the main thread at the
+	//same time and fill the table with positions it will need. A helper with the phase p and the size s
+	//skips the depths d where (d + p) / s is odd
+	const int SkipSize[] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+	const int SkipPhase[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+	const int SkipCount = sizeof(SkipSize) / sizeof(SkipSize[0]);
+
+	//Mate scores count the plies from the root, the table stores them counted from the position
+	inline int ScoreToTable(int score, int ply)
+	{
+		return score >= Search::MateBound ? score + ply : score <= -Search::MateBound ? score - ply : score;
+	}
+
+	inline int ScoreFromTable(int score, int ply)
+	{
+		return score >= Search::MateBound ? score - ply : score <= -Search::MateBound ? score + ply : score;
+	}
+}
+
+struct Search::Worker {
+	Worker(Search& owner, int index);
+
+	//Sets up the root and forgets the killers and history of the previous search
+	void Prepare(const Position& position, const std::vector<std::uint64_t>& history);
+	//Searches one iteration deeper at a time until the search is stopped or the depth reached
+	void Iterate(int maxDepth);
+
+	int AlphaBeta(int alpha, int beta, int depth, int ply, bool nullAllowed);
+	int Quiescence(int alpha, int beta, int ply);
+
+	//Scores the moves for ordering, the move to try first scores highest
+	void ScoreMoves(const MoveList& moves, int* scores, Move firstMove, int ply) const;
+	//Swaps the highest scoring move of those left into the given index
+	static void PickNextMove(MoveList& moves, int* scores, int index);
+
+	//Moves on the board and keeps the accumulators of the network up to date with it
+	inline void MakeMove(Move move, MoveUndo& undo)
+	{
+		Root.MakeMove(move, undo);
+		if (Owner.Net)
+			Accumulators.Push(Root, move, undo);
+	}
+	inline void UnmakeMove(Move move, const MoveUndo& undo)
+	{
+		Root.UnmakeMove(move, undo);
+		if (Owner.Net)
+			Accumulators.Pop();
+	}
+	//A null move changes no feature, the accumulator of the position before it still holds
+	inline int EvaluateRoot() const { return Owner.Net ? Accumulators.Evaluate(Root) : Evaluate(Root); }
+
+	//Scores the position from the tablebases, false when they do not have it
+	bool ProbeTablebases(int ply, int& score);
+	bool IsCapture(Move move) const;
+	bool IsDraw(int ply) const;
+	bool HasNonPawnMaterial(Color color) const;
+	inline bool IsStopped() const { return Owner.Stopped.load(std::memory_order_relaxed); }
+	//Only this thread writes its count, the main thread reads it for the node limit
+	inline void CountNode()
+	{
+		const std::uint64_t nodes = Nodes.load(std::memory_order_relaxed) + 1;
+		Nodes.store(nodes, std::memory_order_relaxed);
+		if (Index == 0 && (nodes & 2047) == 0)
+			Owner.CheckLimits();
+	}
+
+	Search& Owner;
+	const int Index;				//0 for the main thread
+	Position Root;
+	std::atomic<std::uint64_t> Nodes;
+	std::uint64_t TablebaseHits;
+	Nnue::AccumulatorStack Accumulators;	//Only kept when the search has a network
+
+	//Keys of the game before the root followed by the keys of the positions on the current line
+	std::vector<std::uint64_t> Keys;
+	int RootKeyIndex;
+
+	//Triangular table, every ply stores the principal variation found below it
+	Move PrincipalVariation[MaxPly + 1][MaxPly + 1];
+	int PrincipalVariationLength[MaxPly + 1];
+	Move Killers[MaxPly + 1][2];			//Quiet moves that caused a cutoff at the ply
+	int History[ColorCount][SquareCount][SquareCount];	//Depth squared of every cutoff by a quiet move
+
+	//The result of the thread, from its deepest iteration
+	int CompletedDepth;
+	Move BestMove;
+	int BestScore;
+	int RootScore;					//Score of the best root move searched to the end
+	std::vector<Move> Variation;
+};
+
+Search::Worker::Worker(Search& owner, int index)
+	: Owner(owner), Index(index), Nodes(0), TablebaseHits(0), RootKeyIndex(0), CompletedDepth(0), BestScore(0), RootScore(0)
+{
+	std::memset(PrincipalVariationLength, 0, sizeof(PrincipalVariationLength));
+	std::memset(History, 0, sizeof(History));
+}
+
+void Search::Worker::Prepare(const Position& position, const std::vector<std::uint64_t>& history)
+{
+	Root = position;
+	if (Owner.Net)
+		Accumulators.Reset(*Owner.Net, Root);
+	Nodes.store(0, std::memory_order_relaxed);
+	TablebaseHits = 0;
+	Keys.assign(history.begin(), history.end());
+	RootKeyIndex = static_cast<int>(Keys.size());
+	Keys.resize(Keys.size() + MaxPly + 1);
+	for (auto& killers : Killers)
+		killers[0] = killers[1] = Move();
+	std::memset(History, 0, sizeof(History));
+	CompletedDepth = 0;
+	BestMove = Move();
+	BestScore = 0;
+	Variation.clear();
+}
+
+void Search::Worker::Iterate(int maxDepth)
+{
+	for (int depth = 1; depth <= maxDepth; depth++) {
+		if (Index > 0) {
+			const int helper = (Index - 1) % SkipCount;
+			if ((depth + SkipPhase[helper]) / SkipSize[helper] % 2 != 0)
+				continue;
+		}
+		const int score = AlphaBeta(-Infinite, Infinite, depth, 0, false);
+
+		//An iteration cut short is only trusted for the moves it searched to the end, which
+		//left a principal variation behind when they beat the best move of the iteration before
+		const bool completed = !IsStopped();
+		if (PrincipalVariationLength[0] > 0) {
+			BestMove = PrincipalVariation[0][0];
+			BestScore = completed ? score : RootScore;
+			Variation.assign(PrincipalVariation[0], PrincipalVariation[0] + PrincipalVariationLength[0]);
+		}
+		if (!completed)
+			break;
+		CompletedDepth = depth;
+
+		//No deeper iteration finds a shorter mate
+		if (std::abs(score) >= MateBound && MateValue - std::abs(score) <= depth)
+			break;
+	}
+}
+
+int Search::Worker::AlphaBeta(int alpha, int beta, int depth, int ply, bool nullAllowed)
+{
+	if (depth <= 0)
+		return Quiescence(alpha, beta, ply);
+
+	PrincipalVariationLength[ply] = 0;
+	CountNode();
+	if (IsStopped())
+		return 0;
+
+	const std::uint64_t key = Root.GetKey();
+	Keys[RootKeyIndex + ply] = key;
+	if (ply > 0 && IsDraw(ply))
+		return 0;
+	if (ply >= MaxPly)
+		return EvaluateRoot();
+	int endingScore;
+	if (ply > 0 && ProbeTablebases(ply, endingScore))
+		return endingScore;
+
+	const bool pvNode = beta - alpha > 1;
+
+	//A search of the position at least as deep settles the node, unless it is on the principal
+	//variation, which is searched again to keep its moves
+	TableEntry entry;
+	Move tableMove;
+	if (Owner.Table.Probe(key, entry)) {
+		tableMove = entry.BestMove;
+		const int score = ScoreFromTable(entry.Score, ply);
+		if (!pvNode && entry.Depth >= depth &&
+			(entry.ScoreBound == ExactBound || (entry.ScoreBound == LowerBound && score >= beta) ||
+			 (entry.ScoreBound == UpperBound && score <= alpha)))
+			return score;
+	}
+
+	const bool inCheck = Root.IsInCheck();
+	const Color us = Root.GetSideToMove();
+
+	//When passing the turn still keeps the score above beta, a real move will too. Without
+	//pieces other than pawns passing may be the best move there is, so it is not tried
+	if (!pvNode && nullAllowed && !inCheck && depth >= 3 && HasNonPawnMaterial(us) && EvaluateRoot() >= beta) {
+		const int reduction = depth >= 6 ? 3 : 2;
+		MoveUndo undo;
+		Root.MakeNullMove(undo);
+		Owner.Table.Prefetch(Root.GetKey());
+		const int score = -AlphaBeta(-beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+		Root.UnmakeNullMove(undo);
+		if (IsStopped())
+			return 0;
+		if (score >= beta)
+			return score >= MateBound ? beta : score;
+	}
+
+	MoveList moves;
+	GenerateLegalMoves(Root, moves);
+	if (moves.GetSize() == 0)
+		return inCheck ? -MateValue + ply : 0;
+
+	int scores[256];
+	ScoreMoves(moves, scores, tableMove, ply);
+
+	//Checks are searched one ply deeper, so a line of checks does not end in the middle of them
+	const int newDepth = depth - 1 + (inCheck ? 1 : 0);
+	const int originalAlpha = alpha;
+	int bestScore = -Infinite;
+	Move bestMove;
+	for (int i = 0; i < moves.GetSize(); i++) {
+		PickNextMove(moves, scores, i);
+		const Move move = moves.Moves[i];
+		const bool quiet = !IsCapture(move) && move.GetKind() != Promotion;
+
+		MoveUndo undo;
+		MakeMove(move, undo);
+		//The bucket of the position loads while the child checks for draws and counts itself
+		Owner.Table.Prefetch(Root.GetKey());
+		int score;
+		if (i == 0)
+			score = -AlphaBeta(-beta, -alpha, newDepth, ply + 1, true);
+		else {
+			//The later moves are expected to be worse, which a null window proves cheaply
+			score = -AlphaBeta(-alpha - 1, -alpha, newDepth, ply + 1, true);
+			if (score > alpha && score < beta)
+				score = -AlphaBeta(-beta, -alpha, newDepth, ply + 1, true);
+		}
+		UnmakeMove(move, undo);
+		if (IsStopped())
+			return 0;
+
+		bestScore = std::max(bestScore, score);
+		if (score <= alpha)
+			continue;
+		alpha = score;
+		bestMove = move;
+		PrincipalVariation[ply][0] = move;
+		std::copy(PrincipalVariation[ply + 1], PrincipalVariation[ply + 1] + PrincipalVariationLength[ply + 1],
+				  PrincipalVariation[ply] + 1);
+		PrincipalVariationLength[ply] = PrincipalVariationLength[ply + 1] + 1;
+		if (ply == 0)
+			RootScore = score;
+
+		if (alpha >= beta) {
+			if (quiet) {
+				if (Killers[ply][0] != move) {
+					Killers[ply][1] = Killers[ply][0];
+					Killers[ply][0] = move;
+				}
+				int& history = History[us][move.GetFrom()][move.GetTo()];
+				history += depth * depth;
+				if (history > HistoryLimit)
+					for (auto& from : History[us])
+						for (int& entry : from)
+							entry /= 2;
+			}
+			break;
+		}
+	}
+
+	//A node where no move raised alpha keeps the move it was ordered by
+	const Bound bound = bestScore >= beta ? LowerBound : bestScore > originalAlpha ? ExactBound : UpperBound;
+	Owner.Table.Store(key, bestMove.IsNull() ? tableMove : bestMove, ScoreToTable(bestScore, ply), depth, bound);
+	return bestScore;
+}
+
+int Search::Worker::Quiescence(int alpha, int beta, int ply)
+{
+	PrincipalVariationLength[ply] = 0;
+	CountNode();
+	if (IsStopped())
+		return 0;
+	if (ply >= MaxPly)
+		return EvaluateRoot();
+	int endingScore;
+	if (ProbeTablebases(ply, endingScore))
+		return endingScore;
+
+	//The side to move may stand pat instead of capturing, unless it is in check and has to get out of it
+	const bool inCheck = Root.IsInCheck();
+	int bestScore = -Infinite;
+	if (!inCheck) {
+		bestScore = EvaluateRoot();
+		if (bestScore >= beta)
+			return bestScore;
+		alpha = std::max(alpha, bestScore);
+	}
+
+	MoveList moves;
+	GenerateLegalMoves(Root, moves, inCheck ? AllMoves : Captures);
+	if (inCheck && moves.GetSize() == 0)
+		return -MateValue + ply;
+
+	int scores[256];
+	ScoreMoves(moves, scores, Move(), ply);
+	for (int i = 0; i < moves.GetSize(); i++) {
+		PickNextMove(moves, scores, i);
+		const Move move = moves.Moves[i];
+		MoveUndo undo;
+		MakeMove(move, undo);
+		const int score = -Quiescence(-beta, -alpha, ply + 1);
+		UnmakeMove(move, undo);
+		if (IsStopped())
+			return 0;
+
+		bestScore = std::max(bestScore, score);
+		if (score > alpha) {
+			alpha = score;
+			if (alpha >= beta)
+				break;
+		}
+	}
+	return bestScore;
+}
+
+void Search::Worker::ScoreMoves(const MoveList& moves, int* scores, Move firstMove, int ply) const
+{
+	const Board& board = Root.GetBoard();
+	const Color us = Root.GetSideToMove();
+	for (int i = 0; i < moves.GetSize(); i++) {
+		const Move move = moves.Moves[i];
+		if (move == firstMove)
+			scores[i] = FirstMoveScore;
+		else if (IsCapture(move) || move.GetKind() == Promotion) {
+			//Most valuable victim first, and of the attackers of one victim the least valuable.
+			//A promotion counts the piece it creates as its victim
+			const PieceType victim = move.GetKind() == EnPassant ? Pawn
+								   : move.GetKind() == Promotion && board.IsEmpty(move.GetTo()) ? move.GetPromotion()
+								   : TypeOf(board.GetPiece(move.GetTo()));
+			scores[i] = CaptureScore + victim * 8 - TypeOf(board.GetPiece(move.GetFrom()));
+		}
+		else if (move == Killers[ply][0])
+			scores[i] = KillerScore + 1;
+		else if (move == Killers[ply][1])
+			scores[i] = KillerScore;
+		else scores[i] = History[us][move.GetFrom()][move.GetTo()];
+	}
+}
+
+void Search::Worker::PickNextMove(MoveList& moves, int* scores, int index)
+{
+	//A cutoff usually comes from one of the first moves, so sorting the whole list would be wasted
+	int best = index;
+	for (int i = index + 1; i < moves.GetSize(); i++)
+		if (scores[i] > scores[best])
+			best = i;
+	std::swap(moves.Moves[index], moves.Moves[best]);
+	std::swap(scores[index], scores[best]);
+}
+
+bool Search::Worker::ProbeTablebases(int ply, int& score)
+{
+	Tablebase::ProbeResult ending;
+	if (!Owner.Endings || !Owner.Endings->Probe(Root, ending))
+		return false;
+	//The tables count the plies to the mate from the position, the search from the root
+	TablebaseHits++;
+	score = ending.Result == Tablebase::Draw ? 0
+		  : ending.Result == Tablebase::Win ? MateValue - ply - ending.Plies : -MateValue + ply + ending.Plies;
+	return true;
+}
+
+bool Search::Worker::IsCapture(Move move) const
+{
+	return move.GetKind() == EnPassant || (move.GetKind() != Castling && !Root.GetBoard().IsEmpty(move.GetTo()));
+}
+
+bool Search::Worker::IsDraw(int ply) const
+{
+	if (Root.GetHalfmoveClock() >= 100)
+		return true;
+	//A position can only repeat since the last capture or pawn move, and only with the same side to move.
+	//Repeating a position once is enough, whatever avoids the repetition now avoids it then
+	const int index = RootKeyIndex + ply;
+	const std::uint64_t key = Keys[index];
+	for (int i = index - 4; i >= 0 && i >= index - Root.GetHalfmoveClock(); i -= 2)
+		if (Keys[i] == key)
+			return true;
+	return false;
+}
+
+bool Search::Worker::HasNonPawnMaterial(Color color) const
+{
+	const Board& board = Root.GetBoard();
+	return (board.GetPieces(color) & ~board.GetPieces(Pawn) & ~board.GetPieces(King)) != 0;
+}
+
+Search::Search()
+	: Net(nullptr), Endings(nullptr), Stopped(false)
+{
+	SetThreadCount(1);
+}
+
+Search::~Search() = default;
+
+void Search::SetThreadCount(int count)
+{
+	count = std::max(count, 1);
+	Workers.resize(std::min<std::size_t>(Workers.size(), count));
+	while (static_cast<int>(Workers.size()) < count)
+		Workers.push_back(std::make_unique<Worker>(*this, static_cast<int>(Workers.size())));
+}
+
+bool Search::SetHashSize(std::size_t megabytes, bool hugePages)
+{
+	return Table.Resize(megabytes, hugePages);
+}
+
+void Search::ClearHash()
+{
+	Table.Clear();
+}
+
+SearchResult Search::Run(const Position& position, const SearchLimits& limits, const std::vector<std::uint64_t>& history)
+{
+	Limits = limits;
+	StartTime = std::chrono::steady_clock::now();
+	Stopped.store(false, std::memory_order_relaxed);
+	Table.NewSearch();
+
+	SearchResult result;
+	MoveList rootMoves;
+	GenerateLegalMoves(position, rootMoves);
+	if (rootMoves.GetSize() == 0) {
+		result.Score = position.IsInCheck() ? -MateValue : 0;
+		return result;
+	}
+
+	//The helpers search until the main thread is done, they only stop on their own when they reach the depth
+	const int maxDepth = std::min(std::max(limits.MaxDepth, 1), MaxPly - 1);
+	for (const auto& worker : Workers)
+		worker->Prepare(position, history);
+	std::vector<std::thread> helpers;
+	for (std::size_t i = 1; i < Workers.size(); i++)
+		helpers.emplace_back([this, i, maxDepth]() { Workers[i]->Iterate(maxDepth); });
+	Workers[0]->Iterate(maxDepth);
+	Stop();
+	for (std::thread& helper : helpers)
+		helper.join();
+
+	//A helper that completed a deeper iteration than the main thread knows the better move
+	const Worker* best = Workers[0].get();
+	for (const auto& worker : Workers)
+		if (worker->CompletedDepth > best->CompletedDepth && !worker->BestMove.IsNull())
+			best = worker.get();
+	//A move to play even when the first iteration is stopped before it completes a move
+	result.BestMove = best->BestMove.IsNull() ? rootMoves.Moves[0] : best->BestMove;
+	result.Score = best->BestScore;
+	result.Depth = best->CompletedDepth;
+	result.PrincipalVariation = best->Variation;
+	for (const auto& worker : Workers) {
+		result.Nodes += worker->Nodes.load(std::memory_order_relaxed);
+		result.TablebaseHits += worker->TablebaseHits;
+	}
+	result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+	return result;
+}
+
+void Search::CheckLimits()
+{
+	if (Limits.MaxNodes > 0) {
+		std::uint64_t nodes = 0;
+		for (const auto& worker : Workers)
+			nodes += worker->Nodes.load(std::memory_order_relaxed);
+		if (nodes >= Limits.MaxNodes)
+			Stop();
+	}
+	if (Limits.MoveTimeMs > 0 && std::chrono::steady_clock::now() - StartTime >= std::chrono::milliseconds(Limits.MoveTimeMs))
+		Stop();
+}
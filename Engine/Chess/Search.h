@@ -0,0 +1,115 @@
+/**
+* @file Search.h
+*
+* @brief Finds the best move of a position with an iteratively deepened principal
+*        variation search. The leaves are resolved by a quiescence search over the
+*        captures, moves are tried in order of the move stored for the position,
+*        most valuable victim by least valuable attacker, killer moves and history,
+*        and null moves prune the nodes where even passing keeps the score above beta.
+*        Several threads search the same root at staggered depths and share their
+*        results through the transposition table, the main thread decides when to stop.
+*        Positions are scored by a network when one is set, otherwise by the
+*        handcrafted evaluation. Endings found in the tablebases, when they are set,
+*        are scored by them without searching any further.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include "MoveGen.h"
+#include "Tablebase.h"
+#include "TranspositionTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Nnue {
+	class Network;
+}
+
+//When the search has to stop, it stops at whichever limit it reaches first
+struct SearchLimits {
+	int MaxDepth = 64;
+	int MoveTimeMs = 0;				//0 for no time limit
+	std::uint64_t MaxNodes = 0;		//0 for no node limit
+};
+
+struct SearchResult {
+	Move BestMove;				//The null move when the side to move has no legal move
+	int Score = 0;				//Centipawns for the side to move, or a mate score
+	int Depth = 0;				//Deepest iteration that completed
+	std::uint64_t Nodes = 0;	//Nodes of all threads
+	std::uint64_t TablebaseHits = 0;	//Positions of all threads scored by the tablebases
+	double Seconds = 0.0;
+	std::vector<Move> PrincipalVariation;
+};
+
+class Search
+{
+public:
+	static const int MaxPly = 128;
+	static const int MateValue = 32000;				//Score of a mate on the board, a mate in n plies scores n less
+	//Scores beyond it are mates, found by the search or as deep as the tablebases reach past its plies
+	static const int MateBound = MateValue - MaxPly - Tablebase::MaxPlies;
+	static const int Infinite = MateValue + 1;
+
+	Search();
+	~Search();
+
+	Search(const Search&) = delete;
+	Search& operator=(const Search&) = delete;
+
+	//Threads searching together, the calling thread is one of them. Not while a search runs
+	void SetThreadCount(int count);
+	inline int GetThreadCount() const { return static_cast<int>(Workers.size()); }
+	//Size of the transposition table in MB, which also clears it. Not while a search runs.
+	//Returns false and keeps the old table when the memory can not be had
+	bool SetHashSize(std::size_t megabytes, bool hugePages = true);
+	//Forgets all searched positions, so the next search starts like the first
+	void ClearHash();
+	//Network to score positions with, nullptr for the handcrafted evaluation. Has to stay loaded while searches run
+	inline void SetNetwork(const Nnue::Network* network) { Net = network; }
+	inline const Nnue::Network* GetNetwork() const { return Net; }
+	//Tablebases to score endings with, nullptr for none. Have to stay loaded while searches run
+	inline void SetTablebases(const Tablebase::Tables* tablebases) { Endings = tablebases; }
+	inline const Tablebase::Tables* GetTablebases() const { return Endings; }
+
+	/**
+	* @brief Searches the position one iteration deeper at a time until a limit is
+	*        reached or Stop() is called, and returns the best move of the deepest
+	*        iteration. An iteration cut short still improves the move it searched first.
+	*
+	* @param position - Position to find the best move of
+	* @param limits - When to stop searching
+	* @param history - Keys of the positions of the game before this one, oldest first,
+	*                  so the search sees repetitions of them as draws
+	* @return SearchResult - The best move, its score and the principal variation
+	*/
+	SearchResult Run(const Position& position, const SearchLimits& limits,
+					 const std::vector<std::uint64_t>& history = {});
+
+	//Makes a running search return as soon as it can, from any thread
+	inline void Stop() { Stopped.store(true, std::memory_order_relaxed); }
+
+private:
+	//The state of one searching thread, defined with the search
+	struct Worker;
+
+	//Checks the limits for the main thread, which stops all the others
+	void CheckLimits();
+
+	std::vector<std::unique_ptr<Worker>> Workers;
+	TranspositionTable Table;
+	const Nnue::Network* Net;
+	const Tablebase::Tables* Endings;
+	std::atomic<bool> Stopped;
+	SearchLimits Limits;
+	std::chrono::steady_clock::time_point StartTime;
+};
+
+#endif // SEARCH_H_
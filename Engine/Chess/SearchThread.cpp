@@ -0,0 +1,51 @@
+/**
+* @file SearchThread.cpp
+*
+* @brief Searching on a background thread
+*
+* @author Aleksander Solhaug
+*/
+
+#include "SearchThread.h"
+
+SearchThread::SearchThread()
+	: Finished(false) {}
+
+SearchThread::~SearchThread()
+{
+	Stop();
+}
+
+void SearchThread::Start(const Position& position, const SearchLimits& limits, std::vector<std::uint64_t> history,
+						 std::function<void()> onFinished)
+{
+	Stop();
+	Finished.store(false, std::memory_order_relaxed);
+	Thread = std::thread([this, position, limits, history = std::move(history), onFinished = std::move(onFinished)]() {
+		Result = Searcher.Run(position, limits, history);
+		Finished.store(true, std::memory_order_release);
+		if (onFinished)
+			onFinished();
+	});
+}
+
+void SearchThread::Stop()
+{
+	if (!Thread.joinable())
+		return;
+	//The search clears the flag when it starts, so it is raised until the search is seen to have finished
+	while (!Finished.load(std::memory_order_acquire)) {
+		Searcher.Stop();
+		std::this_thread::yield();
+	}
+	Thread.join();
+}
+
+bool SearchThread::TakeResult(SearchResult& result)
+{
+	if (!Thread.joinable() || !Finished.load(std::memory_order_acquire))
+		return false;
+	Thread.join();
+	result = std::move(Result);
+	return true;
+}
@@ -0,0 +1,61 @@
+/**
+* @file SearchThread.h
+*
+* @brief Runs a search on a thread of its own, so the thread running the game keeps
+*        stepping and handing frames to the renderer while the engine thinks. The
+*        result is polled from the game thread once the search finished.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef SEARCHTHREAD_H_
+#define SEARCHTHREAD_H_
+
+#include "Search.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+class SearchThread {
+public:
+	SearchThread();
+	~SearchThread();
+
+	SearchThread(const SearchThread&) = delete;
+	SearchThread& operator=(const SearchThread&) = delete;
+
+	/**
+	* @brief Starts searching a copy of the position, a search still running is stopped first
+	*
+	* @param position - Position to find the best move of
+	* @param limits - When to stop searching
+	* @param history - Keys of the positions of the game before this one, oldest first
+	* @param onFinished - Called on the search thread when the result is ready, to wake up
+	*                     a thread waiting for events. May be empty
+	*/
+	void Start(const Position& position, const SearchLimits& limits, std::vector<std::uint64_t> history,
+			   std::function<void()> onFinished = {});
+	//Stops the search and waits for the thread, its result is thrown away
+	void Stop();
+
+	//The search run on the thread, to set its threads and hash size while it is not busy
+	inline Search& GetSearch() { return Searcher; }
+	//Whether a search was started and its result not taken yet
+	bool IsBusy() const { return Thread.joinable(); }
+	/**
+	* @brief Hands out the result of a finished search once
+	*
+	* @param result - Set to the result when the search finished
+	* @return bool - Whether the search finished, false while it is still running or when none was started
+	*/
+	bool TakeResult(SearchResult& result);
+
+private:
+	Search Searcher;
+	std::thread Thread;
+	std::atomic<bool> Finished;
+	SearchResult Result;		//Written by the search thread before Finished is set
+};
+
+#endif // SEARCHTHREAD_H_
@@ -0,0 +1,317 @@
+/**
+* @file Tablebase.cpp
+*
+* @brief Numbering the positions of endings, and looking them up in and writing
+*        tablebase files
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Tablebase.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace Tablebase {
+	namespace {
+		const char TablebaseMagic[4] = { 'C', 'H', 'T', 'B' };
+		const char PieceLetters[PieceTypeCount + 1] = "PNBRQK";
+
+		//The a1-d1-d4 triangle the white king is turned into without pawns
+		const Square TriangleSquares[10] = { A1, B1, C1, D1, B2, C2, D2, C3, D3, D4 };
+
+		struct TriangleTable {
+			int Index[SquareCount];
+			TriangleTable()
+			{
+				std::fill(Index, Index + SquareCount, -1);
+				for (int i = 0; i < 10; i++)
+					Index[TriangleSquares[i]] = i;
+			}
+		};
+		const TriangleTable Triangle;
+
+		//Piece values to tell the stronger side by, the kings left out
+		const int PieceValues[PieceTypeCount] = { 1, 3, 3, 5, 9, 0 };
+
+		int GetStrength(const std::vector<PieceType>& pieces)
+		{
+			int strength = 0;
+			for (const PieceType type : pieces)
+				strength += PieceValues[type];
+			return strength;
+		}
+
+		inline Square Transpose(Square square) { return static_cast<Square>(FileOf(square) << 3 | RankOf(square)); }
+
+		inline std::size_t AlignUp(std::size_t offset) { return (offset + Tables::Alignment - 1) / Tables::Alignment * Tables::Alignment; }
+	}
+
+	bool Material::Parse(const std::string& name, Material& material)
+	{
+		//The letters of both sides, each starting with its king
+		std::vector<PieceType> sides[ColorCount];
+		int side = -1;
+		for (const char c : name) {
+			if (c == 'v')
+				continue;
+			const char* letter = std::strchr(PieceLetters, c);
+			if (c == '\0' || letter == nullptr)
+				return false;
+			const auto type = static_cast<PieceType>(letter - PieceLetters);
+			if (type == King) {
+				if (++side >= ColorCount)
+					return false;
+			}
+			else if (side < 0)
+				return false;
+			else sides[side].push_back(type);
+		}
+		if (side != Black || sides[White].size() + sides[Black].size() + 2 > static_cast<std::size_t>(MaxPieces))
+			return false;
+
+		for (auto& pieces : sides)
+			std::sort(pieces.begin(), pieces.end(), [](PieceType a, PieceType b) { return a > b; });
+		//The side with more material is white, of equal material the one with the more valuable pieces
+		const int whiteStrength = GetStrength(sides[White]);
+		const int blackStrength = GetStrength(sides[Black]);
+		if (blackStrength > whiteStrength || (blackStrength == whiteStrength && sides[Black] > sides[White]))
+			std::swap(sides[White], sides[Black]);
+
+		material.Count = 0;
+		material.Pieces[material.Count++] = WhiteKing;
+		material.Pieces[material.Count++] = BlackKing;
+		for (int color = White; color < ColorCount; color++)
+			for (const PieceType type : sides[color])
+				material.Pieces[material.Count++] = MakePiece(static_cast<Color>(color), type);
+		return true;
+	}
+
+	std::string Material::GetName() const
+	{
+		std::string name;
+		for (int color = White; color < ColorCount; color++) {
+			name += 'K';
+			for (int i = 2; i < Count; i++)
+				if (ColorOf(Pieces[i]) == color)
+					name += PieceLetters[TypeOf(Pieces[i])];
+		}
+		return name;
+	}
+
+	bool Material::HasPawns() const
+	{
+		for (int i = 2; i < Count; i++)
+			if (TypeOf(Pieces[i]) == Pawn)
+				return true;
+		return false;
+	}
+
+	std::uint64_t Material::GetPositionCount() const
+	{
+		return static_cast<std::uint64_t>(HasPawns() ? 32 : 10) << 6 * (Count - 1);
+	}
+
+	std::uint64_t Material::GetKey() const
+	{
+		std::uint64_t key = 0;
+		for (int i = 0; i < Count; i++)
+			key += std::uint64_t(1) << 4 * Pieces[i];
+		return key;
+	}
+
+	std::uint64_t GetMaterialKey(const Board& board, bool flipped)
+	{
+		std::uint64_t key = 0;
+		for (int color = White; color < ColorCount; color++)
+			for (int type = Pawn; type < PieceTypeCount; type++) {
+				const int count = PopCount(board.GetPieces(static_cast<Color>(color), static_cast<PieceType>(type)));
+				const Piece piece = MakePiece(static_cast<Color>(flipped ? color ^ Black : color), static_cast<PieceType>(type));
+				key += static_cast<std::uint64_t>(count) << 4 * piece;
+			}
+		return key;
+	}
+
+	std::uint64_t GetIndex(const Material& material, const Square* squares)
+	{
+		//The squares are turned the way that puts the white king into its part of the board
+		const Square king = squares[0];
+		int flip = FileOf(king) > 3 ? 7 : 0;
+		bool transpose = false;
+		std::uint64_t index;
+		if (material.HasPawns())
+			index = RankOf(king) * 4 + (FileOf(king) ^ flip);
+		else {
+			if (RankOf(king) > 3)
+				flip ^= 56;
+			const auto turned = static_cast<Square>(king ^ flip);
+			transpose = RankOf(turned) > FileOf(turned);
+			//With the king on the diagonal, the first piece off it decides, so every position has one number
+			for (int i = 1; i < material.Count && RankOf(turned) == FileOf(turned); i++) {
+				const auto square = static_cast<Square>(squares[i] ^ flip);
+				if (RankOf(square) != FileOf(square)) {
+					transpose = RankOf(square) > FileOf(square);
+					break;
+				}
+			}
+			index = Triangle.Index[transpose ? Transpose(turned) : turned];
+		}
+		for (int i = 1; i < material.Count; i++) {
+			const auto square = static_cast<Square>(squares[i] ^ flip);
+			index = index << 6 | (transpose ? Transpose(square) : square);
+		}
+		return index;
+	}
+
+	void GetSquares(const Material& material, std::uint64_t index, Square* squares)
+	{
+		for (int i = material.Count - 1; i >= 1; i--) {
+			squares[i] = static_cast<Square>(index & 63);
+			index >>= 6;
+		}
+		squares[0] = material.HasPawns() ? MakeSquare(static_cast<int>(index % 4), static_cast<int>(index / 4))
+										 : TriangleSquares[index];
+	}
+
+	void FindSquares(const Board& board, const Material& material, bool flipped, Square* squares)
+	{
+		//Pieces of the same kind take their squares in turns
+		Bitboard taken = 0;
+		for (int i = 0; i < material.Count; i++) {
+			const Piece piece = material.Pieces[i];
+			const Color color = flipped ? ~ColorOf(piece) : ColorOf(piece);
+			const Square square = LowestSquare(board.GetPieces(color, TypeOf(piece)) & ~taken);
+			taken |= SquareBit(square);
+			squares[i] = flipped ? static_cast<Square>(square ^ 56) : square;
+		}
+	}
+
+	/**
+	* @brief Maps a tablebase file and indexes its endings
+	*
+	* @param filePath - Path to the tablebase file
+	* @return bool - Whether the file could be mapped or not
+	*/
+	bool Tables::Load(const std::string& filePath)
+	{
+		Close();
+		if (!File.Open(filePath))
+			return false;
+
+		const auto* header = reinterpret_cast<const TablebaseFileHeader*>(File.GetData());
+		if (File.GetSize() < sizeof(TablebaseFileHeader) || std::memcmp(header->Magic, TablebaseMagic, 4) != 0) {
+			std::cout << filePath << " is not a tablebase file\n";
+			File.Close();
+			return false;
+		}
+		if (header->Version != Version ||
+			File.GetSize() < sizeof(TablebaseFileHeader) + std::uint64_t(header->TableCount) * sizeof(TablebaseFileTable)) {
+			std::cout << filePath << " has an unsupported tablebase version or is truncated\n";
+			File.Close();
+			return false;
+		}
+
+		const auto* tables = reinterpret_cast<const TablebaseFileTable*>(File.GetData() + sizeof(TablebaseFileHeader));
+		for (std::uint32_t i = 0; i < header->TableCount; i++) {
+			const TablebaseFileTable& table = tables[i];
+			Ending ending;
+			const std::string name(table.Name, std::find(table.Name, table.Name + sizeof(table.Name), '\0'));
+			if (!Material::Parse(name, ending.Pieces) || ending.Pieces.GetName() != name ||
+				table.PositionCount != ending.Pieces.GetPositionCount() ||
+				table.Offset + 2 * table.PositionCount > File.GetSize()) {
+				std::cout << filePath << " has a broken table " << name << "\n";
+				Close();
+				return false;
+			}
+			ending.Values[White] = File.GetData() + table.Offset;
+			ending.Values[Black] = ending.Values[White] + table.PositionCount;
+			EndingIndex[ending.Pieces.GetKey()] = Endings.size();
+			LargestEnding = std::max(LargestEnding, ending.Pieces.Count);
+			Endings.push_back(ending);
+		}
+		return true;
+	}
+
+	void Tables::Close()
+	{
+		File.Close();
+		Endings.clear();
+		EndingIndex.clear();
+		LargestEnding = 0;
+	}
+
+	bool Tables::Probe(const Position& position, ProbeResult& result) const
+	{
+		const Board& board = position.GetBoard();
+		if (PopCount(board.GetOccupied()) > LargestEnding || position.GetCastlingRights() != 0 ||
+			position.GetEnPassantSquare() != NoSquare)
+			return false;
+
+		bool flipped = false;
+		auto found = EndingIndex.find(GetMaterialKey(board, false));
+		if (found == EndingIndex.end()) {
+			flipped = true;
+			found = EndingIndex.find(GetMaterialKey(board, true));
+			if (found == EndingIndex.end())
+				return false;
+		}
+		const Ending& ending = Endings[found->second];
+		Square squares[MaxPieces];
+		FindSquares(board, ending.Pieces, flipped, squares);
+		const Color side = flipped ? ~position.GetSideToMove() : position.GetSideToMove();
+		const std::uint8_t value = ending.Values[side][GetIndex(ending.Pieces, squares)];
+		if (value == NoPositionValue)
+			return false;
+		result = DecodeValue(value);
+		return true;
+	}
+
+	bool Tables::Write(const std::string& filePath, const std::vector<TableData>& tables)
+	{
+		std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+		if (!stream) {
+			std::cout << "Could not open " << filePath << " for writing\n";
+			return false;
+		}
+
+		TablebaseFileHeader header = {};
+		std::memcpy(header.Magic, TablebaseMagic, 4);
+		header.Version = Version;
+		header.TableCount = static_cast<std::uint32_t>(tables.size());
+		std::vector<TablebaseFileTable> entries(tables.size());
+		std::size_t offset = AlignUp(sizeof(TablebaseFileHeader) + tables.size() * sizeof(TablebaseFileTable));
+		for (std::size_t i = 0; i < tables.size(); i++) {
+			const TableData& table = tables[i];
+			const std::uint64_t count = table.Pieces.GetPositionCount();
+			if (table.Values[White].size() != count || table.Values[Black].size() != count) {
+				std::cout << "The table " << table.Pieces.GetName() << " does not have " << count << " positions\n";
+				return false;
+			}
+			entries[i] = {};
+			std::strncpy(entries[i].Name, table.Pieces.GetName().c_str(), sizeof(entries[i].Name) - 1);
+			entries[i].Offset = offset;
+			entries[i].PositionCount = count;
+			header.MaxPieces = std::max<std::uint32_t>(header.MaxPieces, table.Pieces.Count);
+			offset = AlignUp(offset + 2 * count);
+		}
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(TablebaseFileTable)));
+
+		//Zeros up to the start of every table
+		const char padding[Alignment] = {};
+		std::size_t written = sizeof(TablebaseFileHeader) + entries.size() * sizeof(TablebaseFileTable);
+		for (std::size_t i = 0; i < tables.size(); i++) {
+			stream.write(padding, static_cast<std::streamsize>(entries[i].Offset - written));
+			for (const auto& values : tables[i].Values)
+				stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size()));
+			written = entries[i].Offset + 2 * entries[i].PositionCount;
+		}
+		if (!stream) {
+			std::cout << "Could not write " << filePath << "\n";
+			return false;
+		}
+		return true;
+	}
+}
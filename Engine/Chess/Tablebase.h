@@ -0,0 +1,196 @@
+/**
+* @file Tablebase.h
+*
+* @brief Endgame tablebases: the outcome and the distance to mate of every position
+*        of endings with a few pieces, for perfect play once the board has come down
+*        to them. An ending is named by its pieces, the kings first, like KQK or KRKP,
+*        and is stored with the stronger side as white; positions with the colors the
+*        other way around are looked up flipped.
+*
+*        The positions of an ending are numbered by the squares of its pieces, the
+*        white king first. The board is turned so the white king stands in the
+*        a1-d1-d4 triangle, which leaves 10 of its squares out of 64, or only mirrored
+*        so it stands on files a to d when there are pawns, which leaves 32. A king on
+*        the a1-d4 diagonal leaves the board turned so the first other piece off the
+*        diagonal stands below it. The other pieces take 6 bits of the number each.
+*        Every position has one byte for either side to move:
+*          0        draw
+*          1 + n    mate in n plies, won by the side to move when n is odd and lost when it is even
+*          255      no position, pieces on the same square, the side not to move in check
+*                   or a number the turning never gives
+*        Castling and en passant are not part of the positions.
+*
+* File layout (little endian):
+*   TablebaseFileHeader
+*   a TablebaseFileTable for every ending
+*   the bytes of every ending, the positions with white to move followed by the ones
+*   with black to move, starting on a Tables::Alignment boundary
+* The file is memory mapped and the bytes are looked up in place.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef TABLEBASE_H_
+#define TABLEBASE_H_
+
+#include "Position.h"
+
+#include <MappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Tablebase {
+	//Pieces of the largest endings, the kings included
+	const int MaxPieces = 4;
+
+	const std::uint8_t DrawValue = 0;
+	const std::uint8_t NoPositionValue = 255;
+	//Longest mate a byte holds
+	const int MaxPlies = 253;
+
+	//Outcome of a position for the side to move
+	enum Outcome { Loss = -1, Draw = 0, Win = 1 };
+
+	struct ProbeResult {
+		Outcome Result;
+		int Plies;				//Plies to the mate with best play of both sides, 0 for a draw
+	};
+
+	//The pieces of an ending and how its positions are numbered
+	struct Material {
+		int Count = 0;
+		//The white king, the black king, then the other white pieces and the other black
+		//pieces, the most valuable first
+		Piece Pieces[MaxPieces];
+
+		/**
+		* @brief Reads an ending from its name, like KQK, KBNK or KRKP. The pieces
+		*        are put in order and the stronger side is made white.
+		*
+		* @param name - Name of the ending, the pieces of one side may be split from the other by a v
+		* @param material - Set to the ending
+		* @return bool - Whether the name was a valid ending of up to MaxPieces pieces
+		*/
+		static bool Parse(const std::string& name, Material& material);
+		std::string GetName() const;
+
+		bool HasPawns() const;
+		//Positions for either side to move, some of which may not be positions
+		std::uint64_t GetPositionCount() const;
+		//Count of every piece, the same as GetMaterialKey() of a board with the pieces
+		std::uint64_t GetKey() const;
+	};
+
+	//Count of every piece on the board, in 4 bits each, with the colors swapped when flipped
+	std::uint64_t GetMaterialKey(const Board& board, bool flipped);
+
+	/**
+	* @brief Numbers a position of an ending
+	*
+	* @param material - The ending
+	* @param squares - Squares of the pieces, in the order of the pieces of the ending
+	* @return std::uint64_t - Number of the position, below GetPositionCount()
+	*/
+	std::uint64_t GetIndex(const Material& material, const Square* squares);
+	//Squares of the pieces of the position with the number, in the order of the pieces of the ending
+	void GetSquares(const Material& material, std::uint64_t index, Square* squares);
+	/**
+	* @brief Finds the squares of the pieces of an ending on a board
+	*
+	* @param board - Board with the pieces of the ending, or of the ending with the colors swapped
+	* @param material - The ending
+	* @param flipped - Whether the colors on the board are swapped, the board is then read upside down
+	* @param squares - Set to the squares of the pieces, in the order of the pieces of the ending
+	*/
+	void FindSquares(const Board& board, const Material& material, bool flipped, Square* squares);
+
+	//The bytes of an ending in memory, to write into a tablebase file
+	struct TableData {
+		Material Pieces;
+		std::vector<std::uint8_t> Values[ColorCount];	//GetPositionCount() for either side to move
+	};
+
+	struct TablebaseFileHeader {
+		char Magic[4];					// "CHTB"
+		std::uint32_t Version;
+		std::uint32_t TableCount;
+		std::uint32_t MaxPieces;
+		std::uint32_t Reserved[12];
+	};
+	static_assert(sizeof(TablebaseFileHeader) == 64, "TablebaseFileHeader must not be padded");
+
+	struct TablebaseFileTable {
+		char Name[16];					// null terminated, like KQKR
+		std::uint64_t Offset;			//Of the bytes with white to move from the start of the file
+		std::uint64_t PositionCount;	//For either side to move
+		std::uint32_t Reserved[8];
+	};
+	static_assert(sizeof(TablebaseFileTable) == 64, "TablebaseFileTable must not be padded");
+
+	class Tables
+	{
+	public:
+		static const std::uint32_t Version = 1;
+		static const std::size_t Alignment = 64;
+
+		Tables() = default;
+		~Tables() = default;
+
+		Tables(const Tables&) = delete;
+		Tables& operator=(const Tables&) = delete;
+
+		//Maps a tablebase file, the bytes stay mapped until Close()
+		bool Load(const std::string& filePath);
+		void Close();
+		inline bool IsLoaded() const { return File.IsOpen(); }
+		inline int GetTableCount() const { return static_cast<int>(Endings.size()); }
+		//Pieces of the largest ending of the file
+		inline int GetMaxPieces() const { return LargestEnding; }
+
+		/**
+		* @brief Looks up the outcome of a position, with a few operations and one read
+		*        of the mapped file
+		*
+		* @param position - Position to look up
+		* @param result - Set to the outcome for the side to move and the plies to the mate
+		* @return bool - Whether the file has the ending of the position. Positions with
+		*                castling rights or an en passant square are never found
+		*/
+		bool Probe(const Position& position, ProbeResult& result) const;
+
+		/**
+		* @brief Writes endings into a tablebase file
+		*
+		* @param filePath - Path to the file to write
+		* @param tables - The endings, every one of them once
+		* @return bool - Whether the file could be written or not
+		*/
+		static bool Write(const std::string& filePath, const std::vector<TableData>& tables);
+
+	private:
+		struct Ending {
+			Material Pieces;
+			const std::uint8_t* Values[ColorCount];
+		};
+
+		MappedFile File;
+		std::vector<Ending> Endings;
+		//Index into the endings by the material key of the ending
+		std::unordered_map<std::uint64_t, std::size_t> EndingIndex;
+		int LargestEnding = 0;
+	};
+
+	//Outcome stored in a byte, the byte has to be of a position
+	inline ProbeResult DecodeValue(std::uint8_t value)
+	{
+		if (value == DrawValue)
+			return { Draw, 0 };
+		const int plies = value - 1;
+		return { plies % 2 != 0 ? Win : Loss, plies };
+	}
+}
+
+#endif // TABLEBASE_H_
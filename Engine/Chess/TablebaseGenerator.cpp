@@ -0,0 +1,425 @@
+/**
+* @file TablebaseGenerator.cpp
+*
+* @brief Retrograde analysis of endings, split over threads
+*
+* @author Aleksander Solhaug
+*/
+
+#include "TablebaseGenerator.h"
+#include "Attacks.h"
+#include "MoveGen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+namespace Tablebase {
+	namespace {
+		//While an ending is generated, a position holds the plies to its mate once it is resolved
+		const std::uint8_t Unresolved = 255;
+		const std::uint8_t Illegal = 254;
+		//Plies a position is resolved at from the start, by endings generated before
+		const std::uint8_t NoPending = 255;
+
+		//Positions a thread takes at once, small enough for the threads to finish together
+		const std::uint64_t ChunkSize = 1 << 14;
+
+		const char PieceLetters[PieceTypeCount + 1] = "PNBRQK";
+
+		/**
+		* @brief Calls the function for chunks of the numbers below the count, every chunk
+		*        once, on the given threads of which the calling thread is one
+		*/
+		template <typename Function>
+		void ForEachChunk(std::uint64_t count, int threadCount, const Function& function)
+		{
+			std::atomic<std::uint64_t> nextChunk(0);
+			const auto work = [&]() {
+				for (std::uint64_t begin = nextChunk.fetch_add(ChunkSize); begin < count; begin = nextChunk.fetch_add(ChunkSize))
+					function(begin, std::min(count, begin + ChunkSize));
+			};
+			std::vector<std::thread> threads;
+			for (int t = 1; t < threadCount; t++)
+				threads.emplace_back(work);
+			work();
+			for (std::thread& thread : threads)
+				thread.join();
+		}
+
+		//Whether a piece of the color attacks the square, with the pieces on the squares
+		bool IsAttacked(const Material& material, const Square* squares, Square target, Color by)
+		{
+			Bitboard occupied = 0;
+			for (int i = 0; i < material.Count; i++)
+				occupied |= SquareBit(squares[i]);
+			const Bitboard targetBit = SquareBit(target);
+			for (int i = 0; i < material.Count; i++) {
+				if (ColorOf(material.Pieces[i]) != by)
+					continue;
+				const Square square = squares[i];
+				Bitboard attacks = 0;
+				switch (TypeOf(material.Pieces[i])) {
+				case Pawn: attacks = Attacks::Pawn(by, square); break;
+				case Knight: attacks = Attacks::Knight(square); break;
+				case Bishop: attacks = Attacks::Bishop(square, occupied); break;
+				case Rook: attacks = Attacks::Rook(square, occupied); break;
+				case Queen: attacks = Attacks::Queen(square, occupied); break;
+				default: attacks = Attacks::King(square); break;
+				}
+				if (attacks & targetBit)
+					return true;
+			}
+			return false;
+		}
+
+		//Whether the pieces on the squares are a position with the side to move: every piece on a
+		//square of its own, no pawn on the first or last rank and the side not to move not in check
+		bool IsLegal(const Material& material, const Square* squares, Color sideToMove)
+		{
+			Bitboard occupied = 0;
+			for (int i = 0; i < material.Count; i++) {
+				if (occupied & SquareBit(squares[i]))
+					return false;
+				occupied |= SquareBit(squares[i]);
+				if (TypeOf(material.Pieces[i]) == Pawn && (RankOf(squares[i]) == 0 || RankOf(squares[i]) == 7))
+					return false;
+			}
+			//The kings are the first pieces, in the order of their colors
+			return !IsAttacked(material, squares, squares[~sideToMove], sideToMove);
+		}
+
+		//The ending of the pieces, ordered and with the stronger side white
+		Material MakeMaterial(const std::vector<Piece>& pieces)
+		{
+			std::string name;
+			for (int color = White; color < ColorCount; color++) {
+				name += 'K';
+				for (const Piece piece : pieces)
+					if (ColorOf(piece) == color && TypeOf(piece) != King)
+						name += PieceLetters[TypeOf(piece)];
+			}
+			Material material;
+			Material::Parse(name, material);
+			return material;
+		}
+	}
+
+	struct Generator::Work {
+		Work(const Generator& owner, const Material& material);
+
+		//Resolves the mates and the positions left to other endings by all their moves
+		void Initialize(std::uint64_t begin, std::uint64_t end);
+		//Resolves the positions of the pass with the plies, from the positions of the pass before
+		void Resolve(std::uint64_t begin, std::uint64_t end, int plies);
+		//Plies to the mate of a position all of whose moves are resolved as won by the other side
+		//before the pass, 0 when one of them is not
+		int GetLossPlies(const Square* squares, Color side, int plies) const;
+
+		void SetUp(const Square* squares, Color side, Position& position) const;
+		//Number of the position the move on the board leads to, in this ending
+		inline std::uint64_t GetChildIndex(const Position& child) const
+		{
+			Square squares[MaxPieces];
+			FindSquares(child.GetBoard(), Pieces, false, squares);
+			return GetIndex(Pieces, squares);
+		}
+		inline void AddPending(int plies)
+		{
+			int last = LastPending.load(std::memory_order_relaxed);
+			while (plies > last && !LastPending.compare_exchange_weak(last, plies, std::memory_order_relaxed));
+		}
+
+		const Generator& Owner;
+		const Material Pieces;
+		const std::uint64_t Count;
+		std::unique_ptr<std::atomic<std::uint8_t>[]> Values[ColorCount];
+		std::unique_ptr<std::atomic<std::uint8_t>[]> Pending[ColorCount];
+		std::atomic<std::uint64_t> Resolved;
+		std::atomic<int> LastPending;		//Latest pass a position is pending for
+	};
+
+	Generator::Work::Work(const Generator& owner, const Material& material)
+		: Owner(owner), Pieces(material), Count(material.GetPositionCount()), Resolved(0), LastPending(0)
+	{
+		for (int color = White; color < ColorCount; color++) {
+			Values[color].reset(new std::atomic<std::uint8_t>[Count]);
+			Pending[color].reset(new std::atomic<std::uint8_t>[Count]);
+		}
+	}
+
+	void Generator::Work::SetUp(const Square* squares, Color side, Position& position) const
+	{
+		Board board;
+		for (int i = 0; i < Pieces.Count; i++)
+			board.PutPiece(Pieces.Pieces[i], squares[i]);
+		position.SetBoard(board, side);
+	}
+
+	void Generator::Work::Initialize(std::uint64_t begin, std::uint64_t end)
+	{
+		std::uint64_t resolved = 0;
+		Position position;
+		MoveList moves;
+		Square squares[MaxPieces];
+		for (std::uint64_t index = begin; index < end; index++) {
+			GetSquares(Pieces, index, squares);
+			for (int color = White; color < ColorCount; color++) {
+				const auto side = static_cast<Color>(color);
+				Pending[side][index].store(NoPending, std::memory_order_relaxed);
+				if (!IsLegal(Pieces, squares, side) || GetIndex(Pieces, squares) != index) {
+					Values[side][index].store(Illegal, std::memory_order_relaxed);
+					continue;
+				}
+				SetUp(squares, side, position);
+				moves.Count = 0;
+				GenerateLegalMoves(position, moves);
+				//Stalemates are never resolved, like every other draw
+				const bool mated = moves.GetSize() == 0 && position.IsInCheck();
+				Values[side][index].store(mated ? 0 : Unresolved, std::memory_order_relaxed);
+				resolved += mated;
+				if (moves.GetSize() == 0)
+					continue;
+
+				//Captures and promotions leave the ending, the endings they lead to are known
+				int winPlies = Unresolved;
+				int lossPlies = 0;
+				bool allLeave = true, drawn = false;
+				for (const Move move : moves) {
+					MoveUndo undo;
+					position.MakeMove(move, undo);
+					if (undo.Captured != NoPiece || move.GetKind() == Promotion) {
+						ProbeResult result = { Draw, 0 };
+						Owner.ProbeGenerated(position, result);
+						if (result.Result == Loss)
+							winPlies = std::min(winPlies, result.Plies + 1);
+						else if (result.Result == Win)
+							lossPlies = std::max(lossPlies, result.Plies + 1);
+						else drawn = true;
+					}
+					else allLeave = false;
+					position.UnmakeMove(move, undo);
+				}
+				const int pending = winPlies != Unresolved ? winPlies : allLeave && !drawn ? lossPlies : NoPending;
+				if (pending <= MaxPlies) {
+					Pending[side][index].store(static_cast<std::uint8_t>(pending), std::memory_order_relaxed);
+					AddPending(pending);
+				}
+			}
+		}
+		Resolved += resolved;
+	}
+
+	void Generator::Work::Resolve(std::uint64_t begin, std::uint64_t end, int plies)
+	{
+		std::uint64_t resolved = 0;
+		Square squares[MaxPieces];
+		for (std::uint64_t index = begin; index < end; index++)
+			for (int color = White; color < ColorCount; color++) {
+				const auto side = static_cast<Color>(color);
+				const std::uint8_t value = Values[side][index].load(std::memory_order_relaxed);
+				if (value == Unresolved && Pending[side][index].load(std::memory_order_relaxed) == plies) {
+					Values[side][index].store(static_cast<std::uint8_t>(plies), std::memory_order_relaxed);
+					resolved++;
+					continue;
+				}
+				if (value != plies - 1)
+					continue;
+
+				//Every quiet move of the other side that leads to the position is taken back
+				const Color mover = ~side;
+				const bool lost = value % 2 == 0;
+				GetSquares(Pieces, index, squares);
+				Bitboard occupied = 0;
+				for (int i = 0; i < Pieces.Count; i++)
+					occupied |= SquareBit(squares[i]);
+				for (int i = 0; i < Pieces.Count; i++) {
+					const Piece piece = Pieces.Pieces[i];
+					if (ColorOf(piece) != mover)
+						continue;
+					const Square to = squares[i];
+					Bitboard origins = 0;
+					switch (TypeOf(piece)) {
+					case Pawn: {
+						//Pawns step back towards their own side, by two squares from the fourth rank
+						const int back = mover == White ? -8 : 8;
+						const int rank = mover == White ? RankOf(to) : 7 - RankOf(to);
+						const auto single = static_cast<Square>(to + back);
+						if (rank >= 2 && !(occupied & SquareBit(single))) {
+							origins |= SquareBit(single);
+							const auto twice = static_cast<Square>(to + 2 * back);
+							if (rank == 3 && !(occupied & SquareBit(twice)))
+								origins |= SquareBit(twice);
+						}
+						break;
+					}
+					case Knight: origins = Attacks::Knight(to); break;
+					case Bishop: origins = Attacks::Bishop(to, occupied); break;
+					case Rook: origins = Attacks::Rook(to, occupied); break;
+					case Queen: origins = Attacks::Queen(to, occupied); break;
+					default: origins = Attacks::King(to); break;
+					}
+					origins &= ~occupied;
+
+					while (origins) {
+						squares[i] = PopLowestSquare(origins);
+						//The side to move of the position could not have been in check before the move
+						if (IsAttacked(Pieces, squares, squares[side], mover))
+							continue;
+						const std::uint64_t before = GetIndex(Pieces, squares);
+						std::atomic<std::uint8_t>& target = Values[mover][before];
+						std::uint8_t expected = Unresolved;
+						if (target.load(std::memory_order_relaxed) != Unresolved)
+							continue;
+						if (lost) {
+							resolved += target.compare_exchange_strong(expected, static_cast<std::uint8_t>(plies), std::memory_order_relaxed);
+							continue;
+						}
+						const int lossPlies = GetLossPlies(squares, mover, plies);
+						if (lossPlies == plies)
+							resolved += target.compare_exchange_strong(expected, static_cast<std::uint8_t>(plies), std::memory_order_relaxed);
+						else if (lossPlies > plies && lossPlies <= MaxPlies) {
+							//A longer mate after a capture or a promotion decides, it is resolved in its own pass
+							Pending[mover][before].store(static_cast<std::uint8_t>(lossPlies), std::memory_order_relaxed);
+							AddPending(lossPlies);
+						}
+					}
+					squares[i] = to;
+				}
+			}
+		Resolved += resolved;
+	}
+
+	int Generator::Work::GetLossPlies(const Square* squares, Color side, int plies) const
+	{
+		Position position;
+		SetUp(squares, side, position);
+		MoveList moves;
+		GenerateLegalMoves(position, moves);
+		int lossPlies = 0;
+		for (const Move move : moves) {
+			MoveUndo undo;
+			position.MakeMove(move, undo);
+			int childPlies = -1;
+			if (undo.Captured != NoPiece || move.GetKind() == Promotion) {
+				ProbeResult result = { Draw, 0 };
+				Owner.ProbeGenerated(position, result);
+				if (result.Result == Win)
+					childPlies = result.Plies;
+			}
+			else {
+				//Positions resolved in this pass are left for the next one
+				const std::uint8_t value = Values[~side][GetChildIndex(position)].load(std::memory_order_relaxed);
+				if (value < plies && value % 2 != 0)
+					childPlies = value;
+			}
+			position.UnmakeMove(move, undo);
+			if (childPlies < 0)
+				return 0;
+			lossPlies = std::max(lossPlies, childPlies + 1);
+		}
+		return lossPlies;
+	}
+
+	Generator::Generator(int threadCount)
+		: ThreadCount(threadCount > 0 ? threadCount : std::max(1, static_cast<int>(std::thread::hardware_concurrency())))
+	{
+	}
+
+	bool Generator::Generate(const std::string& name)
+	{
+		Material material;
+		if (!Material::Parse(name, material))
+			return false;
+		GenerateEnding(material);
+		return true;
+	}
+
+	void Generator::GenerateEnding(const Material& material)
+	{
+		if (EndingIndex.count(material.GetKey()))
+			return;
+
+		//The endings every capture and every promotion turns this one into come first
+		const std::vector<Piece> pieces(material.Pieces, material.Pieces + material.Count);
+		for (int i = 2; i < material.Count; i++) {
+			std::vector<Piece> captured = pieces;
+			captured.erase(captured.begin() + i);
+			GenerateEnding(MakeMaterial(captured));
+			if (TypeOf(pieces[i]) != Pawn)
+				continue;
+			for (const PieceType promotion : { Queen, Rook, Bishop, Knight }) {
+				std::vector<Piece> promoted = pieces;
+				promoted[i] = MakePiece(ColorOf(pieces[i]), promotion);
+				GenerateEnding(MakeMaterial(promoted));
+			}
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		Work work(*this, material);
+		ForEachChunk(work.Count, ThreadCount, [&](std::uint64_t begin, std::uint64_t end) { work.Initialize(begin, end); });
+		int passes = 0;
+		for (int plies = 1; plies <= MaxPlies; plies++) {
+			work.Resolved = 0;
+			ForEachChunk(work.Count, ThreadCount, [&](std::uint64_t begin, std::uint64_t end) { work.Resolve(begin, end, plies); });
+			passes = plies;
+			if (work.Resolved == 0 && plies >= work.LastPending)
+				break;
+		}
+
+		//The bytes of the file, the positions never resolved are draws
+		TableData table;
+		table.Pieces = material;
+		GenerationStats stats;
+		stats.Passes = passes;
+		for (int color = White; color < ColorCount; color++) {
+			std::vector<std::uint8_t>& values = table.Values[color];
+			values.resize(work.Count);
+			for (std::uint64_t index = 0; index < work.Count; index++) {
+				const std::uint8_t value = work.Values[color][index].load(std::memory_order_relaxed);
+				if (value == Illegal) {
+					values[index] = NoPositionValue;
+					continue;
+				}
+				stats.Positions++;
+				if (value == Unresolved) {
+					values[index] = DrawValue;
+					stats.Draws++;
+					continue;
+				}
+				values[index] = static_cast<std::uint8_t>(value + 1);
+				(value % 2 != 0 ? stats.Wins : stats.Losses)++;
+				stats.LongestMate = std::max(stats.LongestMate, static_cast<int>(value));
+			}
+		}
+		stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		EndingIndex[material.GetKey()] = Endings.size();
+		Endings.push_back(std::move(table));
+		Stats.push_back(stats);
+	}
+
+	bool Generator::ProbeGenerated(const Position& position, ProbeResult& result) const
+	{
+		const Board& board = position.GetBoard();
+		bool flipped = false;
+		auto found = EndingIndex.find(GetMaterialKey(board, false));
+		if (found == EndingIndex.end()) {
+			flipped = true;
+			found = EndingIndex.find(GetMaterialKey(board, true));
+			if (found == EndingIndex.end())
+				return false;
+		}
+		const TableData& table = Endings[found->second];
+		Square squares[MaxPieces];
+		FindSquares(board, table.Pieces, flipped, squares);
+		const Color side = flipped ? ~position.GetSideToMove() : position.GetSideToMove();
+		const std::uint8_t value = table.Values[side][GetIndex(table.Pieces, squares)];
+		if (value == NoPositionValue)
+			return false;
+		result = DecodeValue(value);
+		return true;
+	}
+}
@@ -0,0 +1,74 @@
+/**
+* @file TablebaseGenerator.h
+*
+* @brief Generates endgame tablebases by retrograde analysis. The mates of an ending,
+*        and the positions a capture or a promotion wins or loses from by the endings
+*        generated before it, are found first. Then one pass per ply goes back from
+*        the positions resolved in the pass before: a position one move before a lost
+*        one is won, and a position one move before a won one is lost once all of its
+*        moves are known to lose. The positions never resolved are draws. Every pass
+*        is split over the threads in chunks of positions.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef TABLEBASEGENERATOR_H_
+#define TABLEBASEGENERATOR_H_
+
+#include "Tablebase.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Tablebase {
+	//How the positions of a generated ending came out, for either side to move together
+	struct GenerationStats {
+		std::uint64_t Positions = 0;		//Legal positions
+		std::uint64_t Wins = 0;				//For the side to move
+		std::uint64_t Draws = 0;
+		std::uint64_t Losses = 0;
+		int LongestMate = 0;				//Plies
+		int Passes = 0;
+		double Seconds = 0.0;
+	};
+
+	class Generator
+	{
+	public:
+		//Threads every pass is split over, 0 for all cores
+		explicit Generator(int threadCount = 0);
+		~Generator() = default;
+
+		/**
+		* @brief Generates an ending, after every ending it turns into by captures and
+		*        promotions that is not generated yet. Every ending is generated once.
+		*
+		* @param name - Name of the ending, like KRKP
+		* @return bool - Whether the name was a valid ending
+		*/
+		bool Generate(const std::string& name);
+
+		//The generated endings, every one after the endings it turns into
+		inline const std::vector<TableData>& GetTables() const { return Endings; }
+		inline const std::vector<GenerationStats>& GetStats() const { return Stats; }
+		inline int GetThreadCount() const { return ThreadCount; }
+
+	private:
+		//The state of the ending being generated, defined with the generator
+		struct Work;
+
+		void GenerateEnding(const Material& material);
+		//Looks up a position of an ending generated before, without castling and en passant
+		bool ProbeGenerated(const Position& position, ProbeResult& result) const;
+
+		int ThreadCount;
+		std::vector<TableData> Endings;
+		std::vector<GenerationStats> Stats;
+		//Index into the endings by the material key of the ending
+		std::unordered_map<std::uint64_t, std::size_t> EndingIndex;
+	};
+}
+
+#endif // TABLEBASEGENERATOR_H_
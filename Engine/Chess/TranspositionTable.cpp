@@ -0,0 +1,195 @@
+/**
+* @file TranspositionTable.cpp
+*
+* @brief The shared table of searched positions
+*
+* @author Aleksander Solhaug
+*/
+
+#include "TranspositionTable.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace {
+	const std::size_t HugePageSize = 2 * 1024 * 1024;
+
+	//The data packs the move into bits 0-15, the score into 16-31, the depth into 32-39,
+	//the bound into 40-41 and the generation of the search into 42-47
+	inline std::uint64_t PackData(Move move, int score, int depth, Bound bound, int generation)
+	{
+		return static_cast<std::uint64_t>(move.GetData()) |
+			   static_cast<std::uint64_t>(static_cast<std::uint16_t>(score)) << 16 |
+			   static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth)) << 32 |
+			   static_cast<std::uint64_t>(bound) << 40 |
+			   static_cast<std::uint64_t>(generation) << 42;
+	}
+
+	inline Move GetMove(std::uint64_t data) { return Move::FromData(static_cast<std::uint16_t>(data)); }
+	inline int GetDepth(std::uint64_t data) { return static_cast<int>(data >> 32 & 0xFF); }
+	inline int GetGeneration(std::uint64_t data) { return static_cast<int>(data >> 42 & 63); }
+
+	/**
+	* @brief Allocates memory aligned to cache lines, or to huge pages when they are asked for
+	*
+	* @param size - Bytes to allocate, rounded up to the alignment
+	* @param hugePages - Whether the memory should be backed by huge pages
+	* @param allocatedSize - Set to the rounded up size
+	* @return void* - The memory, nullptr when it could not be allocated
+	*/
+	void* AllocateAligned(std::size_t size, bool hugePages, std::size_t& allocatedSize)
+	{
+#ifdef _MSC_VER
+		//Large pages on Windows need a privilege the process rarely has, so the table uses normal pages
+		(void)hugePages;
+		allocatedSize = size;
+		return _aligned_malloc(size, TranspositionTable::CacheLineSize);
+#else
+		const std::size_t alignment = hugePages ? HugePageSize : TranspositionTable::CacheLineSize;
+		if (size > SIZE_MAX - alignment)
+			return nullptr;
+		allocatedSize = (size + alignment - 1) / alignment * alignment;
+		void* memory = std::aligned_alloc(alignment, allocatedSize);
+#ifdef __linux__
+		//Transparent huge pages back the aligned range once the kernel is told it is worth it
+		if (memory && hugePages)
+			madvise(memory, allocatedSize, MADV_HUGEPAGE);
+#endif
+		return memory;
+#endif
+	}
+
+	void FreeAligned(void* memory)
+	{
+#ifdef _MSC_VER
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+}
+
+TranspositionTable::TranspositionTable()
+	: Buckets(nullptr), BucketCount(0), AllocatedSize(0), Generation(0)
+{
+	if (!Resize(16))
+		throw std::bad_alloc();
+}
+
+TranspositionTable::~TranspositionTable()
+{
+	Free();
+}
+
+bool TranspositionTable::Resize(std::size_t megabytes, bool hugePages)
+{
+	//The new table is allocated before the old one is freed, so a failed allocation leaves the old table in use
+	void* memory = nullptr;
+	std::size_t bucketCount = 0, allocatedSize = 0;
+	if (megabytes <= SIZE_MAX / (1024 * 1024)) {
+		bucketCount = std::max<std::size_t>(megabytes * 1024 * 1024 / sizeof(Bucket), 1);
+		memory = AllocateAligned(bucketCount * sizeof(Bucket), hugePages, allocatedSize);
+	}
+	if (memory == nullptr) {
+		std::cout << "Could not allocate a transposition table of " << megabytes << " MB, keeping the one of "
+				  << GetSize() / (1024 * 1024) << " MB\n";
+		return false;
+	}
+	Free();
+	Buckets = static_cast<Bucket*>(memory);
+	BucketCount = bucketCount;
+	AllocatedSize = allocatedSize;
+	for (std::size_t i = 0; i < BucketCount; i++)
+		new (&Buckets[i]) Bucket();
+	Generation = 0;
+	return true;
+}
+
+void TranspositionTable::Free()
+{
+	if (Buckets == nullptr)
+		return;
+	//The entries are atomics of plain integers, there is nothing to destroy
+	FreeAligned(Buckets);
+	Buckets = nullptr;
+	BucketCount = 0;
+}
+
+void TranspositionTable::Clear()
+{
+	for (std::size_t i = 0; i < BucketCount; i++)
+		for (Entry& entry : Buckets[i].Entries) {
+			entry.Check.store(0, std::memory_order_relaxed);
+			entry.Data.store(0, std::memory_order_relaxed);
+		}
+	Generation = 0;
+}
+
+int TranspositionTable::GetUsage() const
+{
+	const std::size_t sample = std::min<std::size_t>(BucketCount, 1000);
+	std::size_t used = 0;
+	for (std::size_t i = 0; i < sample; i++)
+		for (const Entry& entry : Buckets[i].Entries) {
+			const std::uint64_t data = entry.Data.load(std::memory_order_relaxed);
+			used += data != 0 && GetGeneration(data) == Generation;
+		}
+	return static_cast<int>(used * 1000 / (sample * BucketSize));
+}
+
+bool TranspositionTable::Probe(std::uint64_t key, TableEntry& entry) const
+{
+	for (const Entry& slot : Buckets[GetBucketIndex(key)].Entries) {
+		const std::uint64_t data = slot.Data.load(std::memory_order_relaxed);
+		if ((slot.Check.load(std::memory_order_relaxed) ^ data) != key || data == 0)
+			continue;
+		entry.BestMove = GetMove(data);
+		entry.Score = static_cast<std::int16_t>(data >> 16);
+		entry.Depth = GetDepth(data);
+		entry.ScoreBound = static_cast<Bound>(data >> 40 & 3);
+		return true;
+	}
+	return false;
+}
+
+void TranspositionTable::Store(std::uint64_t key, Move move, int score, int depth, Bound bound)
+{
+	Bucket& bucket = Buckets[GetBucketIndex(key)];
+	Entry* replaced = nullptr;
+	int replacedWorth = INT_MAX;
+	for (Entry& slot : bucket.Entries) {
+		const std::uint64_t data = slot.Data.load(std::memory_order_relaxed);
+		if (data == 0) {
+			replaced = &slot;
+			break;
+		}
+		if ((slot.Check.load(std::memory_order_relaxed) ^ data) == key) {
+			//A deeper result of this search is kept over a bound of a shallower one
+			if (bound != ExactBound && GetGeneration(data) == Generation && depth + 2 < GetDepth(data))
+				return;
+			if (move.IsNull())
+				move = GetMove(data);
+			replaced = &slot;
+			break;
+		}
+		//Every search the entry is older counts like a few plies less depth
+		const int age = (Generation - GetGeneration(data)) & GenerationMask;
+		const int worth = GetDepth(data) - 8 * age;
+		if (worth < replacedWorth) {
+			replaced = &slot;
+			replacedWorth = worth;
+		}
+	}
+
+	const std::uint64_t data = PackData(move, score, depth, bound, Generation);
+	replaced->Check.store(key ^ data, std::memory_order_relaxed);
+	replaced->Data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,114 @@
+/**
+* @file TranspositionTable.h
+*
+* @brief Results of searched positions by their Zobrist key, shared by all search
+*        threads without locks. A position hashes to a bucket of four entries that
+*        fills one cache line, so a probe touches memory once. Every entry stores
+*        its key XORed with its data, so an entry torn by two threads writing at once
+*        fails the key check on the next probe instead of handing out the data of
+*        another position. A full bucket gives up the entry of the shallowest and
+*        oldest search.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef TRANSPOSITIONTABLE_H_
+#define TRANSPOSITIONTABLE_H_
+
+#include "Move.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//What a stored score says about the real score of the position
+enum Bound { NoBound, UpperBound, LowerBound, ExactBound };
+
+struct TableEntry {
+	Move BestMove;
+	int Score;
+	int Depth;
+	Bound ScoreBound;
+};
+
+class TranspositionTable
+{
+public:
+	static const int BucketSize = 4;
+	static const std::size_t CacheLineSize = 64;
+
+	TranspositionTable();
+	~TranspositionTable();
+
+	TranspositionTable(const TranspositionTable&) = delete;
+	TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+	/**
+	* @brief Allocates the table with as many buckets as fit in the size, and clears it
+	*
+	* @param megabytes - Size of the table
+	* @param hugePages - Whether to ask the system to back the table with 2 MB pages, so
+	*                    probes all over the table miss the TLB less. Only done on Linux
+	* @return bool - Whether the memory could be had, the old table is kept when not
+	*/
+	bool Resize(std::size_t megabytes, bool hugePages = true);
+	void Clear();
+	inline std::size_t GetSize() const { return BucketCount * sizeof(Bucket); }
+	//Starts a new search, the entries of older ones are replaced first
+	inline void NewSearch() { Generation = (Generation + 1) & GenerationMask; }
+	//Entries per thousand used by the current search, from a sample of the table
+	int GetUsage() const;
+
+	/**
+	* @brief Looks up the position
+	*
+	* @param key - Zobrist key of the position
+	* @param entry - Set to what is stored for the position when it is found
+	* @return bool - Whether the position was found
+	*/
+	bool Probe(std::uint64_t key, TableEntry& entry) const;
+	//Stores the result of a search of the position
+	void Store(std::uint64_t key, Move move, int score, int depth, Bound bound);
+
+	//Starts loading the bucket of the position into the cache, so it is there when the position is probed
+	inline void Prefetch(std::uint64_t key) const
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		__builtin_prefetch(&Buckets[GetBucketIndex(key)]);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(reinterpret_cast<const char*>(&Buckets[GetBucketIndex(key)]), _MM_HINT_T0);
+#endif
+	}
+
+private:
+	static const int GenerationMask = 63;
+
+	struct Entry {
+		std::atomic<std::uint64_t> Check{ 0 };		//Key XOR data
+		std::atomic<std::uint64_t> Data{ 0 };
+	};
+	struct alignas(CacheLineSize) Bucket {
+		Entry Entries[BucketSize];
+	};
+	static_assert(sizeof(Bucket) == CacheLineSize, "A bucket has to fill one cache line");
+
+	//The high half of the product of key and count maps the key onto any number of buckets
+	inline std::size_t GetBucketIndex(std::uint64_t key) const
+	{
+#if defined(__SIZEOF_INT128__)
+		return static_cast<std::size_t>((static_cast<unsigned __int128>(key) * BucketCount) >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<std::size_t>(__umulh(key, BucketCount));
+#else
+		return static_cast<std::size_t>(key % BucketCount);
+#endif
+	}
+	void Free();
+
+	Bucket* Buckets;
+	std::size_t BucketCount;
+	std::size_t AllocatedSize;
+	int Generation;
+};
+
+#endif // TRANSPOSITIONTABLE_H_
@@ -0,0 +1,43 @@
+/**
+* @file Zobrist.cpp
+*
+* @brief Generating the Zobrist keys
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Zobrist.h"
+
+namespace {
+	//SplitMix64, every output of a counter is well mixed
+	constexpr std::uint64_t NextKey(std::uint64_t& state)
+	{
+		std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	constexpr Zobrist::KeyTable GenerateKeys()
+	{
+		Zobrist::KeyTable keys = {};
+		std::uint64_t state = 0x5A0B1257ULL;
+		for (auto& piece : keys.Pieces)
+			for (std::uint64_t& key : piece)
+				key = NextKey(state);
+		//Each castling right has a key, a combination is the XOR of its rights
+		std::uint64_t rights[4] = { NextKey(state), NextKey(state), NextKey(state), NextKey(state) };
+		for (int combination = 0; combination < 16; combination++)
+			for (int right = 0; right < 4; right++)
+				if (combination & (1 << right))
+					keys.Castling[combination] ^= rights[right];
+		for (std::uint64_t& key : keys.EnPassantFile)
+			key = NextKey(state);
+		keys.BlackToMove = NextKey(state);
+		return keys;
+	}
+}
+
+namespace Zobrist {
+	constexpr KeyTable Keys = GenerateKeys();
+}
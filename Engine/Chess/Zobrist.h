@@ -0,0 +1,30 @@
+/**
+* @file Zobrist.h
+*
+* @brief Random keys for Zobrist hashing. The key of a position is the XOR of the
+*        keys of its pieces on their squares, its castling rights, the file of its
+*        en passant square and the side to move.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef ZOBRIST_H_
+#define ZOBRIST_H_
+
+#include "ChessTypes.h"
+
+#include <cstdint>
+
+namespace Zobrist {
+	struct KeyTable {
+		std::uint64_t Pieces[PieceCount][SquareCount];
+		std::uint64_t Castling[16];			//One per combination of castling rights
+		std::uint64_t EnPassantFile[8];
+		std::uint64_t BlackToMove;
+	};
+
+	//Generated at compile time from a fixed seed, so keys are the same in every build
+	extern const KeyTable Keys;
+}
+
+#endif // ZOBRIST_H_
@@ -0,0 +1,110 @@
+/**
+* @file BenchmarkRecorder.cpp
+*
+* @brief Frame statistics of a benchmark run and writing them as JSON
+*
+* @author Aleksander Solhaug
+*/
+
+#include "BenchmarkRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+	/**
+	* @brief Writes the statistics of one timing as a JSON object. Percentiles use the
+	*        nearest rank, so every value is a frame time that was actually measured.
+	*/
+	void WriteTimes(std::ostream& out, const char* name, std::vector<double> times, bool last = false)
+	{
+		out << "    \"" << name << "\": ";
+		if (times.empty()) {
+			out << "null" << (last ? "\n" : ",\n");
+			return;
+		}
+		std::sort(times.begin(), times.end());
+		double sum = 0.0;
+		for (double time : times)
+			sum += time;
+		auto percentile = [&](double p) {
+			const std::size_t rank = static_cast<std::size_t>(std::ceil(p / 100.0 * times.size()));
+			return times[std::max<std::size_t>(rank, 1) - 1];
+		};
+		out << "{ \"min\": " << times.front()
+			<< ", \"avg\": " << sum / times.size()
+			<< ", \"p50\": " << percentile(50)
+			<< ", \"p95\": " << percentile(95)
+			<< ", \"p99\": " << percentile(99)
+			<< ", \"max\": " << times.back() << " }" << (last ? "\n" : ",\n");
+	}
+
+	//Settings are written as JSON strings, only quotes and backslashes need escaping
+	std::string Escape(const std::string& text)
+	{
+		std::string escaped;
+		for (char c : text) {
+			if (c == '"' || c == '\\')
+				escaped += '\\';
+			escaped += c;
+		}
+		return escaped;
+	}
+}
+
+BenchmarkRecorder::BenchmarkRecorder(int frames) : Samples(std::max(0, frames)) {}
+
+bool BenchmarkRecorder::WriteJson(const std::string& filePath,
+								  const std::vector<std::pair<std::string, std::string>>& settings) const
+{
+	std::ofstream out(filePath);
+	if (!out) {
+		std::cout << "Could not write the benchmark results to " << filePath << std::endl;
+		return false;
+	}
+
+	std::vector<double> frameTimes, updateTimes, renderTimes, gpuTimes;
+	RenderCounters counters;
+	std::uint64_t allocations = 0;
+	for (const FrameSample& sample : Samples) {
+		frameTimes.push_back(sample.FrameTime);
+		updateTimes.push_back(sample.UpdateTime);
+		renderTimes.push_back(sample.RenderTime);
+		if (sample.GpuTime >= 0.0)
+			gpuTimes.push_back(sample.GpuTime);
+		counters += sample.Counters;
+		allocations += sample.Allocations;
+	}
+	const double frames = std::max<double>(1.0, static_cast<double>(Samples.size()));
+
+	out << std::fixed << std::setprecision(4);
+	out << "{\n  \"settings\": {";
+	for (std::size_t i = 0; i < settings.size(); i++) {
+		out << (i == 0 ? "\n" : ",\n") << "    \"" << Escape(settings[i].first) << "\": \""
+			<< Escape(settings[i].second) << "\"";
+	}
+	out << "\n  },\n";
+	out << "  \"frames\": " << Samples.size() << ",\n";
+	out << "  \"milliseconds\": {\n";
+	WriteTimes(out, "frame", frameTimes);
+	WriteTimes(out, "cpuUpdate", updateTimes);
+	WriteTimes(out, "cpuRender", renderTimes);
+	WriteTimes(out, "gpu", gpuTimes, true);
+	out << "  },\n";
+	//Counts per frame, the totals divided by the frames
+	const std::pair<const char*, std::uint64_t> counts[] = {
+		{ "drawCalls", counters.DrawCalls }, { "triangles", counters.Triangles },
+		{ "uniformUploads", counters.UniformUploads }, { "programBinds", counters.ProgramBinds },
+		{ "vertexArrayBinds", counters.VertexArrayBinds }, { "bufferBinds", counters.BufferBinds },
+		{ "textureBinds", counters.TextureBinds }, { "stateChanges", counters.GetTotalStateChanges() },
+		{ "bytesUploaded", counters.BytesUploaded }, { "heapAllocations", allocations } };
+	out << "  \"countsPerFrame\": {\n";
+	const std::size_t countNames = sizeof(counts) / sizeof(counts[0]);
+	for (std::size_t i = 0; i < countNames; i++)
+		out << "    \"" << counts[i].first << "\": " << counts[i].second / frames << (i + 1 < countNames ? ",\n" : "\n");
+	out << "  }\n}\n";
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,54 @@
+/**
+* @file BenchmarkRecorder.h
+*
+* @brief Collects the timings and counters of every frame of a benchmark run and
+*        writes their statistics to a JSON file, so runs of different builds can
+*        be compared with a plain diff.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef BENCHMARKRECORDER_H_
+#define BENCHMARKRECORDER_H_
+
+#include <RenderStats.h>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct FrameSample {
+	double FrameTime = 0.0;			//Milliseconds since the previous frame was presented
+	double UpdateTime = 0.0;		//Milliseconds of CPU time the simulation step took
+	double RenderTime = 0.0;		//Milliseconds of CPU time spent submitting the frame
+	double GpuTime = -1.0;			//Milliseconds the GPU spent on the frame, negative when unknown
+	RenderCounters Counters;		//Work the frame submitted
+	std::uint64_t Allocations = 0;	//Heap allocations of the simulation step and the frame
+};
+
+class BenchmarkRecorder {
+public:
+	/**
+	* @param frames - Frames of the run, all samples are allocated up front
+	*/
+	explicit BenchmarkRecorder(int frames);
+
+	int GetFrameCount() const { return static_cast<int>(Samples.size()); }
+	FrameSample& GetSample(int frame) { return Samples[frame]; }
+
+	/**
+	* @brief Writes min, avg, p50, p95, p99 and max of every timing and the render
+	*        counters per frame to a JSON file
+	*
+	* @param filePath - File to write
+	* @param settings - Name and value pairs describing the run, written as strings
+	* @return bool - Whether the file was written
+	*/
+	bool WriteJson(const std::string& filePath,
+				   const std::vector<std::pair<std::string, std::string>>& settings) const;
+
+private:
+	std::vector<FrameSample> Samples;
+};
+
+#endif // BENCHMARKRECORDER_H_
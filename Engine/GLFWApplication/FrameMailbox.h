@@ -0,0 +1,97 @@
+/**
+* @file FrameMailbox.h
+*
+* @brief Lock-free triple buffer that hands frame packets from the thread running
+*        the game to the render thread. The writer fills one slot while the reader
+*        draws from another, the third holds the newest finished packet. Neither
+*        side ever waits for the other, the reader always gets the latest packet
+*        and packets it was too slow for are skipped. A reader with nothing to
+*        draw can sleep in WaitForPacket() until the writer publishes.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef FRAMEMAILBOX_H_
+#define FRAMEMAILBOX_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+template <typename T>
+class FrameMailbox {
+public:
+	FrameMailbox() : WriteIndex(0), ReadIndex(1), Shared(2) {}
+
+	FrameMailbox(const FrameMailbox&) = delete;
+	FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+	/**
+	* @brief Slot owned by the writer. It holds an old packet and has to be filled
+	*        completely before it is published.
+	*/
+	T& GetWriteSlot() { return Slots[WriteIndex].Packet; }
+
+	//Hands the write slot to the reader and takes a free slot to write the next packet into
+	void Publish()
+	{
+		WriteIndex = Shared.exchange(WriteIndex | NewPacket, std::memory_order_acq_rel) & IndexMask;
+		//The lock only orders the notification against a reader about to sleep
+		{ std::lock_guard<std::mutex> lock(WaitMutex); }
+		PacketPublished.notify_one();
+	}
+
+	/**
+	* @brief Takes the newest published packet, if there is one the reader has not seen
+	*
+	* @return bool - Whether GetReadSlot() changed to a new packet
+	*/
+	bool Acquire()
+	{
+		if (!(Shared.load(std::memory_order_relaxed) & NewPacket))
+			return false;
+		ReadIndex = Shared.exchange(ReadIndex, std::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+
+	/**
+	* @brief Like Acquire(), but sleeps until a packet is published or the timeout runs out
+	*
+	* @param timeout - Longest time to sleep
+	* @return bool - Whether GetReadSlot() changed to a new packet
+	*/
+	bool WaitForPacket(std::chrono::milliseconds timeout)
+	{
+		if (Acquire())
+			return true;
+		std::unique_lock<std::mutex> lock(WaitMutex);
+		PacketPublished.wait_for(lock, timeout,
+			[this]() { return (Shared.load(std::memory_order_acquire) & NewPacket) != 0; });
+		lock.unlock();
+		return Acquire();
+	}
+
+	//Whether the last published packet is still waiting for the reader, for a writer that must not skip packets
+	bool IsPending() const { return (Shared.load(std::memory_order_acquire) & NewPacket) != 0; }
+
+	//Packet owned by the reader, unchanged until the next Acquire()
+	const T& GetReadSlot() const { return Slots[ReadIndex].Packet; }
+
+private:
+	static constexpr unsigned IndexMask = 3;
+	static constexpr unsigned NewPacket = 4;	//Set in Shared when it holds a packet not read yet
+
+	//Slots on their own cache lines, so the two threads do not share lines
+	struct alignas(64) Slot { T Packet; };
+
+	std::array<Slot, 3> Slots;
+	unsigned WriteIndex;			//Only used by the writer
+	unsigned ReadIndex;				//Only used by the reader
+	alignas(64) std::atomic<unsigned> Shared;
+	std::mutex WaitMutex;
+	std::condition_variable PacketPublished;
+};
+
+#endif // FRAMEMAILBOX_H_
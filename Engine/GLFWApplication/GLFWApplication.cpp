@@ -8,10 +8,15 @@
 */
 
 #include <GLFWApplication.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 
 /**
 * @brief API for giving good debug messages when something is wrong in the code.
-* 
+*        Called by the driver, possibly on its own threads, so the message is only
+*        formatted into the logger's ring; the logger thread writes it out,
+*        deduplicated by the message id and rate limited.
 */
 void APIENTRY MessageCallBack(GLenum source,
     GLenum type,
@@ -23,40 +28,60 @@ void APIENTRY MessageCallBack(GLenum source,
     // ignore non-significant error/warning codes
     if (id == 131169 || id == 131185 || id == 131218 || id == 131204) return;
 
-    std::cout << "---------------" << std::endl;
-    std::cout << "Debug message (" << id << "): " << message << std::endl;
-
+    const char* sourceName = "Other";
     switch (source)
     {
-    case GL_DEBUG_SOURCE_API:             std::cout << "Source: API"; break;
-    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   std::cout << "Source: Window System"; break;
-    case GL_DEBUG_SOURCE_SHADER_COMPILER: std::cout << "Source: Shader Compiler"; break;
-    case GL_DEBUG_SOURCE_THIRD_PARTY:     std::cout << "Source: Third Party"; break;
-    case GL_DEBUG_SOURCE_APPLICATION:     std::cout << "Source: Application"; break;
-    case GL_DEBUG_SOURCE_OTHER:           std::cout << "Source: Other"; break;
-    } std::cout << std::endl;
+    case GL_DEBUG_SOURCE_API:             sourceName = "API"; break;
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   sourceName = "Window System"; break;
+    case GL_DEBUG_SOURCE_SHADER_COMPILER: sourceName = "Shader Compiler"; break;
+    case GL_DEBUG_SOURCE_THIRD_PARTY:     sourceName = "Third Party"; break;
+    case GL_DEBUG_SOURCE_APPLICATION:     sourceName = "Application"; break;
+    }
 
+    const char* typeName = "Other";
     switch (type)
     {
-    case GL_DEBUG_TYPE_ERROR:               std::cout << "Type: Error"; break;
-    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: std::cout << "Type: Deprecated Behaviour"; break;
-    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  std::cout << "Type: Undefined Behaviour"; break;
-    case GL_DEBUG_TYPE_PORTABILITY:         std::cout << "Type: Portability"; break;
-    case GL_DEBUG_TYPE_PERFORMANCE:         std::cout << "Type: Performance"; break;
-    case GL_DEBUG_TYPE_MARKER:              std::cout << "Type: Marker"; break;
-    case GL_DEBUG_TYPE_PUSH_GROUP:          std::cout << "Type: Push Group"; break;
-    case GL_DEBUG_TYPE_POP_GROUP:           std::cout << "Type: Pop Group"; break;
-    case GL_DEBUG_TYPE_OTHER:               std::cout << "Type: Other"; break;
-    } std::cout << std::endl;
+    case GL_DEBUG_TYPE_ERROR:               typeName = "Error"; break;
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: typeName = "Deprecated Behaviour"; break;
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  typeName = "Undefined Behaviour"; break;
+    case GL_DEBUG_TYPE_PORTABILITY:         typeName = "Portability"; break;
+    case GL_DEBUG_TYPE_PERFORMANCE:         typeName = "Performance"; break;
+    case GL_DEBUG_TYPE_MARKER:              typeName = "Marker"; break;
+    case GL_DEBUG_TYPE_PUSH_GROUP:          typeName = "Push Group"; break;
+    case GL_DEBUG_TYPE_POP_GROUP:           typeName = "Pop Group"; break;
+    }
 
+    LogLevel level = LogLevel::Debug;
     switch (severity)
     {
-    case GL_DEBUG_SEVERITY_HIGH:         std::cout << "Severity: high"; break;
-    case GL_DEBUG_SEVERITY_MEDIUM:       std::cout << "Severity: medium"; break;
-    case GL_DEBUG_SEVERITY_LOW:          std::cout << "Severity: low"; break;
-    case GL_DEBUG_SEVERITY_NOTIFICATION: std::cout << "Severity: notification"; break;
-    } std::cout << std::endl;
-    std::cout << std::endl;
+    case GL_DEBUG_SEVERITY_HIGH:   level = LogLevel::Error; break;
+    case GL_DEBUG_SEVERITY_MEDIUM: level = LogLevel::Warning; break;
+    case GL_DEBUG_SEVERITY_LOW:    level = LogLevel::Info; break;
+    }
+
+    Logger::GetInstance().Post(level, id, "GL %u (%s, %s): %s", id, sourceName, typeName, message);
+}
+
+/**
+* @brief Enables the debug output of the current context for messages at or above a severity
+*
+* @param level - Least severe messages to receive
+* @param synchronous - Whether messages are sent on the thread making the GL call, for breakpoints
+*/
+static void EnableDebugOutput(GLDebugLevel level, bool synchronous)
+{
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(MessageCallBack, nullptr);
+
+    //Messages below the level are filtered out by the driver and never formatted
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    const GLenum severities[] = { GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM,
+                                  GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION };
+    for (int i = 0; i < static_cast<int>(level); i++)
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severities[i], 0, nullptr, GL_TRUE);
 }
 
 /**
@@ -66,19 +91,33 @@ void APIENTRY MessageCallBack(GLenum source,
 * @param version - Version of the application
 */
 GLFWApplication::GLFWApplication(const std::string name, const std::string version) 
-    : m_name(name), m_version(version), m_width (800), m_height(800), m_window () {}
+    : m_name(name), m_version(version), m_width (800), m_height(800), m_window (),
+      m_presentMode(PresentMode::VSync), m_frameRateLimit(0.0), m_headless(false), m_frameCount(0),
+      m_dumpFormat("png"), m_debugLevel(GLDebugLevel::Medium), m_debugSynchronous(false), m_noErrorContext(false),
+      m_benchmarkFrames(0), m_benchmarkWarmUp(0), m_benchmarkOutput("benchmark.json"),
+      m_renderStatsSummary(false) {}
 
 /**
 * @brief Closes the application
 */
 GLFWApplication::~GLFWApplication()
 {
+    if (!m_profilePath.empty() && Profiler::IsRunning()) {
+        Profiler::Stop();
+        if (Profiler::WriteTrace(m_profilePath))
+            std::cout << "CPU profile written to " << m_profilePath << std::endl;
+    }
     glfwTerminate();
+    Logger::GetInstance().Stop();
 }
 
 /**
 * @brief Handling the command line arguments passed when the program is started
-*        Specifically the width and heigth of the application
+*        Specifically the width and heigth of the application, the present mode,
+*        the frame rate limit, the headless rendering options, the GL debug output,
+*        the benchmark, the GPU profile log, the render statistics summary and the
+*        CPU profile. A benchmark renders its warm-up and measured frames
+*        uncapped unless a present mode is given.
 */
 unsigned int GLFWApplication::ParseArguments(int argc, char** argv) {
     try {
@@ -86,13 +125,94 @@ unsigned int GLFWApplication::ParseArguments(int argc, char** argv) {
         TCLAP::CmdLine cmd("Command description message", ' ', "0.9");
         TCLAP::ValueArg<int> widthArg("w", "width", "width", false, 800, "int");
         TCLAP::ValueArg<int> heigthArg("g", "heigth", "heigth", false, 800, "int");
-        
+        std::vector<std::string> presentModes = { "vsync", "adaptive", "uncapped" };
+        TCLAP::ValuesConstraint<std::string> presentModeConstraint(presentModes);
+        TCLAP::ValueArg<std::string> presentModeArg("", "present-mode", "Swap synchronization",
+                                                    false, "vsync", &presentModeConstraint);
+        TCLAP::ValueArg<double> frameRateArg("", "fps-limit", "Frame rate limit, 0 for none", false, 0.0, "fps");
+        TCLAP::SwitchArg headlessArg("", "headless", "Render offscreen without a visible window", false);
+        TCLAP::ValueArg<int> framesArg("", "frames", "Frames to render before exiting, 0 until closed (1 when headless)",
+                                       false, 0, "int");
+        TCLAP::ValueArg<std::string> dumpArg("", "dump-frames", "Directory to save every rendered frame in", false, "", "path");
+        std::vector<std::string> dumpFormats = { "png", "raw" };
+        TCLAP::ValuesConstraint<std::string> dumpFormatConstraint(dumpFormats);
+        TCLAP::ValueArg<std::string> dumpFormatArg("", "dump-format", "Image format of the saved frames",
+                                                   false, "png", &dumpFormatConstraint);
+        std::vector<std::string> debugLevels = { "off", "high", "medium", "low", "all" };
+        TCLAP::ValuesConstraint<std::string> debugLevelConstraint(debugLevels);
+#ifdef NDEBUG
+        const std::string defaultDebugLevel = "off";
+#else
+        const std::string defaultDebugLevel = "medium";
+#endif
+        TCLAP::ValueArg<std::string> debugLevelArg("", "gl-debug",
+            "Least severe GL debug messages to log, off creates a context without debug output",
+            false, defaultDebugLevel, &debugLevelConstraint);
+        TCLAP::SwitchArg debugSyncArg("", "gl-debug-sync", "Send GL debug messages on the calling thread", false);
+        TCLAP::SwitchArg noErrorArg("", "gl-no-error", "Create a context without error checking when debug output is off", false);
+        TCLAP::ValueArg<int> benchmarkArg("", "benchmark", "Play the scripted benchmark and measure this many frames",
+                                          false, 0, "frames");
+        TCLAP::ValueArg<int> benchmarkWarmUpArg("", "benchmark-warmup", "Frames drawn before the benchmark measures",
+                                                false, 60, "frames");
+        TCLAP::ValueArg<std::string> benchmarkOutputArg("", "benchmark-output", "JSON file the benchmark results are written to",
+                                                        false, "benchmark.json", "path");
+        TCLAP::ValueArg<std::string> gpuProfileArg("", "gpu-profile", "File to log the GPU time of every frame and pass to",
+                                                   false, "", "path");
+        TCLAP::SwitchArg renderStatsArg("", "render-stats", "Log the draws, binds and uploads per frame once a second", false);
+        TCLAP::ValueArg<std::string> profileArg("", "profile", "Chrome trace file to write the CPU profile to", false, "", "path");
+
         cmd.add(widthArg);
         cmd.add(heigthArg);
+        cmd.add(presentModeArg);
+        cmd.add(frameRateArg);
+        cmd.add(headlessArg);
+        cmd.add(framesArg);
+        cmd.add(dumpArg);
+        cmd.add(dumpFormatArg);
+        cmd.add(debugLevelArg);
+        cmd.add(debugSyncArg);
+        cmd.add(noErrorArg);
+        cmd.add(benchmarkArg);
+        cmd.add(benchmarkWarmUpArg);
+        cmd.add(benchmarkOutputArg);
+        cmd.add(gpuProfileArg);
+        cmd.add(renderStatsArg);
+        cmd.add(profileArg);
+        AddArguments(cmd);
         cmd.parse(argc, argv);
 
         m_width = widthArg.getValue();
         m_height = heigthArg.getValue();
+        if (presentModeArg.getValue() == "adaptive")
+            m_presentMode = PresentMode::Adaptive;
+        else if (presentModeArg.getValue() == "uncapped")
+            m_presentMode = PresentMode::Uncapped;
+        else m_presentMode = PresentMode::VSync;
+        m_frameRateLimit = frameRateArg.getValue();
+        m_headless = headlessArg.getValue();
+        m_frameCount = std::max(0, framesArg.getValue());
+        if (m_headless && m_frameCount == 0)
+            m_frameCount = 1;
+        m_dumpDirectory = dumpArg.getValue();
+        m_dumpFormat = dumpFormatArg.getValue();
+        const std::string& debugLevel = debugLevelArg.getValue();
+        m_debugLevel = debugLevel == "off" ? GLDebugLevel::Off :
+                       debugLevel == "high" ? GLDebugLevel::High :
+                       debugLevel == "medium" ? GLDebugLevel::Medium :
+                       debugLevel == "low" ? GLDebugLevel::Low : GLDebugLevel::All;
+        m_debugSynchronous = debugSyncArg.getValue();
+        m_noErrorContext = noErrorArg.getValue();
+        m_benchmarkFrames = std::max(0, benchmarkArg.getValue());
+        m_benchmarkWarmUp = std::max(0, benchmarkWarmUpArg.getValue());
+        m_benchmarkOutput = benchmarkOutputArg.getValue();
+        m_gpuProfilePath = gpuProfileArg.getValue();
+        m_renderStatsSummary = renderStatsArg.getValue();
+        m_profilePath = profileArg.getValue();
+        if (m_benchmarkFrames > 0) {
+            m_frameCount = m_benchmarkWarmUp + m_benchmarkFrames;
+            if (!presentModeArg.isSet())
+                m_presentMode = PresentMode::Uncapped;
+        }
     }
     catch (TCLAP::ArgException& e)
     {
@@ -102,16 +222,43 @@ unsigned int GLFWApplication::ParseArguments(int argc, char** argv) {
     return 0;
 }
 
+/**
+* @brief Checks whether there is a display server to open windows on
+*/
+static bool HasDisplay()
+{
+#if defined(__linux__) || defined(__FreeBSD__)
+    return std::getenv("DISPLAY") != nullptr || std::getenv("WAYLAND_DISPLAY") != nullptr;
+#else
+    return true;
+#endif
+}
+
 /**
 * @brief Initializing external libraries, creating the window and setting 
-*        debug context
+*        debug context. Headless, the window is invisible and the context is
+*        created with EGL or OSMesa when the native API fails, for example on
+*        build servers without a GPU or display, rendering with Mesa llvmpipe.
 */
  unsigned GLFWApplication::Init()
 {
+#ifdef GLFW_PLATFORM_NULL
+    //Without a display GLFW can still create EGL and OSMesa contexts on its null platform
+    if (m_headless && !HasDisplay())
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
+    //GL debug messages and other warnings are written by the logger thread
+    Logger::GetInstance().Start();
+    if (!m_profilePath.empty())
+        Profiler::Start();
+
     // Initialization of glfw.
     if (!glfwInit())
     {
-        std::cin.get();
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        if (!m_headless)
+            std::cin.get();
 
         return EXIT_FAILURE;
     }
@@ -121,20 +268,30 @@ unsigned int GLFWApplication::ParseArguments(int argc, char** argv) {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, true);
+    //Release runs can skip the debug context, and even the error checking of the driver
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, m_debugLevel != GLDebugLevel::Off);
+    glfwWindowHint(GLFW_CONTEXT_NO_ERROR, m_debugLevel == GLDebugLevel::Off && m_noErrorContext);
+    glfwWindowHint(GLFW_VISIBLE, !m_headless);
 
-
-    m_window = glfwCreateWindow(m_width, m_height, m_name.c_str(), nullptr, nullptr);
+    //Headless, every context creation API is tried until one works
+    const int contextApis[] = { GLFW_NATIVE_CONTEXT_API, GLFW_EGL_CONTEXT_API, GLFW_OSMESA_CONTEXT_API };
+    for (int contextApi : contextApis) {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApi);
+        m_window = glfwCreateWindow(m_width, m_height, m_name.c_str(), nullptr, nullptr);
+        if (m_window != nullptr || !m_headless)
+            break;
+    }
     if (m_window == nullptr) {                       
         std::cout << "Failed to setup GLFW window" << std::endl;
         glfwTerminate();
-        std::cin.get();
+        if (!m_headless)
+            std::cin.get();
         return EXIT_FAILURE;
     }
 
-    //Set the OpenGL context
+    //Set the OpenGL context, frames are not presented headless so nothing waits for vsync
     glfwMakeContextCurrent(m_window);
-    glfwSwapInterval(1);
+    SetPresentMode(m_headless ? PresentMode::Uncapped : m_presentMode);
 
     //Initializing external library glad
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -152,10 +309,46 @@ unsigned int GLFWApplication::ParseArguments(int argc, char** argv) {
     GLint flags;
     glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
     if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
-    {
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-        glDebugMessageCallback(MessageCallBack, nullptr);
-        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        EnableDebugOutput(m_debugLevel, m_debugSynchronous);
+    return 0;
+}
+
+/**
+* @brief Sets the swap interval of the current context. Adaptive sync needs the
+*        swap control tear extension and falls back to vsync without it.
+*
+* @param mode - How the frames are presented
+*/
+void GLFWApplication::SetPresentMode(PresentMode mode)
+{
+    switch (mode) {
+    case PresentMode::Adaptive:
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+            glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+            glfwSwapInterval(-1);
+            break;
+        }
+        std::cout << "Adaptive sync is not supported, using vsync" << std::endl;
+        glfwSwapInterval(1);
+        break;
+    case PresentMode::Uncapped:
+        glfwSwapInterval(0);
+        break;
+    default:
+        glfwSwapInterval(1);
+        break;
     }
 }
+
+/**
+* @brief Creates the path a rendered frame is saved to
+*
+* @param frame - Number of the frame
+* @return path - <dump directory>/frame_<number>.<dump format>
+*/
+std::string GLFWApplication::GetFrameDumpPath(int frame) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.", frame);
+    return m_dumpDirectory + "/" + name + m_dumpFormat;
+}
@@ -6,6 +6,15 @@
 #include <tclap/CmdLine.h>
 #include <cstdlib>
 #include <iostream>
+#include <Logger.h>
+#include <Profiler.h>
+
+//How frames are presented: synchronized to the display, synchronized unless a
+//frame is late (swap tear), or as fast as possible
+enum class PresentMode { VSync, Adaptive, Uncapped };
+
+//Least severe GL debug messages that are logged, Off creates a context without debug output
+enum class GLDebugLevel { Off, High, Medium, Low, All };
 
 class GLFWApplication
 {
@@ -15,16 +24,37 @@ public:
 
 	//Argument parsing
 	virtual unsigned int ParseArguments(int argc, char** argv); // Virtual function with default behavior.
+	virtual void AddArguments(TCLAP::CmdLine& cmd) {} // Lets subclasses add their own arguments
 	// Initialization 
 	virtual unsigned Init(); // Virtual function with default behavior
 	// Run function
 	virtual unsigned Run() const = 0; // Pure virtual function, it must be redefined
 
+	// Sets the swap interval of the current context for the present mode
+	static void SetPresentMode(PresentMode mode);
+	// Path of a saved frame, <dump directory>/frame_<number>.<dump format>
+	std::string GetFrameDumpPath(int frame) const;
+
 protected:
 	GLint m_height;
 	GLint m_width;
 	GLFWwindow* m_window;
 	std::string m_name, m_version;
+	PresentMode m_presentMode;
+	double m_frameRateLimit;	// Frames per second, 0 means no limit besides the present mode
+	bool m_headless;			// Rendering offscreen, without a visible window
+	int m_frameCount;			// Frames to render before exiting, 0 renders until the window closes
+	std::string m_dumpDirectory;	// Directory every frame is saved in, empty to save none
+	std::string m_dumpFormat;	// "png" or "raw"
+	GLDebugLevel m_debugLevel;
+	bool m_debugSynchronous;	// Debug messages sent on the thread making the GL call
+	bool m_noErrorContext;		// Context without error checking, when the debug output is off
+	int m_benchmarkFrames;		// Frames of the scripted benchmark that are measured, 0 runs interactively
+	int m_benchmarkWarmUp;		// Frames drawn before the benchmark starts measuring
+	std::string m_benchmarkOutput;	// JSON file the benchmark results are written to
+	std::string m_gpuProfilePath;	// File the GPU time of every frame and pass is logged to, empty to log none
+	bool m_renderStatsSummary;	// Logging the render counters per frame once a second
+	std::string m_profilePath;	// Chrome trace file the CPU profile is written to, empty to not profile
 };
 
 
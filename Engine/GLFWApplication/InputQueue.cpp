@@ -0,0 +1,52 @@
+/**
+* @file InputQueue.cpp
+*
+* @brief Queueing the key events of a window from the GLFW callbacks
+*
+* @author Aleksander Solhaug
+*/
+
+#include "InputQueue.h"
+
+InputQueue::~InputQueue()
+{
+	Detach();
+}
+
+void InputQueue::Attach(GLFWwindow* window)
+{
+	Detach();
+	Window = window;
+	glfwSetWindowUserPointer(Window, this);
+	glfwSetKeyCallback(Window, KeyCallback);
+	glfwSetWindowRefreshCallback(Window, RefreshCallback);
+}
+
+void InputQueue::Detach()
+{
+	if (Window == nullptr)
+		return;
+	glfwSetKeyCallback(Window, nullptr);
+	glfwSetWindowRefreshCallback(Window, nullptr);
+	glfwSetWindowUserPointer(Window, nullptr);
+	Window = nullptr;
+}
+
+void InputQueue::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	auto* queue = static_cast<InputQueue*>(glfwGetWindowUserPointer(window));
+	if (queue == nullptr || key == GLFW_KEY_UNKNOWN)
+		return;
+	if (action == GLFW_PRESS)
+		queue->KeysDown.set(key);
+	else if (action == GLFW_RELEASE)
+		queue->KeysDown.reset(key);
+	queue->Events.push_back({ key, action, mods });
+}
+
+void InputQueue::RefreshCallback(GLFWwindow* window)
+{
+	auto* queue = static_cast<InputQueue*>(glfwGetWindowUserPointer(window));
+	if (queue != nullptr)
+		queue->RefreshRequested = true;
+}
@@ -0,0 +1,64 @@
+/**
+* @file InputQueue.h
+*
+* @brief Collects the key events of a window from the GLFW callbacks, so the game
+*        reacts to key presses as events instead of polling glfwGetKey for every
+*        key each frame. The held state of every key is tracked as well, for input
+*        that acts for as long as a key is down.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef INPUTQUEUE_H_
+#define INPUTQUEUE_H_
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <bitset>
+#include <vector>
+
+struct KeyEvent {
+	int Key;		//GLFW_KEY_*
+	int Action;		//GLFW_PRESS, GLFW_REPEAT or GLFW_RELEASE
+	int Mods;		//GLFW_MOD_* bits
+};
+
+class InputQueue {
+public:
+	InputQueue() = default;
+	~InputQueue();
+
+	InputQueue(const InputQueue&) = delete;
+	InputQueue& operator=(const InputQueue&) = delete;
+
+	/**
+	* @brief Installs the key and refresh callbacks of the window. The events are
+	*        queued while glfwPollEvents() or glfwWaitEvents*() runs on the main thread.
+	*
+	* @param window - Window to receive the events of
+	*/
+	void Attach(GLFWwindow* window);
+	//Removes the callbacks again
+	void Detach();
+
+	//Events queued since the last ClearEvents(), oldest first
+	const std::vector<KeyEvent>& GetEvents() const { return Events; }
+	void ClearEvents() { Events.clear(); RefreshRequested = false; }
+
+	bool IsKeyDown(int key) const { return key >= 0 && key <= GLFW_KEY_LAST && KeysDown.test(key); }
+	bool IsAnyKeyDown() const { return KeysDown.any(); }
+	//Whether the window system asked for the window contents to be drawn again
+	bool IsRefreshRequested() const { return RefreshRequested; }
+
+private:
+	static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void RefreshCallback(GLFWwindow* window);
+
+	GLFWwindow* Window = nullptr;
+	std::vector<KeyEvent> Events;
+	std::bitset<GLFW_KEY_LAST + 1> KeysDown;
+	bool RefreshRequested = false;
+};
+
+#endif // INPUTQUEUE_H_
@@ -0,0 +1,35 @@
+/**
+* @file RenderThread.cpp
+*
+* @brief Moving the OpenGL context of a window to a thread of its own
+*
+* @author Aleksander Solhaug
+*/
+
+#include "RenderThread.h"
+
+RenderThread::RenderThread(GLFWwindow* window, std::function<void(const RenderThread&)> render)
+	: Window(window), Running(true)
+{
+	//A context can only be current on one thread at a time
+	glfwMakeContextCurrent(nullptr);
+	Thread = std::thread([this, render = std::move(render)]() {
+		glfwMakeContextCurrent(Window);
+		render(*this);
+		glfwMakeContextCurrent(nullptr);
+	});
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Stop()
+{
+	if (!Thread.joinable())
+		return;
+	Running.store(false, std::memory_order_release);
+	Thread.join();
+	glfwMakeContextCurrent(Window);
+}
@@ -0,0 +1,46 @@
+/**
+* @file RenderThread.h
+*
+* @brief Thread that owns the OpenGL context of a window and does all the GL
+*        submission, so the thread running input and game logic never waits for
+*        the driver or for glfwSwapBuffers. Events must still be polled on the main thread.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef RENDERTHREAD_H_
+#define RENDERTHREAD_H_
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+class RenderThread {
+public:
+	/**
+	* @brief Releases the context of the window on the calling thread and starts
+	*        the render function on a new thread with the context made current there
+	*
+	* @param window - Window whose context the thread takes over
+	* @param render - Creates the GL resources and draws until IsRunning() turns false
+	*/
+	RenderThread(GLFWwindow* window, std::function<void(const RenderThread&)> render);
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	//Asks the render function to return, waits for it and makes the context current again on the calling thread
+	void Stop();
+	bool IsRunning() const { return Running.load(std::memory_order_acquire); }
+
+private:
+	GLFWwindow* Window;
+	std::atomic<bool> Running;
+	std::thread Thread;
+};
+
+#endif // RENDERTHREAD_H_
@@ -12,7 +12,15 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
 #include <glm/glm.hpp>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GEOMETRICTOOLS_SSE2
+#endif
 namespace GeometricTools {
 	
 	//Coordinates for a UnitTriangle
@@ -97,13 +105,14 @@ namespace GeometricTools {
 	template <typename T, typename U>
 	std::vector<float> UnitGridGeometry2D(T x, U y) {
 		//Always 1 more row and column comapred to number of squares in row and column
-		const int size = (x + 1) * (y + 1) * 2;	
+		const std::size_t rows = static_cast<std::size_t>(x), columns = static_cast<std::size_t>(y);
+		const std::size_t size = (rows + 1) * (columns + 1) * 2;
 		std::vector <float> vertexes;
 		vertexes.resize(size);
-		int h = 0;
-		for (int i = 0; i < x + 1 ; i++) {
+		std::size_t h = 0;
+		for (std::size_t i = 0; i < rows + 1 ; i++) {
 			GLfloat xCoordinate = (float)i / (float)x;		//-0.5 to 0.5 with 1/x increments for rows
-			for (int j = 0; j < y + 1; j++) {
+			for (std::size_t j = 0; j < columns + 1; j++) {
 				GLfloat yCoordinate = (float)j / (float)y;  //Same as above for columns
 				
 				//Normalizing the coordinates
@@ -122,21 +131,22 @@ namespace GeometricTools {
 	* @return indices - address of the array indices is returned
 	*/
 	template <typename T, typename U>
-	std::vector <GLuint> UnitGridTopologyTriangles(T X, U Y) {
+	std::vector <GLuint> UnitGridTopologyTriangles(T X, U columns) {
 		std::vector <GLuint> indices;
+		const std::size_t rows = static_cast<std::size_t>(X), Y = static_cast<std::size_t>(columns);
 		//rows * columns, * 3 because 2 triangles per square in the grid	
-		indices.resize(X * Y * 3 * 2);
-		int count = 0;
-		for (int i = 0; i < X; i++) {
-			for (int j = 0; j < Y; j++) {
+		indices.resize(rows * Y * 3 * 2);
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < rows; i++) {
+			for (std::size_t j = 0; j < Y; j++) {
 				//first triangle in the current square
-				indices[count++] = ((Y + 1) * i) + j;			  //Bottom left vertex
-				indices[count++] = (Y + 1) * (i + 1) + j;	      //Top left vertex
-				indices[count++] = (Y + 1) * (i + 1) + j + 1;     //Top right vertex
+				indices[count++] = static_cast<GLuint>(((Y + 1) * i) + j);			  //Bottom left vertex
+				indices[count++] = static_cast<GLuint>((Y + 1) * (i + 1) + j);	      //Top left vertex
+				indices[count++] = static_cast<GLuint>((Y + 1) * (i + 1) + j + 1);     //Top right vertex
 				//second triangle in the current square
-				indices[count++] = ((Y + 1) * i) + j;			  //Bottom left vertex
-				indices[count++] = ((Y + 1) * i) + j + 1;		  //Bottom right vertex
-				indices[count++] = (Y + 1) * (i + 1) + j +1;      //Top right vertex
+				indices[count++] = static_cast<GLuint>(((Y + 1) * i) + j);			  //Bottom left vertex
+				indices[count++] = static_cast<GLuint>(((Y + 1) * i) + j + 1);		  //Bottom right vertex
+				indices[count++] = static_cast<GLuint>((Y + 1) * (i + 1) + j +1);      //Top right vertex
 			}
 		}
 		return indices;
@@ -152,14 +162,15 @@ namespace GeometricTools {
 	template <typename T, typename U>
 	std::vector<float> UnitGridGeometry2DWTCoords(T x, U y)
 	{
-		const int size = (x + 1) * (y + 1) * 4;
+		const std::size_t rows = static_cast<std::size_t>(x), columns = static_cast<std::size_t>(y);
+		const std::size_t size = (rows + 1) * (columns + 1) * 4;
 		std::vector <float> vertexes;
 		vertexes.resize(size);
-		int h = 0;
+		std::size_t h = 0;
 		//float zCoordinate = 0.0f;
-		for (int i = 0; i < x + 1; i++) {
+		for (std::size_t i = 0; i < rows + 1; i++) {
 			GLfloat xCoordinate = (float)i / (float)x;
-			for (int j = 0; j < y + 1; j++) {
+			for (std::size_t j = 0; j < columns + 1; j++) {
 				GLfloat yCoordinate = (float)j / (float)y;
 				//float color = (float)((i + j) % 2);
 
@@ -173,5 +184,148 @@ namespace GeometricTools {
 		return vertexes;
 	}
 
+	//Largest number of squares per side of a grid tile, (255 + 1)^2 vertices fit 16 bit indices
+	constexpr std::size_t MaxTileSquares = 255;
+
+	/**
+	* @brief Part of a large grid that can be drawn on its own with 16 bit indices
+	*/
+	struct GridTile {
+		std::size_t firstRow, firstColumn;	//First square of the tile within the grid
+		std::size_t rows, columns;			//Number of squares in the tile
+		std::vector<float> vertices;		//Same layout as UnitGridGeometry2D(WTCoords)
+		std::vector<GLushort> indices;		//Local to the tile
+	};
+
+	/**
+	* @brief Fills the vertices of one tile, same coordinates as UnitGridGeometry2D(WTCoords)
+	*
+	* @param tile - Tile with its first square and size set
+	* @param x - Number of rows for the whole grid
+	* @param y - Number of columns for the whole grid
+	* @param textureCoords - Whether to add texture coordinates to each vertex
+	*/
+	inline void GridTileGeometry(GridTile& tile, std::size_t x, std::size_t y, bool textureCoords) {
+		const std::size_t floatsPerVertex = textureCoords ? 4 : 2;
+		const std::size_t tileColumns = tile.columns + 1;
+		tile.vertices.resize((tile.rows + 1) * tileColumns * floatsPerVertex);
+		float* out = tile.vertices.data();
+		for (std::size_t i = tile.firstRow; i <= tile.firstRow + tile.rows; i++) {
+			const GLfloat xCoordinate = (float)i / (float)x;
+			std::size_t j = tile.firstColumn;
+			const std::size_t lastColumn = tile.firstColumn + tile.columns;
+#ifdef GEOMETRICTOOLS_SSE2
+			//Four vertices of the row at a time, dividing like the scalar code so tiles match exactly
+			const __m128 half = _mm_set1_ps(0.5f);
+			const __m128 columnCount = _mm_set1_ps((float)y);
+			const __m128 xLow = _mm_set1_ps(xCoordinate - 0.5f);
+			const __m128 xPair = _mm_setr_ps(xCoordinate - 0.5f, xCoordinate + 0.5f,
+											 xCoordinate - 0.5f, xCoordinate + 0.5f);
+			for (; j + 4 <= lastColumn + 1; j += 4) {
+				const __m128 column = _mm_setr_ps((float)j, (float)(j + 1), (float)(j + 2), (float)(j + 3));
+				const __m128 yCoordinate = _mm_div_ps(column, columnCount);
+				const __m128 yLow = _mm_sub_ps(yCoordinate, half);
+				if (textureCoords) {
+					const __m128 yHigh = _mm_add_ps(yCoordinate, half);
+					const __m128 first = _mm_unpacklo_ps(yLow, yHigh);	//y0-, y0+, y1-, y1+
+					const __m128 second = _mm_unpackhi_ps(yLow, yHigh);	//y2-, y2+, y3-, y3+
+					_mm_storeu_ps(out,      _mm_unpacklo_ps(xPair, first));
+					_mm_storeu_ps(out + 4,  _mm_unpackhi_ps(xPair, first));
+					_mm_storeu_ps(out + 8,  _mm_unpacklo_ps(xPair, second));
+					_mm_storeu_ps(out + 12, _mm_unpackhi_ps(xPair, second));
+					out += 16;
+				}
+				else {
+					_mm_storeu_ps(out,     _mm_unpacklo_ps(xLow, yLow));
+					_mm_storeu_ps(out + 4, _mm_unpackhi_ps(xLow, yLow));
+					out += 8;
+				}
+			}
+#endif
+			for (; j <= lastColumn; j++) {
+				const GLfloat yCoordinate = (float)j / (float)y;
+				*out++ = xCoordinate - 0.5f;
+				*out++ = yCoordinate - 0.5f;
+				if (textureCoords) {
+					*out++ = xCoordinate + 0.5f;
+					*out++ = yCoordinate + 0.5f;
+				}
+			}
+		}
+	}
+
+	/**
+	* @brief Fills the 16 bit indices of one tile, same winding as UnitGridTopologyTriangles
+	*
+	* @param tile - Tile with its size set
+	*/
+	inline void GridTileTopology(GridTile& tile) {
+		const std::size_t Y = tile.columns;
+		tile.indices.resize(tile.rows * Y * 3 * 2);
+		GLushort* out = tile.indices.data();
+		for (std::size_t i = 0; i < tile.rows; i++) {
+			const GLushort bottom = static_cast<GLushort>((Y + 1) * i);
+			const GLushort top = static_cast<GLushort>((Y + 1) * (i + 1));
+			for (std::size_t j = 0; j < Y; j++) {
+				const GLushort column = static_cast<GLushort>(j);
+				out[0] = bottom + column;			//Bottom left vertex
+				out[1] = top + column;				//Top left vertex
+				out[2] = top + column + 1;			//Top right vertex
+				out[3] = bottom + column;			//Bottom left vertex
+				out[4] = bottom + column + 1;		//Bottom right vertex
+				out[5] = top + column + 1;			//Top right vertex
+				out += 6;
+			}
+		}
+	}
+
+	/**
+	* @brief Creates a grid of given size split into tiles of at most 65536 vertices.
+	*        The tiles are generated in parallel and each can be drawn on its own.
+	*
+	* @param x - Number of rows for the grid
+	* @param y - Number of columns for the grid
+	* @param textureCoords - Whether to add texture coordinates like UnitGridGeometry2DWTCoords
+	* @param threadCount - Number of threads, 0 uses all hardware threads
+	* @return tiles - The tiles covering the grid, row by row
+	*/
+	template <typename T, typename U>
+	std::vector<GridTile> UnitGridTiles(T x, U y, bool textureCoords = true, unsigned threadCount = 0) {
+		const std::size_t rows = static_cast<std::size_t>(x), columns = static_cast<std::size_t>(y);
+		const std::size_t tileRows = (rows + MaxTileSquares - 1) / MaxTileSquares;
+		const std::size_t tileColumns = (columns + MaxTileSquares - 1) / MaxTileSquares;
+
+		std::vector<GridTile> tiles(tileRows * tileColumns);
+		for (std::size_t r = 0; r < tileRows; r++) {
+			for (std::size_t c = 0; c < tileColumns; c++) {
+				GridTile& tile = tiles[r * tileColumns + c];
+				tile.firstRow = r * MaxTileSquares;
+				tile.firstColumn = c * MaxTileSquares;
+				tile.rows = std::min(MaxTileSquares, rows - tile.firstRow);
+				tile.columns = std::min(MaxTileSquares, columns - tile.firstColumn);
+			}
+		}
+
+		//Every worker takes the next unfinished tile until all are done
+		std::atomic<std::size_t> nextTile{ 0 };
+		auto worker = [&]() {
+			for (std::size_t t = nextTile++; t < tiles.size(); t = nextTile++) {
+				GridTileGeometry(tiles[t], rows, columns, textureCoords);
+				GridTileTopology(tiles[t]);
+			}
+		};
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, tiles.size()));
+
+		std::vector<std::thread> threads;
+		for (unsigned i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+		return tiles;
+	}
+
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+/**
+* @file MeshData.cpp
+*
+* @brief Conversion of MeshData to and from vertex arrays and mesh files
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MeshData.h"
+#include "MeshFile.h"
+
+/**
+* @brief Copies a loaded mesh file, only meshes with float attributes can be used
+*
+* @param meshFile - The mapped mesh file to copy
+*/
+MeshData::MeshData(const MeshFile& meshFile)
+{
+	if (!meshFile.IsLoaded())
+		return;
+	Layout = meshFile.GetLayout();
+	const auto* vertices = static_cast<const float*>(meshFile.GetVertexData());
+	Vertices.assign(vertices, vertices + meshFile.GetVertexDataSize() / sizeof(float));
+	Indices.assign(meshFile.GetIndexData(), meshFile.GetIndexData() + meshFile.GetIndexCount());
+}
+
+/**
+* @brief Creates the buffers and the vertex array containing the mesh
+*
+* @return vertexArray - The vertex array with the vertex and index buffer set
+*/
+std::shared_ptr<VertexArray> MeshData::CreateVertexArray() const
+{
+	auto vertexArray = std::make_shared<VertexArray>();
+	auto vertexBuffer = std::make_shared<VertexBuffer>(Vertices.data(),
+		static_cast<GLuint>(Vertices.size() * sizeof(float)));
+	vertexBuffer->SetLayout(Layout);
+	vertexArray->AddVertexBuffer(vertexBuffer, Layout);
+	vertexArray->SetIndexBuffer(std::make_shared<IndexBuffer>(
+		static_cast<const void*>(Indices.data()), static_cast<GLsizei>(Indices.size())));
+	vertexArray->Unbind();
+	return vertexArray;
+}
+
+/**
+* @brief Writes the mesh into a mesh file
+*
+* @param filePath - Where to write the mesh
+* @return bool - Whether the file could be written or not
+*/
+bool MeshData::Write(const std::string& filePath) const
+{
+	return MeshFile::Write(filePath, Layout, Vertices.data(), Vertices.size() * sizeof(float),
+		Indices.data(), Indices.size());
+}
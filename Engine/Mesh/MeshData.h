@@ -0,0 +1,42 @@
+/**
+* @file MeshData.h
+*
+* @brief Interleaved mesh kept on the CPU, so it can be processed (simplified,
+*        written to a mesh file) before it is uploaded to the GPU.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MESHDATA_H_
+#define MESHDATA_H_
+
+#include <glad/glad.h>
+#include <VertexArray.h>
+#include <VertexBufferLayout.h>
+
+#include <memory>
+#include <vector>
+
+class MeshFile;
+
+struct MeshData
+{
+	MeshData() = default;
+	explicit MeshData(const MeshFile& meshFile);
+
+	BufferLayout Layout;
+	std::vector<float> Vertices;	// Interleaved as described by Layout
+	std::vector<GLuint> Indices;	// Triangles
+
+	inline std::size_t GetFloatsPerVertex() const { return Layout.GetStride() / sizeof(float); }
+	inline std::size_t GetVertexCount() const
+			{ return Layout.GetStride() ? Vertices.size() / GetFloatsPerVertex() : 0; }
+	inline std::size_t GetTriangleCount() const { return Indices.size() / 3; }
+
+	// Uploads the mesh into a new vertex array
+	std::shared_ptr<VertexArray> CreateVertexArray() const;
+	// Writes the mesh into the binary mesh format
+	bool Write(const std::string& filePath) const;
+};
+
+#endif // MESHDATA_H_
@@ -0,0 +1,207 @@
+/**
+* @file MeshFile.cpp
+*
+* @brief Loading and writing of the binary mesh format described in MeshFile.h
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MeshFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace {
+	constexpr char MeshMagic[4] = { 'M', 'E', 'S', 'H' };
+
+	//Rounds offset up to the next multiple of MeshFile::Alignment
+	std::uint64_t AlignOffset(std::uint64_t offset)
+	{
+		return (offset + MeshFile::Alignment - 1) & ~(MeshFile::Alignment - 1);
+	}
+}
+
+/**
+* @brief Maps a mesh file and checks that the header and blobs are consistent
+*
+* @param filePath - Path to the .mesh file
+* @return bool - Whether the file was a valid mesh file or not
+*/
+bool MeshFile::Load(const std::string& filePath)
+{
+	Close();
+	if (!File.Open(filePath))
+		return false;
+
+	const auto size = File.GetSize();
+	const auto* header = reinterpret_cast<const MeshFileHeader*>(File.GetData());
+	if (size < sizeof(MeshFileHeader) || std::memcmp(header->Magic, MeshMagic, 4) != 0) {
+		std::cout << filePath << " is not a mesh file\n";
+		File.Close();
+		return false;
+	}
+	if (header->Version != Version || header->IndexType != GL_UNSIGNED_INT) {
+		std::cout << filePath << " has unsupported mesh version " << header->Version << "\n";
+		File.Close();
+		return false;
+	}
+	//Every section has to lie within the file and the blobs have to be aligned, the sizes are
+	//compared with the room left after the offsets so huge values can not wrap around
+	const std::uint64_t attributesEnd = sizeof(MeshFileHeader) +
+		std::uint64_t(header->AttributeCount) * sizeof(MeshFileAttribute);
+	if (attributesEnd > size || header->VertexOffset % Alignment || header->IndexOffset % Alignment ||
+		header->VertexOffset > size || header->VertexSize > size - header->VertexOffset ||
+		header->IndexOffset > size || header->IndexCount > (size - header->IndexOffset) / sizeof(GLuint)) {
+		std::cout << filePath << " is truncated or corrupt\n";
+		File.Close();
+		return false;
+	}
+
+	std::vector<BufferAttribute> attributes;
+	const auto* fileAttributes = reinterpret_cast<const MeshFileAttribute*>(header + 1);
+	for (std::uint32_t i = 0; i < header->AttributeCount; i++) {
+		const auto& attribute = fileAttributes[i];
+		if (attribute.Type <= static_cast<std::uint32_t>(ShaderDataType::None) ||
+			attribute.Type > static_cast<std::uint32_t>(ShaderDataType::Bool)) {
+			std::cout << filePath << " has an attribute of unknown type\n";
+			File.Close();
+			return false;
+		}
+		const char* end = std::find(attribute.Name, attribute.Name + sizeof(attribute.Name), '\0');
+		attributes.emplace_back(static_cast<ShaderDataType>(attribute.Type),
+			std::string(attribute.Name, end), attribute.Normalized != 0);
+	}
+	Layout = BufferLayout(attributes);
+	//The attributes are packed the way Write() lays them out, the vertex blob holds whole vertices and
+	//its size has to fit the GLuint the buffers are created with
+	bool offsetsMatch = true;
+	for (std::uint32_t i = 0; i < header->AttributeCount; i++)
+		offsetsMatch &= Layout.GetAttributes()[i].Offset == fileAttributes[i].Offset;
+	if (Layout.GetStride() == 0 || Layout.GetStride() != static_cast<GLsizei>(header->Stride) || !offsetsMatch ||
+		header->VertexSize % header->Stride != 0 || header->VertexSize > std::numeric_limits<GLuint>::max() ||
+		header->IndexCount > static_cast<std::uint64_t>(std::numeric_limits<GLsizei>::max())) {
+		std::cout << filePath << " has a layout that does not match its stride or its vertex data\n";
+		File.Close();
+		return false;
+	}
+
+	Header = header;
+	return true;
+}
+
+/**
+* @brief Unmaps the mesh file
+*/
+void MeshFile::Close()
+{
+	Header = nullptr;
+	Layout = BufferLayout();
+	File.Close();
+}
+
+/**
+* @brief Creates a vertex array whose buffers are filled directly from the mapping
+*
+* @return vertexArray - The vertex array, or nullptr if no mesh is loaded
+*/
+std::shared_ptr<VertexArray> MeshFile::CreateVertexArray() const
+{
+	if (!IsLoaded())
+		return nullptr;
+
+	auto vertexArray = std::make_shared<VertexArray>();
+	auto vertexBuffer = std::make_shared<VertexBuffer>(GetVertexData(), GetVertexDataSize());
+	vertexBuffer->SetLayout(Layout);
+	vertexArray->AddVertexBuffer(vertexBuffer, Layout);
+	vertexArray->SetIndexBuffer(std::make_shared<IndexBuffer>(
+		static_cast<const void*>(GetIndexData()), GetIndexCount()));
+	vertexArray->Unbind();
+	return vertexArray;
+}
+
+/**
+* @brief Writes a mesh into the binary mesh format
+*
+* @param filePath - Where to write the mesh
+* @param layout - Layout of the interleaved vertices
+* @param vertices - The interleaved vertices
+* @param vertexSize - Size of the vertices in bytes
+* @param indices - Indices that connect the vertices in triangles
+* @param indexCount - Number of indices
+* @return bool - Whether the file could be written or not
+*/
+bool MeshFile::Write(const std::string& filePath, const BufferLayout& layout,
+	const void* vertices, std::size_t vertexSize, const GLuint* indices, std::size_t indexCount)
+{
+	const auto& attributes = layout.GetAttributes();
+	if (attributes.empty() || layout.GetStride() == 0 || vertexSize % layout.GetStride() != 0) {
+		std::cout << "Can not write " << filePath << ", vertex data does not match the layout\n";
+		return false;
+	}
+
+	MeshFileHeader header = {};
+	std::memcpy(header.Magic, MeshMagic, 4);
+	header.Version = Version;
+	header.AttributeCount = static_cast<std::uint32_t>(attributes.size());
+	header.Stride = static_cast<std::uint32_t>(layout.GetStride());
+	header.VertexOffset = AlignOffset(sizeof(MeshFileHeader) + attributes.size() * sizeof(MeshFileAttribute));
+	header.VertexSize = vertexSize;
+	header.IndexOffset = AlignOffset(header.VertexOffset + vertexSize);
+	header.IndexCount = indexCount;
+	header.IndexType = GL_UNSIGNED_INT;
+
+	//Bounding box of the first attribute, which is the position by convention
+	const auto& position = attributes[0];
+	const int components = std::min(3, static_cast<int>(ShaderDataTypeComponentCount(position.Type)));
+	const std::size_t vertexCount = vertexSize / layout.GetStride();
+	for (int c = 0; c < 3; c++) {
+		header.BoundsMin[c] = vertexCount > 0 && c < components ? std::numeric_limits<float>::max() : 0.0f;
+		header.BoundsMax[c] = vertexCount > 0 && c < components ? std::numeric_limits<float>::lowest() : 0.0f;
+	}
+	if (ShaderDataTypeToOpenGLBaseType(position.Type) == GL_FLOAT) {
+		const auto* bytes = static_cast<const unsigned char*>(vertices);
+		for (std::size_t v = 0; v < vertexCount; v++) {
+			float value[3];
+			std::memcpy(value, bytes + v * layout.GetStride() + position.Offset, components * sizeof(float));
+			for (int c = 0; c < components; c++) {
+				header.BoundsMin[c] = std::min(header.BoundsMin[c], value[c]);
+				header.BoundsMax[c] = std::max(header.BoundsMax[c], value[c]);
+			}
+		}
+	}
+
+	std::ofstream stream(filePath, std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		std::cout << "Could not open " << filePath << " for writing\n";
+		return false;
+	}
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const auto& attribute : attributes) {
+		MeshFileAttribute fileAttribute = {};
+		fileAttribute.Type = static_cast<std::uint32_t>(attribute.Type);
+		fileAttribute.Offset = attribute.Offset;
+		fileAttribute.Normalized = attribute.Normalized ? 1 : 0;
+		std::strncpy(fileAttribute.Name, attribute.Name.c_str(), sizeof(fileAttribute.Name) - 1);
+		stream.write(reinterpret_cast<const char*>(&fileAttribute), sizeof(fileAttribute));
+	}
+
+	//Zero padding up to the aligned start of each blob
+	const char padding[Alignment] = {};
+	auto pad = [&](std::uint64_t offset) {
+		stream.write(padding, static_cast<std::streamsize>(offset - static_cast<std::uint64_t>(stream.tellp())));
+	};
+	pad(header.VertexOffset);
+	stream.write(static_cast<const char*>(vertices), static_cast<std::streamsize>(vertexSize));
+	pad(header.IndexOffset);
+	stream.write(reinterpret_cast<const char*>(indices), static_cast<std::streamsize>(indexCount * sizeof(GLuint)));
+
+	if (!stream) {
+		std::cout << "Failed to write " << filePath << "\n";
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,91 @@
+/**
+* @file MeshFile.h
+*
+* @brief Versioned binary mesh container that is memory mapped when loaded.
+*
+* File layout (little endian):
+*   MeshFileHeader
+*   MeshFileAttribute[AttributeCount]   - the BufferLayout of the vertices
+*   vertex blob at VertexOffset         - interleaved, Stride bytes per vertex
+*   index blob at IndexOffset           - IndexCount GLuint indices
+* Both blobs start on a MeshFile::Alignment boundary, so the mapped pointers
+* can be handed to VertexBuffer/IndexBuffer without copying them first.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MESHFILE_H_
+#define MESHFILE_H_
+
+#include <glad/glad.h>
+#include <MappedFile.h>
+#include <VertexArray.h>
+#include <VertexBufferLayout.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct MeshFileHeader
+{
+	char Magic[4];              // "MESH"
+	std::uint32_t Version;
+	std::uint32_t AttributeCount;
+	std::uint32_t Stride;       // bytes per vertex
+	std::uint64_t VertexOffset; // from the start of the file
+	std::uint64_t VertexSize;   // in bytes
+	std::uint64_t IndexOffset;  // from the start of the file
+	std::uint64_t IndexCount;
+	std::uint32_t IndexType;    // GL_UNSIGNED_INT
+	std::uint32_t Reserved;
+	float BoundsMin[3];         // bounding box of the first attribute
+	float BoundsMax[3];
+};
+static_assert(sizeof(MeshFileHeader) == 80, "MeshFileHeader must not be padded");
+
+struct MeshFileAttribute
+{
+	std::uint32_t Type;         // ShaderDataType
+	std::uint32_t Offset;       // within the vertex
+	std::uint32_t Normalized;
+	char Name[52];              // null terminated
+};
+static_assert(sizeof(MeshFileAttribute) == 64, "MeshFileAttribute must not be padded");
+
+class MeshFile
+{
+public:
+	static constexpr std::uint32_t Version = 1;
+	static constexpr std::uint64_t Alignment = 64;
+
+public:
+	MeshFile() = default;
+	~MeshFile() = default;
+
+	// Maps the file and validates the header, the data stays mapped until Close()
+	bool Load(const std::string& filePath);
+	void Close();
+
+	// Uploads the mapped blobs straight into a new vertex array
+	std::shared_ptr<VertexArray> CreateVertexArray() const;
+
+	inline bool IsLoaded() const { return Header != nullptr; }
+	inline const BufferLayout& GetLayout() const { return Layout; }
+	inline const void* GetVertexData() const { return File.GetData() + Header->VertexOffset; }
+	inline GLuint GetVertexDataSize() const { return static_cast<GLuint>(Header->VertexSize); }
+	inline const GLuint* GetIndexData() const
+			{ return reinterpret_cast<const GLuint*>(File.GetData() + Header->IndexOffset); }
+	inline GLsizei GetIndexCount() const { return static_cast<GLsizei>(Header->IndexCount); }
+	inline const MeshFileHeader& GetHeader() const { return *Header; }
+
+	// Writes interleaved vertices and their indices into a mesh file
+	static bool Write(const std::string& filePath, const BufferLayout& layout,
+		const void* vertices, std::size_t vertexSize, const GLuint* indices, std::size_t indexCount);
+
+private:
+	MappedFile File;
+	BufferLayout Layout;
+	const MeshFileHeader* Header = nullptr;
+};
+
+#endif // MESHFILE_H_
@@ -0,0 +1,1047 @@
+/**
+* @file MeshImporter.cpp
+*
+* @brief Parallel OBJ and glTF 2.0 binary importers with vertex welding
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MeshImporter.h"
+#include "MeshFile.h"
+
+#include <MappedFile.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <utility>
+
+namespace {
+
+	// =========================================================================
+	// Helpers shared by the importers
+	// =========================================================================
+
+	unsigned ThreadCount(unsigned requested)
+	{
+		return requested != 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	//Runs function(i) for i in [0, count) on threadCount threads
+	template <typename Function>
+	void ParallelFor(std::size_t count, unsigned threadCount, const Function& function)
+	{
+		std::atomic<std::size_t> next{ 0 };
+		auto worker = [&]() {
+			for (std::size_t i = next++; i < count; i = next++)
+				function(i);
+		};
+		threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, count));
+		std::vector<std::thread> threads;
+		for (unsigned t = 1; t < threadCount; t++)
+			threads.emplace_back(worker);
+		worker();
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	BufferLayout MakeLayout(bool texCoords, bool normals)
+	{
+		std::vector<BufferAttribute> attributes = { { ShaderDataType::Float3, "position" } };
+		if (texCoords)
+			attributes.emplace_back(ShaderDataType::Float2, "texCoords");
+		if (normals)
+			attributes.emplace_back(ShaderDataType::Float3, "normal");
+		return BufferLayout(attributes);
+	}
+
+	inline std::uint64_t HashCombine(std::uint64_t hash, std::uint64_t value)
+	{
+		hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+		return hash * 0xFF51AFD7ED558CCDull;
+	}
+
+	/**
+	* @brief Open addressing hash map from a key to a vertex index, used for welding.
+	*        KeyOps provides Hash(key) and Equal(key, index) so keys need not be stored.
+	*/
+	template <typename Key, typename KeyOps>
+	class WeldMap {
+	public:
+		explicit WeldMap(const KeyOps& ops, std::size_t expected) : Ops(ops)
+		{
+			std::size_t capacity = 16;
+			while (capacity < expected * 2)
+				capacity <<= 1;
+			Slots.assign(capacity, Empty);
+		}
+
+		//Returns the index stored for the key, or inserts newIndex and returns it
+		std::uint32_t FindOrInsert(const Key& key, std::uint32_t newIndex)
+		{
+			if ((Count + 1) * 10 > Slots.size() * 7)
+				Grow();
+			const std::size_t mask = Slots.size() - 1;
+			for (std::size_t slot = Ops.Hash(key) & mask;; slot = (slot + 1) & mask) {
+				if (Slots[slot] == Empty) {
+					Slots[slot] = newIndex;
+					Count++;
+					return newIndex;
+				}
+				if (Ops.Equal(key, Slots[slot]))
+					return Slots[slot];
+			}
+		}
+
+	private:
+		void Grow()
+		{
+			std::vector<std::uint32_t> old(Slots.size() * 2, Empty);
+			old.swap(Slots);
+			const std::size_t mask = Slots.size() - 1;
+			for (auto index : old) {
+				if (index == Empty)
+					continue;
+				std::size_t slot = Ops.HashIndex(index) & mask;
+				while (Slots[slot] != Empty)
+					slot = (slot + 1) & mask;
+				Slots[slot] = index;
+			}
+		}
+
+		static constexpr std::uint32_t Empty = std::numeric_limits<std::uint32_t>::max();
+		const KeyOps& Ops;
+		std::vector<std::uint32_t> Slots;
+		std::size_t Count = 0;
+	};
+
+	// =========================================================================
+	// Wavefront OBJ
+	// =========================================================================
+
+	constexpr std::int64_t NoIndex = std::numeric_limits<std::int64_t>::max();
+	constexpr std::int64_t RelativeBase = -(std::int64_t(1) << 62);
+
+	//Index of a v, vt or vn line. Positive values are global and 0-based, indices that
+	//were relative in the file hold RelativeBase + index counted from the chunk start,
+	//which is negative when they refer back into a previous chunk
+	struct ObjCorner {
+		std::int64_t position, texCoord, normal;
+	};
+
+	struct ObjChunk {
+		const char* begin;
+		const char* end;
+		std::vector<float> positions;	// 3 per v
+		std::vector<float> texCoords;	// 2 per vt
+		std::vector<float> normals;		// 3 per vn
+		std::vector<ObjCorner> corners;	// 3 per triangle
+		std::size_t failedLine = 0;		// Offset + 1 of a malformed line
+	};
+
+	inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	inline const char* SkipBlanks(const char* p, const char* end)
+	{
+		while (p < end && IsBlank(*p))
+			p++;
+		return p;
+	}
+
+	inline const char* SkipLine(const char* p, const char* end)
+	{
+		const void* newline = std::memchr(p, '\n', end - p);
+		return newline ? static_cast<const char*>(newline) + 1 : end;
+	}
+
+	/**
+	* @brief Parses a decimal float, locale independent and without allocations
+	*
+	* @return end - Pointer past the number, nullptr if there was no number
+	*/
+	const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		static const double Powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+			1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		p = SkipBlanks(p, end);
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+			negative = *p++ == '-';
+
+		std::uint64_t mantissa = 0;
+		int exponent = 0, digits = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+			if (mantissa < 1000000000000000000ull)
+				mantissa = mantissa * 10 + (*p - '0');
+			else
+				exponent++;
+		}
+		if (p < end && *p == '.') {
+			for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+				if (mantissa < 1000000000000000000ull) {
+					mantissa = mantissa * 10 + (*p - '0');
+					exponent--;
+				}
+			}
+		}
+		if (digits == 0)
+			return nullptr;
+		if (p < end && (*p == 'e' || *p == 'E')) {
+			const char* q = p + 1;
+			bool negativeExponent = false;
+			if (q < end && (*q == '-' || *q == '+'))
+				negativeExponent = *q++ == '-';
+			int written = 0, e = 0;
+			for (; q < end && *q >= '0' && *q <= '9'; q++, written++)
+				e = std::min(e * 10 + (*q - '0'), 10000);
+			if (written > 0) {
+				exponent += negativeExponent ? -e : e;
+				p = q;
+			}
+		}
+
+		double result = static_cast<double>(mantissa);
+		if (exponent >= -22 && exponent <= 22)
+			result = exponent < 0 ? result / Powers[-exponent] : result * Powers[exponent];
+		else
+			result *= std::pow(10.0, exponent);
+		value = static_cast<float>(negative ? -result : result);
+		return p;
+	}
+
+	//Largest OBJ index, below -RelativeBase so resolved relative indices can not wrap around
+	constexpr std::int64_t MaxObjIndex = -RelativeBase - 1;
+
+	//Parses an OBJ index, 0 means there was none. Returns nullptr for an index above MaxObjIndex
+	inline const char* ParseIndex(const char* p, const char* end, std::int64_t& value)
+	{
+		bool negative = false;
+		if (p < end && *p == '-') {
+			negative = true;
+			p++;
+		}
+		std::int64_t result = 0;
+		const char* start = p;
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			const int digit = *p - '0';
+			if (result > (MaxObjIndex - digit) / 10)
+				return nullptr;
+			result = result * 10 + digit;
+		}
+		value = p == start ? 0 : (negative ? -result : result);
+		return p;
+	}
+
+	//Converts a 1-based or relative OBJ index into the ObjCorner convention
+	inline std::int64_t ResolveIndex(std::int64_t index, std::size_t localCount)
+	{
+		if (index > 0)
+			return index - 1;
+		if (index < 0)
+			return RelativeBase + static_cast<std::int64_t>(localCount) + index;
+		return NoIndex;
+	}
+
+	void ParseObjChunk(ObjChunk& chunk)
+	{
+		const char* p = chunk.begin;
+		const char* end = chunk.end;
+		std::vector<ObjCorner> polygon;
+
+		while (p < end) {
+			const char* line = p;
+			p = SkipBlanks(p, end);
+			if (p + 1 < end && p[0] == 'v' && IsBlank(p[1])) {
+				float xyz[3];
+				p++;
+				for (auto& component : xyz) {
+					p = ParseFloat(p, end, component);
+					if (!p) break;
+				}
+				if (!p) { chunk.failedLine = line - chunk.begin + 1; return; }
+				chunk.positions.insert(chunk.positions.end(), xyz, xyz + 3);
+			}
+			else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && IsBlank(p[2])) {
+				float uv[2] = { 0.0f, 0.0f };
+				p = ParseFloat(p + 2, end, uv[0]);
+				if (!p) { chunk.failedLine = line - chunk.begin + 1; return; }
+				//The second coordinate is optional for 1D textures
+				const char* second = ParseFloat(p, end, uv[1]);
+				p = second ? second : p;
+				chunk.texCoords.insert(chunk.texCoords.end(), uv, uv + 2);
+			}
+			else if (p + 2 < end && p[0] == 'v' && p[1] == 'n' && IsBlank(p[2])) {
+				float xyz[3];
+				p += 2;
+				for (auto& component : xyz) {
+					p = ParseFloat(p, end, component);
+					if (!p) break;
+				}
+				if (!p) { chunk.failedLine = line - chunk.begin + 1; return; }
+				chunk.normals.insert(chunk.normals.end(), xyz, xyz + 3);
+			}
+			else if (p + 1 < end && p[0] == 'f' && IsBlank(p[1])) {
+				polygon.clear();
+				p++;
+				while (true) {
+					p = SkipBlanks(p, end);
+					if (p >= end || *p == '\n' || *p == '#')
+						break;
+					std::int64_t v = 0, vt = 0, vn = 0;
+					p = ParseIndex(p, end, v);
+					if (p && p < end && *p == '/') {
+						p = ParseIndex(p + 1, end, vt);
+						if (p && p < end && *p == '/')
+							p = ParseIndex(p + 1, end, vn);
+					}
+					if (!p || v == 0 || (p < end && !IsBlank(*p) && *p != '\n')) {
+						chunk.failedLine = line - chunk.begin + 1;
+						return;
+					}
+					polygon.push_back({ ResolveIndex(v, chunk.positions.size() / 3),
+										ResolveIndex(vt, chunk.texCoords.size() / 2),
+										ResolveIndex(vn, chunk.normals.size() / 3) });
+				}
+				//Triangle fan around the first corner
+				for (std::size_t i = 2; i < polygon.size(); i++) {
+					chunk.corners.push_back(polygon[0]);
+					chunk.corners.push_back(polygon[i - 1]);
+					chunk.corners.push_back(polygon[i]);
+				}
+			}
+			p = SkipLine(p, end);
+		}
+	}
+
+	struct ObjKey {
+		std::int64_t position, texCoord, normal;
+	};
+
+	struct ObjKeyOps {
+		const std::vector<ObjKey>& Keys;	// Key of every welded vertex
+
+		std::uint64_t Hash(const ObjKey& key) const
+		{
+			return HashCombine(HashCombine(HashCombine(0, key.position), key.texCoord), key.normal);
+		}
+		std::uint64_t HashIndex(std::uint32_t index) const { return Hash(Keys[index]); }
+		bool Equal(const ObjKey& key, std::uint32_t index) const
+		{
+			const auto& other = Keys[index];
+			return key.position == other.position && key.texCoord == other.texCoord && key.normal == other.normal;
+		}
+	};
+
+	// =========================================================================
+	// JSON, just enough for the glTF chunk of a .glb
+	// =========================================================================
+
+	constexpr std::size_t NoSize = std::numeric_limits<std::size_t>::max();
+
+	//Converts a JSON number into an index or a count, NoSize when it is negative, fractional or too large
+	inline std::size_t ToSize(double number)
+	{
+		if (!(number >= 0.0) || number >= static_cast<double>(NoSize) || number != std::floor(number))
+			return NoSize;
+		return static_cast<std::size_t>(number);
+	}
+
+	struct JsonValue {
+		enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+		std::vector<JsonValue> array;
+		std::vector<std::pair<std::string, JsonValue>> object;
+
+		const JsonValue* Find(const char* key) const
+		{
+			for (const auto& member : object)
+				if (member.first == key)
+					return &member.second;
+			return nullptr;
+		}
+		double NumberOr(const char* key, double fallback) const
+		{
+			const auto* value = Find(key);
+			return value && value->type == Type::Number ? value->number : fallback;
+		}
+		std::size_t SizeOr(const char* key, std::size_t fallback) const
+		{
+			const auto* value = Find(key);
+			return value && value->type == Type::Number ? ToSize(value->number) : fallback;
+		}
+		const JsonValue* At(std::size_t index) const
+		{
+			return type == Type::Array && index < array.size() ? &array[index] : nullptr;
+		}
+	};
+
+	class JsonParser {
+	public:
+		JsonParser(const char* begin, const char* end) : P(begin), End(end) {}
+
+		bool Parse(JsonValue& value)
+		{
+			return ParseValue(value, 0) && (SkipSpace(), true);
+		}
+
+	private:
+		void SkipSpace()
+		{
+			while (P < End && (*P == ' ' || *P == '\t' || *P == '\n' || *P == '\r'))
+				P++;
+		}
+
+		bool Match(const char* literal)
+		{
+			const std::size_t length = std::strlen(literal);
+			if (static_cast<std::size_t>(End - P) < length || std::memcmp(P, literal, length) != 0)
+				return false;
+			P += length;
+			return true;
+		}
+
+		bool ParseValue(JsonValue& value, int depth)
+		{
+			if (depth > 64)
+				return false;
+			SkipSpace();
+			if (P >= End)
+				return false;
+			switch (*P) {
+			case '{': return ParseObject(value, depth);
+			case '[': return ParseArray(value, depth);
+			case '"': value.type = JsonValue::Type::String; return ParseString(value.string);
+			case 't': value.type = JsonValue::Type::Bool; value.boolean = true; return Match("true");
+			case 'f': value.type = JsonValue::Type::Bool; value.boolean = false; return Match("false");
+			case 'n': value.type = JsonValue::Type::Null; return Match("null");
+			default: return ParseNumber(value);
+			}
+		}
+
+		bool ParseObject(JsonValue& value, int depth)
+		{
+			value.type = JsonValue::Type::Object;
+			P++;
+			SkipSpace();
+			if (P < End && *P == '}') { P++; return true; }
+			while (true) {
+				SkipSpace();
+				std::pair<std::string, JsonValue> member;
+				if (P >= End || *P != '"' || !ParseString(member.first))
+					return false;
+				SkipSpace();
+				if (P >= End || *P++ != ':' || !ParseValue(member.second, depth + 1))
+					return false;
+				value.object.push_back(std::move(member));
+				SkipSpace();
+				if (P < End && *P == ',') { P++; continue; }
+				if (P < End && *P == '}') { P++; return true; }
+				return false;
+			}
+		}
+
+		bool ParseArray(JsonValue& value, int depth)
+		{
+			value.type = JsonValue::Type::Array;
+			P++;
+			SkipSpace();
+			if (P < End && *P == ']') { P++; return true; }
+			while (true) {
+				value.array.emplace_back();
+				if (!ParseValue(value.array.back(), depth + 1))
+					return false;
+				SkipSpace();
+				if (P < End && *P == ',') { P++; continue; }
+				if (P < End && *P == ']') { P++; return true; }
+				return false;
+			}
+		}
+
+		bool ParseString(std::string& string)
+		{
+			P++;
+			while (P < End && *P != '"') {
+				if (*P != '\\') {
+					string.push_back(*P++);
+					continue;
+				}
+				if (++P >= End)
+					return false;
+				switch (*P++) {
+				case '"': string.push_back('"'); break;
+				case '\\': string.push_back('\\'); break;
+				case '/': string.push_back('/'); break;
+				case 'b': string.push_back('\b'); break;
+				case 'f': string.push_back('\f'); break;
+				case 'n': string.push_back('\n'); break;
+				case 'r': string.push_back('\r'); break;
+				case 't': string.push_back('\t'); break;
+				case 'u': {
+					if (End - P < 4)
+						return false;
+					unsigned code = 0;
+					for (int i = 0; i < 4; i++, P++) {
+						const char c = *P;
+						code <<= 4;
+						if (c >= '0' && c <= '9') code |= c - '0';
+						else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+						else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+						else return false;
+					}
+					//Names in glTF files are informative only, surrogate pairs are kept as two code points
+					if (code < 0x80) string.push_back(static_cast<char>(code));
+					else if (code < 0x800) {
+						string.push_back(static_cast<char>(0xC0 | (code >> 6)));
+						string.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+					}
+					else {
+						string.push_back(static_cast<char>(0xE0 | (code >> 12)));
+						string.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+						string.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+					}
+					break;
+				}
+				default: return false;
+				}
+			}
+			if (P >= End)
+				return false;
+			P++;
+			return true;
+		}
+
+		bool ParseNumber(JsonValue& value)
+		{
+			value.type = JsonValue::Type::Number;
+			float number;
+			const char* end = ParseFloat(P, End, number);
+			if (!end)
+				return false;
+			//Integers (counts, offsets) need more precision than a float has
+			bool integer = true;
+			for (const char* c = P; c < end; c++)
+				if (*c == '.' || *c == 'e' || *c == 'E')
+					integer = false;
+			value.number = number;
+			if (integer) {
+				//Literals too long for 64 bits keep the float value, which is no valid count or offset anyway
+				std::int64_t whole = 0;
+				const char* c = P;
+				const bool negative = *c == '-';
+				if (negative || *c == '+') c++;
+				for (; c < end; c++) {
+					const int digit = *c - '0';
+					if (whole > (std::numeric_limits<std::int64_t>::max() - digit) / 10)
+						break;
+					whole = whole * 10 + digit;
+				}
+				if (c == end)
+					value.number = static_cast<double>(negative ? -whole : whole);
+			}
+			P = end;
+			return true;
+		}
+
+		const char* P;
+		const char* End;
+	};
+
+	// =========================================================================
+	// glTF 2.0 binary
+	// =========================================================================
+
+	constexpr std::uint32_t GlbMagic = 0x46546C67;		// "glTF"
+	constexpr std::uint32_t GlbJsonChunk = 0x4E4F534A;	// "JSON"
+	constexpr std::uint32_t GlbBinChunk = 0x004E4942;	// "BIN\0"
+
+	//Column major 4x4 transform of a node
+	using Matrix = std::array<double, 16>;
+
+	constexpr Matrix Identity = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+	Matrix Multiply(const Matrix& a, const Matrix& b)
+	{
+		Matrix result{};
+		for (int column = 0; column < 4; column++)
+			for (int row = 0; row < 4; row++)
+				for (int k = 0; k < 4; k++)
+					result[column * 4 + row] += a[k * 4 + row] * b[column * 4 + k];
+		return result;
+	}
+
+	Matrix NodeTransform(const JsonValue& node)
+	{
+		Matrix matrix = Identity;
+		if (const auto* values = node.Find("matrix")) {
+			for (std::size_t i = 0; i < 16 && i < values->array.size(); i++)
+				matrix[i] = values->array[i].number;
+			return matrix;
+		}
+		double t[3] = { 0, 0, 0 }, r[4] = { 0, 0, 0, 1 }, s[3] = { 1, 1, 1 };
+		if (const auto* values = node.Find("translation"))
+			for (std::size_t i = 0; i < 3 && i < values->array.size(); i++) t[i] = values->array[i].number;
+		if (const auto* values = node.Find("rotation"))
+			for (std::size_t i = 0; i < 4 && i < values->array.size(); i++) r[i] = values->array[i].number;
+		if (const auto* values = node.Find("scale"))
+			for (std::size_t i = 0; i < 3 && i < values->array.size(); i++) s[i] = values->array[i].number;
+
+		const double x = r[0], y = r[1], z = r[2], w = r[3];
+		const double rotation[9] = {
+			1 - 2 * (y * y + z * z), 2 * (x * y + z * w),     2 * (x * z - y * w),
+			2 * (x * y - z * w),     1 - 2 * (x * x + z * z), 2 * (y * z + x * w),
+			2 * (x * z + y * w),     2 * (y * z - x * w),     1 - 2 * (x * x + y * y) };
+		for (int column = 0; column < 3; column++)
+			for (int row = 0; row < 3; row++)
+				matrix[column * 4 + row] = rotation[column * 3 + row] * s[column];
+		matrix[12] = t[0]; matrix[13] = t[1]; matrix[14] = t[2];
+		return matrix;
+	}
+
+	struct GlbPrimitive {
+		const JsonValue* primitive;
+		Matrix transform;
+		std::vector<float> vertices;		// Interleaved in the final layout
+		std::vector<std::uint32_t> indices;
+		bool failed = false;
+	};
+
+	class GlbDocument {
+	public:
+		GlbDocument(const JsonValue& json, const unsigned char* bin, std::size_t binSize)
+			: Json(json), Bin(bin), BinSize(binSize) {}
+
+		//Reads components floats per element of an accessor, normalizing integer types
+		bool ReadFloats(std::size_t accessorIndex, int components, std::vector<float>& out) const
+		{
+			const unsigned char* data;
+			std::size_t count, stride;
+			int componentType;
+			if (!Locate(accessorIndex, components, data, count, stride, componentType))
+				return false;
+			out.resize(count * components);
+			for (std::size_t i = 0; i < count; i++) {
+				const unsigned char* element = data + i * stride;
+				for (int c = 0; c < components; c++) {
+					float& value = out[i * components + c];
+					switch (componentType) {
+					case 5126: std::memcpy(&value, element + c * 4, 4); break;
+					case 5121: value = element[c] / 255.0f; break;
+					case 5123: { std::uint16_t v; std::memcpy(&v, element + c * 2, 2); value = v / 65535.0f; break; }
+					default: return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		bool ReadIndices(std::size_t accessorIndex, std::vector<std::uint32_t>& out) const
+		{
+			const unsigned char* data;
+			std::size_t count, stride;
+			int componentType;
+			if (!Locate(accessorIndex, 1, data, count, stride, componentType))
+				return false;
+			out.resize(count);
+			for (std::size_t i = 0; i < count; i++) {
+				const unsigned char* element = data + i * stride;
+				switch (componentType) {
+				case 5121: out[i] = element[0]; break;
+				case 5123: { std::uint16_t v; std::memcpy(&v, element, 2); out[i] = v; break; }
+				case 5125: std::memcpy(&out[i], element, 4); break;
+				default: return false;
+				}
+			}
+			return true;
+		}
+
+		std::size_t AccessorCount(std::size_t accessorIndex) const
+		{
+			const auto* accessors = Json.Find("accessors");
+			const auto* accessor = accessors ? accessors->At(accessorIndex) : nullptr;
+			const std::size_t count = accessor ? accessor->SizeOr("count", 0) : 0;
+			return count == NoSize ? 0 : count;
+		}
+
+	private:
+		static int ComponentSize(int componentType)
+		{
+			switch (componentType) {
+			case 5120: case 5121: return 1;
+			case 5122: case 5123: return 2;
+			case 5125: case 5126: return 4;
+			default: return 0;
+			}
+		}
+
+		bool Locate(std::size_t accessorIndex, int components, const unsigned char*& data,
+					std::size_t& count, std::size_t& stride, int& componentType) const
+		{
+			const auto* accessors = Json.Find("accessors");
+			const auto* accessor = accessors ? accessors->At(accessorIndex) : nullptr;
+			if (!accessor || accessor->Find("sparse"))
+				return false;
+			const auto* views = Json.Find("bufferViews");
+			const auto* view = views ? views->At(accessor->SizeOr("bufferView", NoSize)) : nullptr;
+			if (!view || view->NumberOr("buffer", 0) != 0)
+				return false;	//Only the BIN chunk of the .glb is supported
+
+			componentType = static_cast<int>(accessor->NumberOr("componentType", 0));
+			count = accessor->SizeOr("count", 0);
+			const std::size_t elementSize = ComponentSize(componentType) * components;
+			stride = view->SizeOr("byteStride", 0);
+			if (stride == 0)
+				stride = elementSize;
+			const std::size_t viewOffset = view->SizeOr("byteOffset", 0);
+			const std::size_t viewLength = view->SizeOr("byteLength", 0);
+			const std::size_t accessorOffset = accessor->SizeOr("byteOffset", 0);
+			if (elementSize == 0 || count == NoSize || stride == NoSize || viewOffset == NoSize ||
+				viewLength == NoSize || accessorOffset == NoSize)
+				return false;
+			//The ranges are compared with the room left in them so huge values can not wrap around
+			if (viewOffset > BinSize || viewLength > BinSize - viewOffset || accessorOffset > viewLength)
+				return false;
+			const std::size_t room = viewLength - accessorOffset;
+			if (count > 0 && (elementSize > room || count - 1 > (room - elementSize) / stride))
+				return false;
+			data = Bin + viewOffset + accessorOffset;
+			return true;
+		}
+
+		const JsonValue& Json;
+		const unsigned char* Bin;
+		std::size_t BinSize;
+	};
+
+	void CollectPrimitives(const JsonValue& json, std::size_t nodeIndex, const Matrix& parent,
+						   std::vector<GlbPrimitive>& primitives, int depth)
+	{
+		const auto* nodes = json.Find("nodes");
+		const auto* node = nodes ? nodes->At(nodeIndex) : nullptr;
+		if (!node || depth > 64)
+			return;
+		const Matrix transform = Multiply(parent, NodeTransform(*node));
+		const auto* meshes = json.Find("meshes");
+		if (const auto* meshIndex = node->Find("mesh")) {
+			const auto* mesh = meshes ? meshes->At(ToSize(meshIndex->number)) : nullptr;
+			const auto* meshPrimitives = mesh ? mesh->Find("primitives") : nullptr;
+			if (meshPrimitives)
+				for (const auto& primitive : meshPrimitives->array)
+					primitives.push_back({ &primitive, transform, {}, {} });
+		}
+		if (const auto* children = node->Find("children"))
+			for (const auto& child : children->array)
+				CollectPrimitives(json, ToSize(child.number), transform, primitives, depth + 1);
+	}
+
+	struct FloatVertexOps {
+		const std::vector<float>& Vertices;
+		const std::size_t FloatsPerVertex;
+
+		std::uint64_t Hash(const float* vertex) const
+		{
+			std::uint64_t hash = 0;
+			for (std::size_t f = 0; f < FloatsPerVertex; f++) {
+				std::uint32_t bits;
+				std::memcpy(&bits, &vertex[f], 4);
+				hash = HashCombine(hash, bits);
+			}
+			return hash;
+		}
+		std::uint64_t HashIndex(std::uint32_t index) const { return Hash(&Vertices[index * FloatsPerVertex]); }
+		bool Equal(const float* vertex, std::uint32_t index) const
+		{
+			return std::memcmp(vertex, &Vertices[index * FloatsPerVertex], FloatsPerVertex * sizeof(float)) == 0;
+		}
+	};
+}
+
+bool MeshImporter::ImportOBJ(const std::string& filePath, MeshData& mesh, unsigned threadCount)
+{
+	MappedFile file;
+	if (!file.Open(filePath))
+		return false;
+	const char* begin = reinterpret_cast<const char*>(file.GetData());
+	const char* end = begin + file.GetSize();
+
+	//Chunks of at least 1 MB that end on a line break
+	constexpr std::size_t MinChunkSize = 1 << 20;
+	threadCount = ThreadCount(threadCount);
+	const std::size_t chunkCount = std::max<std::size_t>(1,
+		std::min<std::size_t>(threadCount * 4, file.GetSize() / MinChunkSize));
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* chunkBegin = begin;
+	for (std::size_t c = 0; c < chunkCount; c++) {
+		const char* chunkEnd = c + 1 == chunkCount ? end : begin + file.GetSize() * (c + 1) / chunkCount;
+		chunkEnd = chunkEnd < chunkBegin ? chunkBegin : SkipLine(chunkEnd, end);
+		chunks[c].begin = chunkBegin;
+		chunks[c].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+	ParallelFor(chunks.size(), threadCount, [&](std::size_t c) { ParseObjChunk(chunks[c]); });
+
+	std::size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (const auto& chunk : chunks) {
+		if (chunk.failedLine) {
+			const auto offset = chunk.begin - begin + chunk.failedLine - 1;
+			std::cout << filePath << ": malformed line at byte " << offset << "\n";
+			return false;
+		}
+		positionCount += chunk.positions.size() / 3;
+		texCoordCount += chunk.texCoords.size() / 2;
+		normalCount += chunk.normals.size() / 3;
+		cornerCount += chunk.corners.size();
+	}
+
+	//Resolve the corners to global indices using the counts of the preceding chunks
+	std::vector<float> positions, texCoords, normals;
+	positions.reserve(positionCount * 3);
+	texCoords.reserve(texCoordCount * 2);
+	normals.reserve(normalCount * 3);
+	std::vector<ObjKey> corners;
+	corners.reserve(cornerCount);
+	bool hasTexCoords = false, hasNormals = false;
+	for (const auto& chunk : chunks) {
+		const auto resolve = [](std::int64_t index, std::size_t offset) {
+			return index == NoIndex || index >= 0 ? index : static_cast<std::int64_t>(offset) + (index - RelativeBase);
+		};
+		const std::size_t positionOffset = positions.size() / 3;
+		const std::size_t texCoordOffset = texCoords.size() / 2;
+		const std::size_t normalOffset = normals.size() / 3;
+		for (const auto& corner : chunk.corners) {
+			ObjKey key = { resolve(corner.position, positionOffset),
+						   resolve(corner.texCoord, texCoordOffset),
+						   resolve(corner.normal, normalOffset) };
+			hasTexCoords |= key.texCoord != NoIndex;
+			hasNormals |= key.normal != NoIndex;
+			corners.push_back(key);
+		}
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+	}
+	chunks.clear();
+
+	mesh = MeshData();
+	mesh.Layout = MakeLayout(hasTexCoords, hasNormals);
+	std::vector<ObjKey> keys;
+	ObjKeyOps ops{ keys };
+	WeldMap<ObjKey, ObjKeyOps> weld(ops, cornerCount / 4);
+	mesh.Indices.reserve(cornerCount);
+
+	for (const auto& corner : corners) {
+		if (corner.position < 0 || static_cast<std::size_t>(corner.position) >= positionCount ||
+			(corner.texCoord != NoIndex && (corner.texCoord < 0 || static_cast<std::size_t>(corner.texCoord) >= texCoordCount)) ||
+			(corner.normal != NoIndex && (corner.normal < 0 || static_cast<std::size_t>(corner.normal) >= normalCount))) {
+			std::cout << filePath << ": face refers to a vertex that does not exist\n";
+			return false;
+		}
+		const auto newIndex = static_cast<std::uint32_t>(keys.size());
+		const auto index = weld.FindOrInsert(corner, newIndex);
+		if (index == newIndex) {
+			keys.push_back(corner);
+			const float* position = &positions[corner.position * 3];
+			mesh.Vertices.insert(mesh.Vertices.end(), position, position + 3);
+			if (hasTexCoords) {
+				const float zero[2] = { 0.0f, 0.0f };
+				const float* uv = corner.texCoord != NoIndex ? &texCoords[corner.texCoord * 2] : zero;
+				mesh.Vertices.insert(mesh.Vertices.end(), uv, uv + 2);
+			}
+			if (hasNormals) {
+				const float zero[3] = { 0.0f, 0.0f, 0.0f };
+				const float* normal = corner.normal != NoIndex ? &normals[corner.normal * 3] : zero;
+				mesh.Vertices.insert(mesh.Vertices.end(), normal, normal + 3);
+			}
+		}
+		mesh.Indices.push_back(index);
+	}
+	return true;
+}
+
+bool MeshImporter::ImportGLB(const std::string& filePath, MeshData& mesh, unsigned threadCount)
+{
+	MappedFile file;
+	if (!file.Open(filePath))
+		return false;
+	const unsigned char* data = file.GetData();
+	const std::size_t size = file.GetSize();
+
+	auto read32 = [&](std::size_t offset) {
+		std::uint32_t value;
+		std::memcpy(&value, data + offset, 4);
+		return value;
+	};
+	if (size < 20 || read32(0) != GlbMagic || read32(4) != 2) {
+		std::cout << filePath << " is not a glTF 2.0 binary file\n";
+		return false;
+	}
+
+	//Chunks: JSON first, then an optional BIN chunk
+	const unsigned char* jsonData = nullptr;
+	const unsigned char* bin = nullptr;
+	std::size_t jsonSize = 0, binSize = 0;
+	for (std::size_t offset = 12; offset + 8 <= size;) {
+		const std::size_t length = read32(offset);
+		const std::uint32_t type = read32(offset + 4);
+		if (offset + 8 + length > size)
+			break;
+		if (type == GlbJsonChunk && !jsonData) { jsonData = data + offset + 8; jsonSize = length; }
+		else if (type == GlbBinChunk && !bin) { bin = data + offset + 8; binSize = length; }
+		offset += 8 + ((length + 3) & ~std::size_t(3));
+	}
+	JsonValue json;
+	if (!jsonData || !JsonParser(reinterpret_cast<const char*>(jsonData),
+								 reinterpret_cast<const char*>(jsonData) + jsonSize).Parse(json)) {
+		std::cout << filePath << " has no valid JSON chunk\n";
+		return false;
+	}
+
+	//Primitives of the default scene with their world transforms
+	std::vector<GlbPrimitive> primitives;
+	const auto* scenes = json.Find("scenes");
+	const auto* scene = scenes ? scenes->At(json.SizeOr("scene", 0)) : nullptr;
+	if (scene && scene->Find("nodes")) {
+		for (const auto& node : scene->Find("nodes")->array)
+			CollectPrimitives(json, ToSize(node.number), Identity, primitives, 0);
+	}
+	else if (const auto* meshes = json.Find("meshes")) {
+		for (const auto& meshValue : meshes->array)
+			if (const auto* meshPrimitives = meshValue.Find("primitives"))
+				for (const auto& primitive : meshPrimitives->array)
+					primitives.push_back({ &primitive, Identity, {}, {} });
+	}
+
+	bool hasTexCoords = false, hasNormals = false;
+	for (const auto& primitive : primitives) {
+		const auto* attributes = primitive.primitive->Find("attributes");
+		hasTexCoords |= attributes && attributes->Find("TEXCOORD_0");
+		hasNormals |= attributes && attributes->Find("NORMAL");
+	}
+	mesh = MeshData();
+	mesh.Layout = MakeLayout(hasTexCoords, hasNormals);
+	const std::size_t floatsPerVertex = mesh.GetFloatsPerVertex();
+
+	GlbDocument document(json, bin, binSize);
+	ParallelFor(primitives.size(), ThreadCount(threadCount), [&](std::size_t p) {
+		auto& primitive = primitives[p];
+		if (primitive.primitive->NumberOr("mode", 4) != 4)
+			return;		//Only triangle lists
+		const auto* attributes = primitive.primitive->Find("attributes");
+		const auto* positionAccessor = attributes ? attributes->Find("POSITION") : nullptr;
+		std::vector<float> positions, texCoords, normals;
+		if (!positionAccessor || !document.ReadFloats(ToSize(positionAccessor->number), 3, positions)) {
+			primitive.failed = true;
+			return;
+		}
+		const std::size_t vertexCount = positions.size() / 3;
+		const auto* texCoordAccessor = attributes->Find("TEXCOORD_0");
+		const auto* normalAccessor = attributes->Find("NORMAL");
+		if ((texCoordAccessor && !document.ReadFloats(ToSize(texCoordAccessor->number), 2, texCoords)) ||
+			(normalAccessor && !document.ReadFloats(ToSize(normalAccessor->number), 3, normals)) ||
+			(!texCoords.empty() && texCoords.size() / 2 != vertexCount) ||
+			(!normals.empty() && normals.size() / 3 != vertexCount)) {
+			primitive.failed = true;
+			return;
+		}
+
+		//Normals use the upper 3x3 of the transform, which assumes uniform scaling
+		const Matrix& m = primitive.transform;
+		primitive.vertices.resize(vertexCount * floatsPerVertex, 0.0f);
+		for (std::size_t v = 0; v < vertexCount; v++) {
+			float* out = &primitive.vertices[v * floatsPerVertex];
+			const float* p = &positions[v * 3];
+			for (int r = 0; r < 3; r++)
+				*out++ = static_cast<float>(m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r]);
+			if (hasTexCoords) {
+				if (!texCoords.empty()) { out[0] = texCoords[v * 2]; out[1] = texCoords[v * 2 + 1]; }
+				out += 2;
+			}
+			if (hasNormals && !normals.empty()) {
+				const float* n = &normals[v * 3];
+				double transformed[3], length = 0.0;
+				for (int r = 0; r < 3; r++) {
+					transformed[r] = m[r] * n[0] + m[4 + r] * n[1] + m[8 + r] * n[2];
+					length += transformed[r] * transformed[r];
+				}
+				length = length > 0.0 ? 1.0 / std::sqrt(length) : 0.0;
+				for (int r = 0; r < 3; r++)
+					out[r] = static_cast<float>(transformed[r] * length);
+			}
+		}
+
+		if (const auto* indices = primitive.primitive->Find("indices")) {
+			if (!document.ReadIndices(ToSize(indices->number), primitive.indices)) {
+				primitive.failed = true;
+				return;
+			}
+		}
+		else {
+			primitive.indices.resize(vertexCount);
+			for (std::size_t i = 0; i < vertexCount; i++)
+				primitive.indices[i] = static_cast<std::uint32_t>(i);
+		}
+		primitive.indices.resize(primitive.indices.size() / 3 * 3);
+		for (auto index : primitive.indices) {
+			if (index >= vertexCount) {
+				primitive.failed = true;
+				return;
+			}
+		}
+	});
+
+	//Merge the primitives, welding vertices that are identical in every attribute
+	std::size_t totalIndices = 0;
+	for (const auto& primitive : primitives) {
+		if (primitive.failed) {
+			std::cout << filePath << " has a primitive with unsupported or invalid accessors\n";
+			return false;
+		}
+		totalIndices += primitive.indices.size();
+	}
+	FloatVertexOps ops{ mesh.Vertices, floatsPerVertex };
+	WeldMap<const float*, FloatVertexOps> weld(ops, totalIndices / 4);
+	mesh.Indices.reserve(totalIndices);
+	for (const auto& primitive : primitives) {
+		std::vector<std::uint32_t> remap(primitive.vertices.size() / floatsPerVertex);
+		for (std::size_t v = 0; v < remap.size(); v++) {
+			const float* vertex = &primitive.vertices[v * floatsPerVertex];
+			const auto newIndex = static_cast<std::uint32_t>(mesh.Vertices.size() / floatsPerVertex);
+			remap[v] = weld.FindOrInsert(vertex, newIndex);
+			if (remap[v] == newIndex)
+				mesh.Vertices.insert(mesh.Vertices.end(), vertex, vertex + floatsPerVertex);
+		}
+		for (auto index : primitive.indices)
+			mesh.Indices.push_back(remap[index]);
+	}
+	return true;
+}
+
+bool MeshImporter::Import(const std::string& filePath, MeshData& mesh)
+{
+	const auto dot = filePath.find_last_of('.');
+	std::string extension = dot == std::string::npos ? "" : filePath.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(),
+		[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	if (extension == "obj")
+		return ImportOBJ(filePath, mesh);
+	if (extension == "glb")
+		return ImportGLB(filePath, mesh);
+	if (extension == "mesh") {
+		MeshFile meshFile;
+		if (!meshFile.Load(filePath))
+			return false;
+		mesh = MeshData(meshFile);
+		return true;
+	}
+	std::cout << "Unknown mesh format " << filePath << "\n";
+	return false;
+}
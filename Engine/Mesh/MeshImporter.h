@@ -0,0 +1,55 @@
+/**
+* @file MeshImporter.h
+*
+* @brief Importers for Wavefront OBJ and binary glTF 2.0 (.glb) files.
+*        The result is interleaved MeshData with duplicate vertices welded:
+*          position (Float3), texCoords (Float2, if present), normal (Float3, if present)
+*        ready to be uploaded with MeshData::CreateVertexArray() or written to a mesh file.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MESHIMPORTER_H_
+#define MESHIMPORTER_H_
+
+#include "MeshData.h"
+
+#include <string>
+
+namespace MeshImporter {
+
+	/**
+	* @brief Imports a Wavefront OBJ file. The file is memory mapped and split into
+	*        chunks at line boundaries that are parsed in parallel; polygons are
+	*        triangulated as fans and v/vt/vn triples are welded into single vertices.
+	*
+	* @param filePath - Path to the .obj file
+	* @param mesh - Receives the imported mesh
+	* @param threadCount - Number of parsing threads, 0 uses all hardware threads
+	* @return bool - Whether the file could be imported or not
+	*/
+	bool ImportOBJ(const std::string& filePath, MeshData& mesh, unsigned threadCount = 0);
+
+	/**
+	* @brief Imports the triangle primitives of all meshes in the default scene of a
+	*        binary glTF 2.0 file, with node transforms applied. Primitives are decoded
+	*        in parallel and identical vertices are welded.
+	*
+	* @param filePath - Path to the .glb file
+	* @param mesh - Receives the imported mesh
+	* @param threadCount - Number of decoding threads, 0 uses all hardware threads
+	* @return bool - Whether the file could be imported or not
+	*/
+	bool ImportGLB(const std::string& filePath, MeshData& mesh, unsigned threadCount = 0);
+
+	/**
+	* @brief Imports a .obj, .glb or .mesh file, chosen by the file extension
+	*
+	* @param filePath - Path to the mesh
+	* @param mesh - Receives the imported mesh
+	* @return bool - Whether the file could be imported or not
+	*/
+	bool Import(const std::string& filePath, MeshData& mesh);
+}
+
+#endif // MESHIMPORTER_H_
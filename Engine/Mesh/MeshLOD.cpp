@@ -0,0 +1,64 @@
+/**
+* @file MeshLOD.cpp
+*
+* @brief Uploading of LOD chains and screen size based level selection
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MeshLOD.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+* @brief Uploads every level of the chain into its own vertex array
+*
+* @param chain - Levels from most to least detailed, see MeshSimplifier::BuildLODChain
+* @param fullDetailPixels - Projected diameter from which level 0 is drawn, every
+*                           following level is used down to half the size of the previous
+*/
+MeshLOD::MeshLOD(const std::vector<MeshData>& chain, float fullDetailPixels)
+	: FullDetailPixels(fullDetailPixels)
+{
+	for (const auto& level : chain)
+		Levels.push_back(level.CreateVertexArray());
+
+	if (chain.empty())
+		return;
+	const auto& mesh = chain.front();
+	const auto components = std::min<GLsizei>(3, ShaderDataTypeComponentCount(mesh.Layout.GetAttributes()[0].Type));
+	for (std::size_t v = 0; v < mesh.GetVertexCount(); v++) {
+		const float* position = &mesh.Vertices[v * mesh.GetFloatsPerVertex()];
+		float lengthSquared = 0.0f;
+		for (GLsizei c = 0; c < components; c++)
+			lengthSquared += position[c] * position[c];
+		BoundingRadius = std::max(BoundingRadius, std::sqrt(lengthSquared));
+	}
+}
+
+/**
+* @brief Selects the level of detail from the projected size of the bounding sphere
+*
+* @param camera - The camera the mesh is seen through
+* @param center - Center of the bounding sphere in world space
+* @param radius - Radius of the bounding sphere in world space
+* @param viewportHeight - Height of the viewport in pixels
+* @return level - Index of the level to draw
+*/
+int MeshLOD::SelectLevel(const PerspectiveCamera& camera, const glm::vec3& center, float radius,
+						 GLint viewportHeight) const
+{
+	const glm::vec3 toCenter = center - camera.GetPosition();
+	const float distance = std::sqrt(toCenter.x * toCenter.x + toCenter.y * toCenter.y + toCenter.z * toCenter.z);
+	if (Levels.size() < 2 || distance <= radius)
+		return 0;
+
+	//Diameter of the sphere in pixels for the vertical field of view
+	const float halfAngle = glm::radians(camera.GetFrustrum().angle) * 0.5f;
+	const float pixels = viewportHeight * radius / (distance * std::tan(halfAngle));
+	if (pixels >= FullDetailPixels)
+		return 0;
+	const int level = 1 + static_cast<int>(std::floor(std::log2(FullDetailPixels / std::max(pixels, 1e-3f))));
+	return std::min(level, GetLevelCount() - 1);
+}
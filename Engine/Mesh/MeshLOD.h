@@ -0,0 +1,46 @@
+/**
+* @file MeshLOD.h
+*
+* @brief Levels of detail of a mesh on the GPU, and selection of the level to
+*        draw from the size the mesh covers on screen.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MESHLOD_H_
+#define MESHLOD_H_
+
+#include "MeshData.h"
+
+#include <PerspectiveCamera.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+class MeshLOD
+{
+public:
+	// Projected diameter in pixels from which the full detail level is used
+	static constexpr float DefaultFullDetailPixels = 200.0f;
+
+public:
+	MeshLOD(const std::vector<MeshData>& chain, float fullDetailPixels = DefaultFullDetailPixels);
+	~MeshLOD() = default;
+
+	// Picks the level for a mesh with the given world space bounding sphere
+	int SelectLevel(const PerspectiveCamera& camera, const glm::vec3& center, float radius,
+					GLint viewportHeight) const;
+
+	inline const std::shared_ptr<VertexArray>& GetLevel(int level) const { return Levels[level]; }
+	inline int GetLevelCount() const { return static_cast<int>(Levels.size()); }
+	// Radius of the bounding sphere of the mesh around its local origin
+	inline float GetBoundingRadius() const { return BoundingRadius; }
+
+private:
+	std::vector<std::shared_ptr<VertexArray>> Levels;
+	float BoundingRadius = 0.0f;
+	float FullDetailPixels;
+};
+
+#endif // MESHLOD_H_
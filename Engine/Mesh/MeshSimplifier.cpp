@@ -0,0 +1,412 @@
+/**
+* @file MeshSimplifier.cpp
+*
+* @brief Edge collapse simplification driven by quadric error metrics.
+*
+* Every vertex accumulates the quadrics of the planes of its triangles (and of
+* planes perpendicular to border edges, so open borders and texture seams keep
+* their shape). Edges are kept in a min heap ordered by the error of collapsing
+* them to their optimal position; stale heap entries are skipped by comparing
+* the version stamps of their end points.
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+	struct Vec3 {
+		double x, y, z;
+	};
+
+	inline Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Vec3 operator*(const Vec3& a, double s) { return { a.x * s, a.y * s, a.z * s }; }
+	inline double Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline Vec3 Cross(const Vec3& a, const Vec3& b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	//Border planes weigh much more than surface planes so borders stay in place
+	constexpr double BorderWeight = 1000.0;
+	//Collapses turning a triangle normal more than ~78 degrees are rejected
+	constexpr double MinNormalDot = 0.2;
+
+	/**
+	* @brief Symmetric 4x4 matrix summing the squared distances to a set of planes
+	*/
+	struct Quadric {
+		// a2 ab ac ad b2 bc bd c2 cd d2
+		std::array<double, 10> m{};
+
+		static Quadric FromPlane(const Vec3& n, double d, double weight)
+		{
+			Quadric q;
+			q.m = { n.x * n.x, n.x * n.y, n.x * n.z, n.x * d,
+					n.y * n.y, n.y * n.z, n.y * d,
+					n.z * n.z, n.z * d,
+					d * d };
+			for (auto& value : q.m)
+				value *= weight;
+			return q;
+		}
+
+		Quadric& operator+=(const Quadric& other)
+		{
+			for (std::size_t i = 0; i < m.size(); i++)
+				m[i] += other.m[i];
+			return *this;
+		}
+
+		double Error(const Vec3& v) const
+		{
+			return m[0] * v.x * v.x + 2 * m[1] * v.x * v.y + 2 * m[2] * v.x * v.z + 2 * m[3] * v.x
+				+ m[4] * v.y * v.y + 2 * m[5] * v.y * v.z + 2 * m[6] * v.y
+				+ m[7] * v.z * v.z + 2 * m[8] * v.z
+				+ m[9];
+		}
+
+		//Solves the 3x3 system for the position with the smallest error
+		bool Optimal(Vec3& result) const
+		{
+			const double det = m[0] * (m[4] * m[7] - m[5] * m[5])
+							 - m[1] * (m[1] * m[7] - m[5] * m[2])
+							 + m[2] * (m[1] * m[5] - m[4] * m[2]);
+			if (std::abs(det) < 1e-12)
+				return false;
+			const Vec3 b = { -m[3], -m[6], -m[8] };
+			result.x = (b.x * (m[4] * m[7] - m[5] * m[5]) - m[1] * (b.y * m[7] - m[5] * b.z)
+					  + m[2] * (b.y * m[5] - m[4] * b.z)) / det;
+			result.y = (m[0] * (b.y * m[7] - b.z * m[5]) - b.x * (m[1] * m[7] - m[5] * m[2])
+					  + m[2] * (m[1] * b.z - b.y * m[2])) / det;
+			result.z = (m[0] * (m[4] * b.z - m[5] * b.y) - m[1] * (m[1] * b.z - b.y * m[2])
+					  + b.x * (m[1] * m[5] - m[4] * m[2])) / det;
+			return true;
+		}
+	};
+
+	struct Collapse {
+		double cost;
+		std::uint32_t keep, remove;
+		std::uint32_t keepVersion, removeVersion;
+		Vec3 position;
+		double t;	//Where position lies along the edge, used for the other attributes
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	inline std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b)
+	{
+		return a < b ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a;
+	}
+
+	class Simplifier {
+	public:
+		Simplifier(const MeshData& mesh)
+			: Mesh(mesh), FloatsPerVertex(mesh.GetFloatsPerVertex()),
+			  PositionComponents(std::min<std::size_t>(3, ShaderDataTypeComponentCount(mesh.Layout.GetAttributes()[0].Type)))
+		{
+			const std::size_t vertexCount = mesh.GetVertexCount();
+			Vertices = mesh.Vertices;
+			Positions.resize(vertexCount);
+			for (std::size_t v = 0; v < vertexCount; v++)
+				Positions[v] = ReadPosition(v);
+
+			Triangles.resize(mesh.GetTriangleCount());
+			for (std::size_t t = 0; t < Triangles.size(); t++)
+				Triangles[t] = { mesh.Indices[t * 3], mesh.Indices[t * 3 + 1], mesh.Indices[t * 3 + 2] };
+			Removed.assign(Triangles.size(), false);
+			LiveTriangles = Triangles.size();
+
+			VertexTriangles.resize(vertexCount);
+			for (std::uint32_t t = 0; t < Triangles.size(); t++)
+				for (auto v : Triangles[t])
+					VertexTriangles[v].push_back(t);
+
+			Quadrics.resize(vertexCount);
+			Versions.assign(vertexCount, 0);
+			Deleted.assign(vertexCount, false);
+			ComputeQuadrics();
+		}
+
+		MeshData Run(std::size_t targetTriangles, double maxError)
+		{
+			std::unordered_set<std::uint64_t> edges;
+			for (const auto& triangle : Triangles)
+				for (int e = 0; e < 3; e++)
+					edges.insert(EdgeKey(triangle[e], triangle[(e + 1) % 3]));
+			for (auto key : edges)
+				Push(static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key));
+
+			while (LiveTriangles > targetTriangles && !Heap.empty()) {
+				const Collapse collapse = Heap.top();
+				Heap.pop();
+				if (collapse.cost > maxError)
+					break;
+				if (Deleted[collapse.keep] || Deleted[collapse.remove] ||
+					Versions[collapse.keep] != collapse.keepVersion ||
+					Versions[collapse.remove] != collapse.removeVersion)
+					continue;	//Stale entry, the edge has changed since it was pushed
+				if (!IsValid(collapse))
+					continue;
+				Apply(collapse);
+			}
+			return Compact();
+		}
+
+	private:
+		Vec3 ReadPosition(std::size_t v) const
+		{
+			const float* p = &Vertices[v * FloatsPerVertex];
+			return { p[0], p[1], PositionComponents > 2 ? p[2] : 0.0 };
+		}
+
+		Vec3 TriangleNormal(const std::array<std::uint32_t, 3>& triangle) const
+		{
+			return Cross(Positions[triangle[1]] - Positions[triangle[0]],
+						 Positions[triangle[2]] - Positions[triangle[0]]);
+		}
+
+		void ComputeQuadrics()
+		{
+			std::unordered_map<std::uint64_t, int> edgeUse;
+			for (const auto& triangle : Triangles)
+				for (int e = 0; e < 3; e++)
+					edgeUse[EdgeKey(triangle[e], triangle[(e + 1) % 3])]++;
+
+			for (const auto& triangle : Triangles) {
+				Vec3 normal = TriangleNormal(triangle);
+				const double doubleArea = std::sqrt(Dot(normal, normal));
+				if (doubleArea <= 0.0)
+					continue;
+				normal = normal * (1.0 / doubleArea);
+				const Quadric plane = Quadric::FromPlane(normal, -Dot(normal, Positions[triangle[0]]), doubleArea * 0.5);
+				for (auto v : triangle)
+					Quadrics[v] += plane;
+
+				//Planes through border edges, perpendicular to the triangle
+				for (int e = 0; e < 3; e++) {
+					const auto a = triangle[e], b = triangle[(e + 1) % 3];
+					if (edgeUse[EdgeKey(a, b)] != 1)
+						continue;
+					const Vec3 edge = Positions[b] - Positions[a];
+					Vec3 borderNormal = Cross(edge, normal);
+					const double length = std::sqrt(Dot(borderNormal, borderNormal));
+					if (length <= 0.0)
+						continue;
+					borderNormal = borderNormal * (1.0 / length);
+					const Quadric border = Quadric::FromPlane(borderNormal, -Dot(borderNormal, Positions[a]),
+															  BorderWeight * Dot(edge, edge));
+					Quadrics[a] += border;
+					Quadrics[b] += border;
+				}
+			}
+		}
+
+		void Push(std::uint32_t a, std::uint32_t b)
+		{
+			Quadric q = Quadrics[a];
+			q += Quadrics[b];
+			const Vec3 pa = Positions[a], pb = Positions[b];
+
+			//The optimal position, falling back to the best of the end points and the midpoint
+			Vec3 best = pa;
+			double bestCost = q.Error(pa);
+			Vec3 candidates[3] = { pb, (pa + pb) * 0.5, {} };
+			const int candidateCount = q.Optimal(candidates[2]) ? 3 : 2;
+			for (int i = 0; i < candidateCount; i++) {
+				const double cost = q.Error(candidates[i]);
+				if (cost < bestCost) {
+					bestCost = cost;
+					best = candidates[i];
+				}
+			}
+
+			const Vec3 edge = pb - pa;
+			const double lengthSquared = Dot(edge, edge);
+			const double t = lengthSquared > 0.0 ? std::clamp(Dot(best - pa, edge) / lengthSquared, 0.0, 1.0) : 0.0;
+			Heap.push({ std::max(0.0, bestCost), a, b, Versions[a], Versions[b], best, t });
+		}
+
+		//Rejects collapses that fold triangles over or make the surface non-manifold
+		bool IsValid(const Collapse& collapse)
+		{
+			const auto keep = collapse.keep, remove = collapse.remove;
+			std::unordered_set<std::uint32_t> keepNeighbours;
+			int sharedTriangles = 0;
+			for (auto t : VertexTriangles[keep]) {
+				if (Removed[t])
+					continue;
+				const auto& triangle = Triangles[t];
+				if (std::find(triangle.begin(), triangle.end(), remove) != triangle.end())
+					sharedTriangles++;
+				keepNeighbours.insert(triangle.begin(), triangle.end());
+			}
+			std::unordered_set<std::uint32_t> common;
+			for (auto t : VertexTriangles[remove]) {
+				if (Removed[t])
+					continue;
+				for (auto v : Triangles[t])
+					if (v != keep && v != remove && keepNeighbours.count(v))
+						common.insert(v);
+			}
+			if (static_cast<int>(common.size()) > sharedTriangles)
+				return false;
+
+			for (auto moved : { keep, remove }) {
+				for (auto t : VertexTriangles[moved]) {
+					if (Removed[t])
+						continue;
+					auto triangle = Triangles[t];
+					if (std::find(triangle.begin(), triangle.end(), moved == keep ? remove : keep) != triangle.end())
+						continue;	//Disappears with the collapse
+					const Vec3 before = TriangleNormal(triangle);
+					const Vec3 saved = Positions[moved];
+					Positions[moved] = collapse.position;
+					const Vec3 after = TriangleNormal(triangle);
+					Positions[moved] = saved;
+					const double lengths = std::sqrt(Dot(before, before) * Dot(after, after));
+					if (lengths <= 0.0 || Dot(before, after) < MinNormalDot * lengths)
+						return false;
+				}
+			}
+			return true;
+		}
+
+		void Apply(const Collapse& collapse)
+		{
+			const auto keep = collapse.keep, remove = collapse.remove;
+			Positions[keep] = collapse.position;
+			Quadrics[keep] += Quadrics[remove];
+			Deleted[remove] = true;
+			Versions[keep]++;
+
+			//Position takes the optimal point, the rest of the vertex is interpolated along the edge
+			float* kept = &Vertices[keep * FloatsPerVertex];
+			const float* removed = &Vertices[remove * FloatsPerVertex];
+			kept[0] = static_cast<float>(collapse.position.x);
+			kept[1] = static_cast<float>(collapse.position.y);
+			if (PositionComponents > 2)
+				kept[2] = static_cast<float>(collapse.position.z);
+			for (std::size_t f = PositionComponents; f < FloatsPerVertex; f++)
+				kept[f] = static_cast<float>(kept[f] * (1.0 - collapse.t) + removed[f] * collapse.t);
+
+			for (auto t : VertexTriangles[remove]) {
+				if (Removed[t])
+					continue;
+				auto& triangle = Triangles[t];
+				if (std::find(triangle.begin(), triangle.end(), keep) != triangle.end()) {
+					Removed[t] = true;
+					LiveTriangles--;
+					continue;
+				}
+				std::replace(triangle.begin(), triangle.end(), remove, keep);
+				VertexTriangles[keep].push_back(t);
+			}
+			VertexTriangles[remove].clear();
+			auto& keepTriangles = VertexTriangles[keep];
+			keepTriangles.erase(std::remove_if(keepTriangles.begin(), keepTriangles.end(),
+				[&](std::uint32_t t) { return Removed[t]; }), keepTriangles.end());
+
+			std::unordered_set<std::uint32_t> neighbours;
+			for (auto t : keepTriangles)
+				for (auto v : Triangles[t])
+					if (v != keep)
+						neighbours.insert(v);
+			for (auto v : neighbours)
+				Push(keep, v);
+		}
+
+		MeshData Compact() const
+		{
+			MeshData result;
+			result.Layout = Mesh.Layout;
+			std::vector<std::uint32_t> remap(Positions.size(), UINT32_MAX);
+			for (std::size_t t = 0; t < Triangles.size(); t++) {
+				if (Removed[t])
+					continue;
+				for (auto v : Triangles[t]) {
+					if (remap[v] == UINT32_MAX) {
+						remap[v] = static_cast<std::uint32_t>(result.Vertices.size() / FloatsPerVertex);
+						result.Vertices.insert(result.Vertices.end(), Vertices.begin() + v * FloatsPerVertex,
+											   Vertices.begin() + (v + 1) * FloatsPerVertex);
+					}
+					result.Indices.push_back(remap[v]);
+				}
+			}
+			return result;
+		}
+
+	private:
+		const MeshData& Mesh;
+		const std::size_t FloatsPerVertex;
+		const std::size_t PositionComponents;
+
+		std::vector<float> Vertices;
+		std::vector<Vec3> Positions;
+		std::vector<Quadric> Quadrics;
+		std::vector<std::uint32_t> Versions;
+		std::vector<bool> Deleted;
+
+		std::vector<std::array<std::uint32_t, 3>> Triangles;
+		std::vector<bool> Removed;
+		std::size_t LiveTriangles;
+		std::vector<std::vector<std::uint32_t>> VertexTriangles;
+
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> Heap;
+	};
+
+	bool CanSimplify(const MeshData& mesh)
+	{
+		const auto& attributes = mesh.Layout.GetAttributes();
+		if (attributes.empty() || mesh.Indices.size() % 3 != 0)
+			return false;
+		const auto positionComponents = ShaderDataTypeComponentCount(attributes[0].Type);
+		if (positionComponents < 2 || positionComponents > 4)
+			return false;
+		for (const auto& attribute : attributes)
+			if (ShaderDataTypeToOpenGLBaseType(attribute.Type) != GL_FLOAT)
+				return false;
+		return true;
+	}
+}
+
+MeshData MeshSimplifier::Simplify(const MeshData& mesh, std::size_t targetTriangles, double maxError)
+{
+	if (!CanSimplify(mesh)) {
+		std::cout << "Mesh can not be simplified, it needs a float position first and only float attributes\n";
+		return mesh;
+	}
+	if (mesh.GetTriangleCount() <= targetTriangles)
+		return mesh;
+	return Simplifier(mesh).Run(targetTriangles, maxError);
+}
+
+std::vector<MeshData> MeshSimplifier::BuildLODChain(const MeshData& mesh, int levels, float ratio)
+{
+	std::vector<MeshData> chain;
+	chain.push_back(mesh);
+	for (int level = 1; level < levels; level++) {
+		const auto& previous = chain.back();
+		const auto target = static_cast<std::size_t>(previous.GetTriangleCount() * ratio);
+		if (target < 2)
+			break;
+		MeshData next = Simplify(previous, target);
+		//Stop when the simplifier can not make any more progress
+		if (next.GetTriangleCount() >= previous.GetTriangleCount())
+			break;
+		chain.push_back(std::move(next));
+	}
+	return chain;
+}
@@ -0,0 +1,47 @@
+/**
+* @file MeshSimplifier.h
+*
+* @brief Quadric error metric mesh simplification (Garland & Heckbert) used
+*        to build chains of levels of detail for the piece meshes.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MESHSIMPLIFIER_H_
+#define MESHSIMPLIFIER_H_
+
+#include "MeshData.h"
+
+#include <limits>
+#include <vector>
+
+namespace MeshSimplifier {
+
+	/**
+	* @brief Collapses edges with the lowest quadric error until the mesh has at
+	*        most targetTriangles triangles or the next collapse costs more than maxError.
+	*        The first attribute of the layout is the position (Float2 or Float3),
+	*        the other float attributes are interpolated along the collapsed edges.
+	*
+	* @param mesh - Mesh to simplify
+	* @param targetTriangles - Number of triangles to reduce the mesh to
+	* @param maxError - Largest quadric error allowed for a collapse
+	* @return simplified - The simplified mesh with unused vertices removed
+	*/
+	MeshData Simplify(const MeshData& mesh, std::size_t targetTriangles,
+		double maxError = std::numeric_limits<double>::max());
+
+	/**
+	* @brief Builds a chain of levels of detail, level 0 is the mesh itself and
+	*        every following level has ratio times the triangles of the previous.
+	*        The chain stops early when a level can not be reduced any further.
+	*
+	* @param mesh - Full detail mesh
+	* @param levels - Largest number of levels in the chain
+	* @param ratio - Fraction of triangles kept from one level to the next
+	* @return chain - The levels, from most to least detailed
+	*/
+	std::vector<MeshData> BuildLODChain(const MeshData& mesh, int levels, float ratio = 0.5f);
+}
+
+#endif // MESHSIMPLIFIER_H_
@@ -0,0 +1,264 @@
+/**
+* @file AllocationTracker.cpp
+*
+* @brief The replaced global operator new and delete, and capturing the call
+*        stacks of allocations. The hooks only touch thread local counters and a
+*        fixed buffer of stacks, so counting never allocates itself. The operators
+*        have to stay in this file: Platform is a static library, and the linker
+*        only takes them out of it along with the counting functions a program calls.
+*
+* @author Aleksander Solhaug
+*/
+
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#define ALLOCATION_CALL_STACKS 1
+#endif
+
+namespace {
+	struct CallSite {
+		void* Frames[AllocationTracker::MaxStackDepth];
+		int Depth;
+		void* Caller;				//Return address of the operator, the stack is printed from there
+		std::size_t Size;
+	};
+
+	//Thread local state is trivially constructible, so the hooks can use it at any time
+	struct ThreadState {
+		AllocationCounters Counters;
+		bool Capture;
+		bool InHook;				//Capturing a stack may allocate, that allocation is not captured
+		int CallSiteCount;
+		std::uint64_t MissedCallSites;
+		CallSite CallSites[AllocationTracker::MaxCallSites];
+	};
+
+	thread_local ThreadState State;
+	std::atomic<std::uint64_t> GlobalAllocations{ 0 };
+	std::atomic<std::uint64_t> GlobalBytes{ 0 };
+	std::atomic<std::uint64_t> GlobalFrees{ 0 };
+
+#ifdef ALLOCATION_TRACKER
+	void CountAllocation(std::size_t size, void* caller)
+	{
+		ThreadState& state = State;
+		state.Counters.Allocations++;
+		state.Counters.Bytes += size;
+		GlobalAllocations.fetch_add(1, std::memory_order_relaxed);
+		GlobalBytes.fetch_add(size, std::memory_order_relaxed);
+		if (!state.Capture || state.InHook)
+			return;
+		if (state.CallSiteCount == AllocationTracker::MaxCallSites) {
+			state.MissedCallSites++;
+			return;
+		}
+		CallSite& site = state.CallSites[state.CallSiteCount++];
+		site.Size = size;
+		site.Caller = caller;
+		site.Depth = 0;
+#ifdef ALLOCATION_CALL_STACKS
+		state.InHook = true;
+		site.Depth = backtrace(site.Frames, AllocationTracker::MaxStackDepth);
+		state.InHook = false;
+#endif
+	}
+
+	void CountFree(void* pointer)
+	{
+		if (pointer == nullptr)
+			return;
+		State.Counters.Frees++;
+		GlobalFrees.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void* Allocate(std::size_t size, void* caller)
+	{
+		void* pointer = std::malloc(size == 0 ? 1 : size);
+		if (pointer != nullptr)
+			CountAllocation(size, caller);
+		return pointer;
+	}
+
+	void* AllocateAligned(std::size_t size, std::align_val_t alignment, void* caller)
+	{
+		const std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+		void* pointer = nullptr;
+#ifdef _MSC_VER
+		pointer = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+		if (posix_memalign(&pointer, align, size == 0 ? 1 : size) != 0)
+			pointer = nullptr;
+#endif
+		if (pointer != nullptr)
+			CountAllocation(size, caller);
+		return pointer;
+	}
+
+	void Free(void* pointer)
+	{
+		CountFree(pointer);
+		std::free(pointer);
+	}
+
+	void FreeAligned(void* pointer)
+	{
+		CountFree(pointer);
+#ifdef _MSC_VER
+		_aligned_free(pointer);
+#else
+		std::free(pointer);
+#endif
+	}
+#endif
+}
+
+namespace AllocationTracker {
+	bool IsEnabled()
+	{
+#ifdef ALLOCATION_TRACKER
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	AllocationCounters GetThreadCounters()
+	{
+		return State.Counters;
+	}
+
+	AllocationCounters GetGlobalCounters()
+	{
+		return { GlobalAllocations.load(std::memory_order_relaxed), GlobalBytes.load(std::memory_order_relaxed),
+				 GlobalFrees.load(std::memory_order_relaxed) };
+	}
+
+	void SetCapture(bool capture)
+	{
+#ifdef ALLOCATION_CALL_STACKS
+		//The first backtrace loads the unwinder, which must not happen inside a hook
+		static const bool unwinderLoaded = [] { void* frame; return backtrace(&frame, 1) >= 0; }();
+		(void)unwinderLoaded;
+#endif
+		State.Capture = capture;
+	}
+
+	void ClearCallSites()
+	{
+		State.CallSiteCount = 0;
+		State.MissedCallSites = 0;
+	}
+
+	/**
+	* @brief Names the frames with the exported symbols, demangled. Capturing is paused
+	*        while printing, since printing allocates.
+	*/
+	void PrintCallSites(std::ostream& out)
+	{
+		ThreadState& state = State;
+		const bool capture = state.Capture;
+		state.Capture = false;
+		for (int i = 0; i < state.CallSiteCount; i++) {
+			const CallSite& site = state.CallSites[i];
+			out << "  allocation of " << site.Size << " bytes\n";
+			//The frames before the caller are the hooks themselves
+			int first = 0;
+			while (first < site.Depth && site.Frames[first] != site.Caller)
+				first++;
+			if (first == site.Depth)
+				first = 0;
+			for (int frame = first; frame < site.Depth; frame++) {
+				out << "    #" << frame - first << " " << site.Frames[frame];
+#ifdef ALLOCATION_CALL_STACKS
+				Dl_info info;
+				if (dladdr(site.Frames[frame], &info) && info.dli_sname != nullptr) {
+					int status = 0;
+					char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+					out << " " << (status == 0 && demangled ? demangled : info.dli_sname);
+					std::free(demangled);
+				}
+				else if (dladdr(site.Frames[frame], &info) && info.dli_fname != nullptr)
+					out << " in " << info.dli_fname;
+#endif
+				out << "\n";
+			}
+		}
+		if (state.MissedCallSites > 0)
+			out << "  and " << state.MissedCallSites << " more allocations\n";
+		ClearCallSites();
+		state.Capture = capture;
+	}
+}
+
+#ifdef ALLOCATION_TRACKER
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ALLOCATION_CALLER _ReturnAddress()
+#else
+#define ALLOCATION_CALLER __builtin_return_address(0)
+#endif
+
+void* operator new(std::size_t size)
+{
+	if (void* pointer = Allocate(size, ALLOCATION_CALLER))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	if (void* pointer = Allocate(size, ALLOCATION_CALLER))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, ALLOCATION_CALLER); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return Allocate(size, ALLOCATION_CALLER); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = AllocateAligned(size, alignment, ALLOCATION_CALLER))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = AllocateAligned(size, alignment, ALLOCATION_CALLER))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment, ALLOCATION_CALLER);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocateAligned(size, alignment, ALLOCATION_CALLER);
+}
+
+void operator delete(void* pointer) noexcept { Free(pointer); }
+void operator delete[](void* pointer) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { Free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { Free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { Free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(pointer); }
+#endif
@@ -0,0 +1,65 @@
+/**
+* @file AllocationTracker.h
+*
+* @brief Counts the heap allocations of the program by replacing the global
+*        operator new and delete. Every thread counts its own allocations, so an
+*        AllocationScope tells how much a piece of code allocated without the
+*        other threads mixing in. A thread can also capture the call stacks of
+*        its allocations, to find the code responsible for allocations that
+*        should not happen. Without ALLOCATION_TRACKER defined the operators are
+*        not replaced and every count stays 0.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef ALLOCATIONTRACKER_H_
+#define ALLOCATIONTRACKER_H_
+
+#include <cstdint>
+#include <ostream>
+
+struct AllocationCounters {
+	std::uint64_t Allocations = 0;
+	std::uint64_t Bytes = 0;
+	std::uint64_t Frees = 0;
+};
+
+namespace AllocationTracker {
+	//Whether the operators are replaced and allocations are counted
+	bool IsEnabled();
+
+	//Allocations of the calling thread since it started
+	AllocationCounters GetThreadCounters();
+	//Allocations of all threads since the program started
+	AllocationCounters GetGlobalCounters();
+
+	/**
+	* @brief Starts or stops capturing the call stacks of the allocations of the
+	*        calling thread. Up to MaxCallSites stacks are kept, the rest only counted.
+	*/
+	void SetCapture(bool capture);
+	//Writes the captured call stacks of the calling thread and forgets them
+	void PrintCallSites(std::ostream& out);
+	//Forgets the captured call stacks of the calling thread
+	void ClearCallSites();
+
+	constexpr int MaxCallSites = 8;
+	constexpr int MaxStackDepth = 16;
+}
+
+//Counts the allocations of the calling thread from its construction on
+class AllocationScope {
+public:
+	AllocationScope() : Start(AllocationTracker::GetThreadCounters()) {}
+
+	AllocationCounters GetCounters() const
+	{
+		const AllocationCounters now = AllocationTracker::GetThreadCounters();
+		return { now.Allocations - Start.Allocations, now.Bytes - Start.Bytes, now.Frees - Start.Frees };
+	}
+
+private:
+	AllocationCounters Start;
+};
+
+#endif // ALLOCATIONTRACKER_H_
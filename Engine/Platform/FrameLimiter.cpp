@@ -0,0 +1,89 @@
+/**
+* @file FrameLimiter.cpp
+*
+* @brief Hybrid sleep and spin frame rate limiter
+*
+* @author Aleksander Solhaug
+*/
+
+#include "FrameLimiter.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+namespace {
+	//The wait is slept in short pieces so every wake-up measures the overshoot
+	constexpr std::chrono::microseconds SleepChunk(1000);
+	//Starting estimate of the sleep overshoot, before any sleep has been measured
+	constexpr std::chrono::microseconds InitialOvershoot(1000);
+}
+
+/**
+* @brief Creates the limiter. On Windows the timer resolution is raised to 1 ms
+*        while a limiter exists, otherwise sleeps are rounded up to 15.6 ms.
+*
+* @param framesPerSecond - Frame rate to cap at, 0 or less disables the limiter
+*/
+FrameLimiter::FrameLimiter(double framesPerSecond)
+	: FrameTime(Clock::duration::zero()), NextFrame(), SleepOvershoot(InitialOvershoot)
+{
+#ifdef _WIN32
+	timeBeginPeriod(1);
+#endif
+	SetFrameRate(framesPerSecond);
+}
+
+FrameLimiter::~FrameLimiter()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+/**
+* @brief Changes the frame rate of the limiter
+*
+* @param framesPerSecond - Frame rate to cap at, 0 or less disables the limiter
+*/
+void FrameLimiter::SetFrameRate(double framesPerSecond)
+{
+	FrameTime = framesPerSecond > 0.0
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond))
+		: Clock::duration::zero();
+	NextFrame = Clock::now() + FrameTime;
+}
+
+/**
+* @brief Sleeps until the overshoot estimate before the deadline, then spins.
+*        The estimate follows the worst recent overshoot and slowly decays,
+*        so a single late wake-up does not make every following frame spin long.
+*/
+void FrameLimiter::Wait()
+{
+	if (!IsEnabled())
+		return;
+
+	auto now = Clock::now();
+	while (NextFrame - now > SleepOvershoot + SleepChunk) {
+		std::this_thread::sleep_for(SleepChunk);
+		const auto woken = Clock::now();
+		const auto overshoot = woken - now - SleepChunk;
+		SleepOvershoot = std::max(overshoot, SleepOvershoot - SleepOvershoot / 64);
+		now = woken;
+	}
+	while (now < NextFrame) {
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+
+	NextFrame += FrameTime;
+	if (NextFrame < now)
+		NextFrame = now + FrameTime;
+}
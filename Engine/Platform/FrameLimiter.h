@@ -0,0 +1,46 @@
+/**
+* @file FrameLimiter.h
+*
+* @brief Caps the frame rate with a hybrid wait: the thread sleeps for most of the
+*        remaining frame time and spins for the last part, which the OS scheduler
+*        can not be trusted with. Frame times stay even without burning a whole core.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef FRAMELIMITER_H_
+#define FRAMELIMITER_H_
+
+#include <chrono>
+
+class FrameLimiter {
+public:
+	/**
+	* @param framesPerSecond - Frame rate to cap at, 0 or less disables the limiter
+	*/
+	explicit FrameLimiter(double framesPerSecond = 0.0);
+	~FrameLimiter();
+
+	FrameLimiter(const FrameLimiter&) = delete;
+	FrameLimiter& operator=(const FrameLimiter&) = delete;
+
+	//Changes the frame rate, 0 or less disables the limiter
+	void SetFrameRate(double framesPerSecond);
+	bool IsEnabled() const { return FrameTime.count() > 0; }
+
+	/**
+	* @brief Waits until the next frame is due. Call once per frame, after presenting.
+	*        When a frame runs late the schedule restarts from now instead of
+	*        rushing the following frames to catch up.
+	*/
+	void Wait();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::duration FrameTime;
+	Clock::time_point NextFrame;
+	Clock::duration SleepOvershoot;		//Estimate of how late sleep_for wakes up, spun instead
+};
+
+#endif // FRAMELIMITER_H_
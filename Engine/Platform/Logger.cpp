@@ -0,0 +1,175 @@
+/**
+* @file Logger.cpp
+*
+* @brief Lock-free message ring and the logger thread writing it out
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Logger.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+	const char* LevelName(LogLevel level)
+	{
+		switch (level) {
+		case LogLevel::Error:   return "error";
+		case LogLevel::Warning: return "warning";
+		case LogLevel::Info:    return "info";
+		default:                return "debug";
+		}
+	}
+}
+
+Logger& Logger::GetInstance()
+{
+	static Logger instance;
+	return instance;
+}
+
+Logger::Logger() : WritePosition(0), ReadPosition(0), Dropped(0), Running(false), MaxMessagesPerSecond(50)
+{
+	for (std::size_t i = 0; i < Capacity; i++)
+		Entries[i].Sequence.store(i, std::memory_order_relaxed);
+}
+
+Logger::~Logger()
+{
+	Stop();
+}
+
+void Logger::Start(unsigned maxMessagesPerSecond)
+{
+	if (Thread.joinable())
+		return;
+	MaxMessagesPerSecond = maxMessagesPerSecond;
+	Running.store(true, std::memory_order_release);
+	Thread = std::thread(&Logger::Run, this);
+}
+
+void Logger::Stop()
+{
+	if (!Thread.joinable())
+		return;
+	Running.store(false, std::memory_order_release);
+	Thread.join();
+}
+
+/**
+* @brief Claims a slot by moving the write position past it. A slot is free for
+*        position p when its sequence is p, and holds a message when it is p + 1.
+*/
+bool Logger::Post(LogLevel level, std::uint32_t id, const char* format, ...)
+{
+	std::size_t position = WritePosition.load(std::memory_order_relaxed);
+	Entry* entry;
+	for (;;) {
+		entry = &Entries[position % Capacity];
+		const std::size_t sequence = entry->Sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+		if (difference == 0) {
+			if (WritePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0) {			//The logger thread has not read this slot yet
+			Dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else position = WritePosition.load(std::memory_order_relaxed);
+	}
+
+	entry->Level = level;
+	entry->Id = id;
+	va_list arguments;
+	va_start(arguments, format);
+	std::vsnprintf(entry->Text, MaxMessageLength, format, arguments);
+	va_end(arguments);
+	entry->Sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+/**
+* @brief Takes the oldest message out of the ring, only called by the logger thread
+*/
+bool Logger::Pop(LogLevel& level, std::uint32_t& id, char* text)
+{
+	Entry& entry = Entries[ReadPosition % Capacity];
+	if (entry.Sequence.load(std::memory_order_acquire) != ReadPosition + 1)
+		return false;
+	level = entry.Level;
+	id = entry.Id;
+	std::snprintf(text, MaxMessageLength, "%s", entry.Text);
+	entry.Sequence.store(ReadPosition + Capacity, std::memory_order_release);
+	ReadPosition++;
+	return true;
+}
+
+/**
+* @brief Writes the queued messages until the logger is stopped. Once a second the
+*        repeats of deduplicated messages and the suppressed and dropped messages
+*        are summarized, and the rate limit budget is refilled.
+*/
+void Logger::Run()
+{
+	using Clock = std::chrono::steady_clock;
+	struct Repeats { std::size_t count, reported; };
+	std::unordered_map<std::uint32_t, Repeats> repeats;
+	std::size_t suppressed = 0;
+	unsigned budget = MaxMessagesPerSecond;
+	auto nextSummary = Clock::now() + std::chrono::seconds(1);
+
+	auto summarize = [&]() {
+		for (auto& [id, repeat] : repeats) {
+			if (repeat.count > repeat.reported) {
+				std::cout << "[log] message " << id << " repeated " << repeat.count - repeat.reported << " times\n";
+				repeat.reported = repeat.count;
+			}
+		}
+		const std::size_t dropped = Dropped.exchange(0, std::memory_order_relaxed);
+		if (suppressed > 0 || dropped > 0)
+			std::cout << "[log] " << suppressed << " messages over the rate limit, " << dropped << " dropped\n";
+		suppressed = 0;
+		std::cout.flush();
+	};
+
+	LogLevel level;
+	std::uint32_t id;
+	char text[MaxMessageLength];
+	for (;;) {
+		const bool running = Running.load(std::memory_order_acquire);
+		bool wrote = false;
+		while (Pop(level, id, text)) {
+			if (id != 0) {
+				Repeats& repeat = repeats[id];
+				if (repeat.count++ > 0)
+					continue;
+				repeat.reported = 1;
+			}
+			if (budget == 0) {
+				suppressed++;
+				continue;
+			}
+			budget--;
+			std::cout << "[" << LevelName(level) << "] " << text << '\n';
+			wrote = true;
+		}
+		if (wrote)
+			std::cout.flush();
+		if (!running)
+			break;
+
+		const auto now = Clock::now();
+		if (now >= nextSummary) {
+			summarize();
+			budget = MaxMessagesPerSecond;
+			nextSummary = now + std::chrono::seconds(1);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	summarize();
+}
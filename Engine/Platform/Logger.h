@@ -0,0 +1,81 @@
+/**
+* @file Logger.h
+*
+* @brief Asynchronous logger for messages posted from hot paths and driver callbacks.
+*        Posting formats the message into a slot of a lock-free ring buffer and never
+*        blocks or allocates, a logger thread writes the messages out. Messages with
+*        an id are deduplicated, repeats are only counted and summarized, and the
+*        output is rate limited so a flood of messages can not stall the program.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+enum class LogLevel { Error, Warning, Info, Debug };
+
+class Logger {
+public:
+	//Longest message kept, longer messages are cut
+	static constexpr std::size_t MaxMessageLength = 240;
+	//Messages that can wait in the ring, further messages are dropped and counted
+	static constexpr std::size_t Capacity = 1024;
+
+	static Logger& GetInstance();
+
+	/**
+	* @brief Starts the logger thread. Messages posted before are kept in the ring.
+	*
+	* @param maxMessagesPerSecond - Messages written per second, the rest are counted as suppressed
+	*/
+	void Start(unsigned maxMessagesPerSecond = 50);
+	//Writes the remaining messages and the repeat counts, then stops the logger thread
+	void Stop();
+
+	/**
+	* @brief Queues a printf formatted message, safe to call from any thread
+	*
+	* @param level - Severity of the message
+	* @param id - Messages with the same id other than 0 are only written the first time
+	* @param format - printf format string
+	* @return bool - Whether the message was queued, false when the ring is full
+	*/
+	bool Post(LogLevel level, std::uint32_t id, const char* format, ...)
+#if defined(__GNUC__) || defined(__clang__)
+		__attribute__((format(printf, 4, 5)))
+#endif
+		;
+
+private:
+	Logger();
+	~Logger();
+	Logger(const Logger&) = delete;
+	Logger& operator=(const Logger&) = delete;
+
+	struct Entry {
+		std::atomic<std::size_t> Sequence;	//Slot state of the bounded queue, see Post() and Pop()
+		LogLevel Level;
+		std::uint32_t Id;
+		char Text[MaxMessageLength];
+	};
+
+	bool Pop(LogLevel& level, std::uint32_t& id, char* text);
+	void Run();
+
+	std::array<Entry, Capacity> Entries;
+	alignas(64) std::atomic<std::size_t> WritePosition;
+	alignas(64) std::size_t ReadPosition;	//Only used by the logger thread
+	std::atomic<std::size_t> Dropped;
+	std::atomic<bool> Running;
+	unsigned MaxMessagesPerSecond;
+	std::thread Thread;
+};
+
+#endif // LOGGER_H_
@@ -0,0 +1,132 @@
+/**
+* @file MappedFile.cpp
+*
+* @brief mmap/MapViewOfFile backed implementation of MappedFile
+*
+* @author Aleksander Solhaug
+*/
+
+#include "MappedFile.h"
+
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+* @brief Takes over the mapping of another MappedFile
+*/
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+/**
+* @brief Releases the current mapping and takes over the mapping of another MappedFile
+*/
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other) {
+		Close();
+		std::swap(Data, other.Data);
+		std::swap(Size, other.Size);
+#ifdef _WIN32
+		std::swap(FileHandle, other.FileHandle);
+		std::swap(MappingHandle, other.MappingHandle);
+#endif
+	}
+	return *this;
+}
+
+/**
+* @brief Maps the file into the address space of the process
+*
+* @param filePath - Path to the file to map
+* @return bool - Whether the file could be mapped or not
+*/
+bool MappedFile::Open(const std::string& filePath)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		std::cout << "Could not open " << filePath << "\n";
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		std::cout << "Could not map empty file " << filePath << "\n";
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		std::cout << "Could not map " << filePath << "\n";
+		CloseHandle(file);
+		return false;
+	}
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		std::cout << "Could not map " << filePath << "\n";
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	FileHandle = file;
+	MappingHandle = mapping;
+	Data = static_cast<const unsigned char*>(view);
+	Size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0) {
+		std::cout << "Could not open " << filePath << "\n";
+		return false;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0) {
+		std::cout << "Could not map empty file " << filePath << "\n";
+		close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	//The mapping keeps its own reference to the file
+	close(file);
+	if (view == MAP_FAILED) {
+		std::cout << "Could not map " << filePath << "\n";
+		return false;
+	}
+	Data = static_cast<const unsigned char*>(view);
+	Size = static_cast<std::size_t>(status.st_size);
+#endif
+	return true;
+}
+
+/**
+* @brief Unmaps the file, pointers returned by GetData() are invalid afterwards
+*/
+void MappedFile::Close()
+{
+	if (Data == nullptr)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(Data);
+	CloseHandle(MappingHandle);
+	CloseHandle(FileHandle);
+	MappingHandle = nullptr;
+	FileHandle = nullptr;
+#else
+	munmap(const_cast<unsigned char*>(Data), Size);
+#endif
+	Data = nullptr;
+	Size = 0;
+}
@@ -0,0 +1,46 @@
+/**
+* @file MappedFile.h
+*
+* @brief Read-only memory mapping of a file, so large binary assets can be
+*        used in place without reading them into intermediate buffers.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& filePath) { Open(filePath); }
+	~MappedFile() { Close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	void operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// Maps the whole file read-only, closing any previous mapping
+	bool Open(const std::string& filePath);
+	// Unmaps the file
+	void Close();
+
+	inline bool IsOpen() const { return Data != nullptr; }
+	inline const unsigned char* GetData() const { return Data; }
+	inline std::size_t GetSize() const { return Size; }
+
+private:
+	const unsigned char* Data = nullptr;
+	std::size_t Size = 0;
+#ifdef _WIN32
+	void* FileHandle = nullptr;
+	void* MappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPEDFILE_H_
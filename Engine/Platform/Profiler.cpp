@@ -0,0 +1,203 @@
+/**
+* @file Profiler.cpp
+*
+* @brief Per-thread zone buffers of the profiler and the Chrome trace export
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Profiler.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+	struct Zone {
+		const char* Name;
+		std::uint64_t Begin;
+		std::uint64_t End;
+	};
+
+	//Zones are appended to chunks that are never moved, so the writer of a thread
+	//needs no lock and WriteTrace() can read the zones any chunk has published
+	struct Chunk {
+		static constexpr std::size_t Capacity = 16384;
+		Zone Zones[Capacity];
+		std::atomic<std::size_t> Count{ 0 };
+		std::atomic<Chunk*> Next{ nullptr };
+	};
+
+	//Chunks are allocated ahead by Reserve() while the profiler runs, naming a thread costs no memory
+	struct ThreadBuffer {
+		std::atomic<Chunk*> First{ nullptr };
+		Chunk* Last = nullptr;					//Only used by the thread owning the buffer
+		Chunk* Spare = nullptr;					//Next chunk to append, only used by the owning thread
+		std::atomic<const char*> Name{ nullptr };
+		int Id = 0;
+
+		ThreadBuffer() = default;
+		ThreadBuffer(const ThreadBuffer&) = delete;
+		ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+		~ThreadBuffer()
+		{
+			for (Chunk* chunk = First.load(std::memory_order_relaxed); chunk != nullptr;) {
+				Chunk* next = chunk->Next.load(std::memory_order_relaxed);
+				delete chunk;
+				chunk = next;
+			}
+			delete Spare;
+		}
+	};
+
+	//Buffers of every thread that recorded a zone, kept after the threads exit
+	struct Registry {
+		std::mutex Mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> Threads;
+		std::uint64_t StartTicks = 0;
+		std::chrono::steady_clock::time_point StartTime;
+	};
+
+	Registry& GetRegistry()
+	{
+		static Registry registry;
+		return registry;
+	}
+
+	thread_local ThreadBuffer* CurrentThread = nullptr;
+
+	//The buffer of the calling thread, registered the first time the thread records
+	ThreadBuffer& GetThreadBuffer()
+	{
+		if (CurrentThread == nullptr) {
+			Registry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.Mutex);
+			registry.Threads.push_back(std::make_unique<ThreadBuffer>());
+			CurrentThread = registry.Threads.back().get();
+			CurrentThread->Id = static_cast<int>(registry.Threads.size());
+		}
+		return *CurrentThread;
+	}
+
+	void WriteString(std::ostream& out, const char* text)
+	{
+		out << '"';
+		for (; *text != '\0'; text++) {
+			if (*text == '"' || *text == '\\')
+				out << '\\';
+			out << *text;
+		}
+		out << '"';
+	}
+}
+
+namespace Profiler {
+	std::atomic<bool> Running{ false };
+
+	void Start()
+	{
+		Registry& registry = GetRegistry();
+		{
+			std::lock_guard<std::mutex> lock(registry.Mutex);
+			if (registry.StartTicks == 0) {
+				registry.StartTicks = Now();
+				registry.StartTime = std::chrono::steady_clock::now();
+			}
+		}
+		Running.store(true, std::memory_order_relaxed);
+	}
+
+	void Stop()
+	{
+		Running.store(false, std::memory_order_relaxed);
+	}
+
+	void SetThreadName(const char* name)
+	{
+		GetThreadBuffer().Name.store(name, std::memory_order_release);
+	}
+
+	void Reserve()
+	{
+		if (!IsRunning())
+			return;
+		ThreadBuffer& buffer = GetThreadBuffer();
+		if (buffer.Spare == nullptr)
+			buffer.Spare = new Chunk();
+	}
+
+	void Record(const char* name, std::uint64_t begin, std::uint64_t end)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		Chunk* chunk = buffer.Last;
+		std::size_t count = chunk != nullptr ? chunk->Count.load(std::memory_order_relaxed) : 0;
+		if (chunk == nullptr || count == Chunk::Capacity) {
+			//Only a thread that did not call Reserve() since its last chunk filled up allocates here
+			Chunk* next = buffer.Spare != nullptr ? buffer.Spare : new Chunk();
+			buffer.Spare = nullptr;
+			if (chunk != nullptr)
+				chunk->Next.store(next, std::memory_order_release);
+			else buffer.First.store(next, std::memory_order_release);
+			chunk = buffer.Last = next;
+			count = 0;
+		}
+		chunk->Zones[count] = { name, begin, end };
+		chunk->Count.store(count + 1, std::memory_order_release);
+	}
+
+	/**
+	* @brief The ticks are converted to microseconds with the rate measured between
+	*        Start() and now, which calibrates the time stamp counter
+	*/
+	bool WriteTrace(const std::string& filePath)
+	{
+		Registry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.Mutex);
+		if (registry.StartTicks == 0)
+			return false;
+
+		std::ofstream out(filePath);
+		if (!out) {
+			std::cout << "Could not write the profile to " << filePath << std::endl;
+			return false;
+		}
+
+		const double elapsedMicroseconds = std::chrono::duration<double, std::micro>(
+			std::chrono::steady_clock::now() - registry.StartTime).count();
+		const double elapsedTicks = static_cast<double>(Now() - registry.StartTicks);
+		const double ticksPerMicrosecond = elapsedMicroseconds > 0.0 && elapsedTicks > 0.0 ?
+										   elapsedTicks / elapsedMicroseconds : 1000.0;
+
+		out << std::fixed << std::setprecision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first = true;
+		for (const auto& thread : registry.Threads) {
+			if (const char* name = thread->Name.load(std::memory_order_acquire)) {
+				out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+					<< thread->Id << ",\"args\":{\"name\":";
+				WriteString(out, name);
+				out << "}}";
+				first = false;
+			}
+			for (const Chunk* chunk = thread->First.load(std::memory_order_acquire); chunk != nullptr; chunk = chunk->Next.load(std::memory_order_acquire)) {
+				const std::size_t count = chunk->Count.load(std::memory_order_acquire);
+				for (std::size_t i = 0; i < count; i++) {
+					const Zone& zone = chunk->Zones[i];
+					if (zone.Begin < registry.StartTicks)
+						continue;
+					out << (first ? "\n" : ",\n") << "{\"name\":";
+					WriteString(out, zone.Name);
+					out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->Id
+						<< ",\"ts\":" << (zone.Begin - registry.StartTicks) / ticksPerMicrosecond
+						<< ",\"dur\":" << (zone.End - zone.Begin) / ticksPerMicrosecond << "}";
+					first = false;
+				}
+			}
+		}
+		out << "\n]}\n";
+		return static_cast<bool>(out);
+	}
+}
@@ -0,0 +1,104 @@
+/**
+* @file Profiler.h
+*
+* @brief Instrumentation profiler for CPU time. Code is marked with PROFILE_ZONE,
+*        which times the rest of the enclosing scope while the profiler runs.
+*        Every thread appends its zones to a buffer of its own without locks, and
+*        WriteTrace() exports them as Chrome trace_event JSON, which chrome://tracing
+*        and Perfetto show frame by frame. Timestamps come from the time stamp
+*        counter on x86 and from steady_clock elsewhere. Without PROFILER defined
+*        the macros are empty.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define PROFILER_TSC 1
+#endif
+
+namespace Profiler {
+	//Whether zones are recorded, read with IsRunning()
+	extern std::atomic<bool> Running;
+
+	//Starts recording zones, zones recorded by an earlier run are kept
+	void Start();
+	//Stops recording, zones still open are not recorded
+	void Stop();
+	inline bool IsRunning() { return Running.load(std::memory_order_relaxed); }
+
+	//Name the calling thread is shown with in the trace, the pointer is stored
+	void SetThreadName(const char* name);
+
+	//Allocates the next buffer chunk of the calling thread ahead while the profiler runs,
+	//so recording zones never allocates. Call it outside the code measured for allocations
+	void Reserve();
+
+	/**
+	* @brief Writes every recorded zone as a Chrome trace_event JSON file. Zones of
+	*        threads still running are written up to the last one they finished.
+	*
+	* @param filePath - File to write
+	* @return bool - Whether the file was written
+	*/
+	bool WriteTrace(const std::string& filePath);
+
+	//Timestamp in ticks of the time stamp counter, or nanoseconds without one
+	inline std::uint64_t Now()
+	{
+#ifdef PROFILER_TSC
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	//Adds a finished zone to the buffer of the calling thread, name has to outlive the profiler
+	void Record(const char* name, std::uint64_t begin, std::uint64_t end);
+}
+
+//Times the enclosing scope, use PROFILE_ZONE instead so it can be compiled out
+class ProfileZone {
+public:
+	explicit ProfileZone(const char* name) : Name(name), Begin(Profiler::IsRunning() ? Profiler::Now() : 0) {}
+	~ProfileZone()
+	{
+		if (Begin != 0 && Profiler::IsRunning())
+			Profiler::Record(Name, Begin, Profiler::Now());
+	}
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* Name;
+	std::uint64_t Begin;		//0 when the profiler was not running
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#ifdef PROFILER
+//Times the rest of the enclosing scope as a zone named by a string literal
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#define PROFILE_RESERVE() Profiler::Reserve()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_RESERVE() ((void)0)
+#endif
+
+#endif // PROFILER_H_
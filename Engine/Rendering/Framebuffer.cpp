@@ -0,0 +1,128 @@
+/**
+* @file Framebuffer.cpp
+*
+* @brief Creating offscreen framebuffers and reading their pixels back, to render
+*        without a visible window and to save the rendered frames as images
+*
+* @author Aleksander Solhaug
+*/
+
+#include "Framebuffer.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+/**
+* @brief Creates the framebuffer with renderbuffers for the color and the depth
+*
+* @param width - Width of the framebuffer in pixels
+* @param height - Height of the framebuffer in pixels
+*/
+Framebuffer::Framebuffer(GLsizei width, GLsizei height) : Width(width), Height(height) {
+
+	glGenRenderbuffers(1, &ColorBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, ColorBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, Width, Height);
+
+	glGenRenderbuffers(1, &DepthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, DepthBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, Width, Height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &FramebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ColorBufferID);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, DepthBufferID);
+	if (!IsComplete())
+		std::cout << "Framebuffer " << Width << "x" << Height << " is not complete" << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+* @brief Deletes the framebuffer and its renderbuffers
+*/
+Framebuffer::~Framebuffer() {
+	glDeleteFramebuffers(1, &FramebufferID);
+	glDeleteRenderbuffers(1, &ColorBufferID);
+	glDeleteRenderbuffers(1, &DepthBufferID);
+}
+
+/**
+* @brief Binds the framebuffer for drawing and reading, and sets the viewport to cover it
+*/
+void Framebuffer::Bind() const {
+	glBindFramebuffer(GL_FRAMEBUFFER, FramebufferID);
+	glViewport(0, 0, Width, Height);
+}
+
+/**
+* @brief Binds the default framebuffer of the window again
+*/
+void Framebuffer::Unbind() const {
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+* @brief Checks whether the framebuffer can be drawn to, it must be bound
+*
+* @return bool - Whether the framebuffer is complete
+*/
+bool Framebuffer::IsComplete() const {
+	return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+/**
+* @brief Reads the color attachment. OpenGL stores the rows from the bottom up,
+*        they are flipped so the first row is the top of the image.
+*
+* @param pixels - Receives Width * Height RGBA8 pixels
+*/
+void Framebuffer::ReadPixels(std::vector<std::uint8_t>& pixels) const {
+	const std::size_t rowSize = static_cast<std::size_t>(Width) * 4;
+	pixels.resize(rowSize * Height);
+
+	GLint previous = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferID);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, Width, Height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+
+	std::vector<std::uint8_t> row(rowSize);
+	for (GLsizei y = 0; y < Height / 2; y++) {
+		std::uint8_t* top = &pixels[y * rowSize];
+		std::uint8_t* bottom = &pixels[(Height - 1 - y) * rowSize];
+		std::memcpy(row.data(), top, rowSize);
+		std::memcpy(top, bottom, rowSize);
+		std::memcpy(bottom, row.data(), rowSize);
+	}
+}
+
+/**
+* @brief Saves the color attachment as an image
+*
+* @param filePath - Path ending in .png for a PNG file, anything else gets raw RGBA8 rows
+* @return bool - Whether the file could be written or not
+*/
+bool Framebuffer::SaveImage(const std::string& filePath) const {
+	std::vector<std::uint8_t> pixels;
+	ReadPixels(pixels);
+
+	const bool png = filePath.size() >= 4 && filePath.compare(filePath.size() - 4, 4, ".png") == 0;
+	if (png) {
+		if (stbi_write_png(filePath.c_str(), Width, Height, 4, pixels.data(), Width * 4) != 0)
+			return true;
+	}
+	else {
+		std::ofstream file(filePath, std::ios::binary);
+		if (file.write(reinterpret_cast<const char*>(pixels.data()), pixels.size()))
+			return true;
+	}
+	std::cout << "Failed to write " << filePath << std::endl;
+	return false;
+}
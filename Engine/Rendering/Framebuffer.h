@@ -0,0 +1,37 @@
+#ifndef Framebuffer_H
+#define Framebuffer_H
+#include "glad/glad.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Offscreen render target with an RGBA8 color and a depth attachment, used when
+//there is no window to draw into and for reading rendered frames back
+class Framebuffer {
+
+private:
+	GLuint FramebufferID;
+	GLuint ColorBufferID;
+	GLuint DepthBufferID;
+	GLsizei Width;
+	GLsizei Height;
+
+public:
+	Framebuffer(GLsizei width, GLsizei height);
+	~Framebuffer();
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+
+	void Bind() const;		//Draws go to the framebuffer, viewport set to its size
+	void Unbind() const;	//Draws go to the window again
+	bool IsComplete() const;
+	//Reads the color attachment as RGBA8 rows from top to bottom
+	void ReadPixels(std::vector<std::uint8_t>& pixels) const;
+	//Writes the color attachment to a .png file, or raw RGBA8 rows for any other extension
+	bool SaveImage(const std::string& filePath) const;
+
+	inline GLuint GetFramebufferID() const { return FramebufferID; }
+	inline GLsizei GetWidth() const { return Width; }
+	inline GLsizei GetHeight() const { return Height; }
+};
+#endif
@@ -0,0 +1,149 @@
+/**
+* @file GpuProfiler.cpp
+*
+* @brief Ring of timestamp queries measuring the GPU time of frames and the scopes in them
+*
+* @author Aleksander Solhaug
+*/
+
+#include "GpuProfiler.h"
+#include "RenderCommands.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+	const std::size_t NotTimed = SIZE_MAX;
+}
+
+GpuProfiler::Scope::Scope(GpuProfiler* profiler, const char* name) : Profiler(profiler)
+{
+	if (Profiler)
+		Profiler->PushScope(name);
+	else RenderCommands::PushDebugGroup(name);
+}
+
+GpuProfiler::Scope::~Scope()
+{
+	if (Profiler)
+		Profiler->PopScope();
+	else RenderCommands::PopDebugGroup();
+}
+
+/**
+* @brief Creates the queries of the ring, one set per frame in flight
+*/
+GpuProfiler::GpuProfiler(unsigned latency) : Frames(latency > 0 ? latency : 1), Current(0), Oldest(0),
+											 Depth(0), InFrame(false)
+{
+	for (FrameQueries& frame : Frames)
+		glGenQueries(sizeof(frame.Queries) / sizeof(frame.Queries[0]), frame.Queries);
+	Latest.Scopes.reserve(MaxScopes);
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	for (FrameQueries& frame : Frames)
+		glDeleteQueries(sizeof(frame.Queries) / sizeof(frame.Queries[0]), frame.Queries);
+}
+
+/**
+* @brief Starts the next frame of the ring. When its previous frame was never read
+*        it is waited for, which only happens when Collect() is not called.
+*/
+void GpuProfiler::BeginFrame(int frame)
+{
+	while (Frames[Current].Pending)
+		Collect(Latest, true);
+	FrameQueries& queries = Frames[Current];
+	queries.Frame = frame;
+	queries.ScopeCount = 0;
+	Depth = 0;
+	InFrame = true;
+	glQueryCounter(queries.Queries[0], GL_TIMESTAMP);
+}
+
+void GpuProfiler::EndFrame()
+{
+	if (!InFrame)
+		return;
+	FrameQueries& queries = Frames[Current];
+	//Scopes still open end with the frame, every query of the frame has to be written
+	for (std::size_t open = 0; open < std::min(Depth, MaxDepth); open++) {
+		if (OpenScopes[open] != NotTimed)
+			glQueryCounter(queries.Queries[3 + 2 * OpenScopes[open]], GL_TIMESTAMP);
+		OpenScopes[open] = NotTimed;
+	}
+	glQueryCounter(queries.Queries[1], GL_TIMESTAMP);
+	queries.Pending = true;
+	InFrame = false;
+	Current = (Current + 1) % Frames.size();
+}
+
+/**
+* @brief Pushes a debug group and writes the begin timestamp of the scope. Scopes
+*        outside a frame, past MaxScopes or deeper than MaxDepth are only debug groups.
+*/
+void GpuProfiler::PushScope(const char* name)
+{
+	RenderCommands::PushDebugGroup(name);
+	if (Depth >= MaxDepth) {
+		Depth++;
+		return;
+	}
+	FrameQueries& queries = Frames[Current];
+	if (!InFrame || queries.ScopeCount == MaxScopes) {
+		OpenScopes[Depth++] = NotTimed;
+		return;
+	}
+	const std::size_t scope = queries.ScopeCount++;
+	queries.Scopes[scope] = { name, static_cast<int>(Depth) };
+	OpenScopes[Depth++] = scope;
+	glQueryCounter(queries.Queries[2 + 2 * scope], GL_TIMESTAMP);
+}
+
+void GpuProfiler::PopScope()
+{
+	if (Depth == 0)
+		return;
+	if (Depth-- <= MaxDepth && OpenScopes[Depth] != NotTimed)
+		glQueryCounter(Frames[Current].Queries[3 + 2 * OpenScopes[Depth]], GL_TIMESTAMP);
+	RenderCommands::PopDebugGroup();
+}
+
+/**
+* @brief The end of the frame is the last timestamp written, when it is available
+*        the GPU has passed all the others as well
+*/
+bool GpuProfiler::Collect(GpuFrameTimings& timings, bool wait)
+{
+	FrameQueries& queries = Frames[Oldest];
+	if (!queries.Pending)
+		return false;
+	if (!wait) {
+		GLint available = 0;
+		glGetQueryObjectiv(queries.Queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return false;
+	}
+
+	auto timestamp = [&](std::size_t query) {
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries.Queries[query], GL_QUERY_RESULT, &nanoseconds);
+		return nanoseconds;
+	};
+	auto milliseconds = [](GLuint64 begin, GLuint64 end) { return end > begin ? (end - begin) / 1.0e6 : 0.0; };
+
+	timings.Frame = queries.Frame;
+	timings.Milliseconds = milliseconds(timestamp(0), timestamp(1));
+	timings.Scopes.clear();
+	for (std::size_t scope = 0; scope < queries.ScopeCount; scope++) {
+		timings.Scopes.push_back({ queries.Scopes[scope].Name, queries.Scopes[scope].Depth,
+								   milliseconds(timestamp(2 + 2 * scope), timestamp(3 + 2 * scope)) });
+	}
+	if (&timings != &Latest)
+		Latest = timings;
+
+	queries.Pending = false;
+	Oldest = (Oldest + 1) % Frames.size();
+	return true;
+}
@@ -0,0 +1,89 @@
+#ifndef GpuProfiler_H
+#define GpuProfiler_H
+#include "glad/glad.h"
+#include <cstddef>
+#include <vector>
+
+//GPU time of one named scope of a frame
+struct GpuScopeTiming {
+	const char* Name;
+	int Depth;					//0 for scopes directly in the frame, 1 inside one of those and so on
+	double Milliseconds;
+};
+
+//GPU times of a frame and the scopes in it, in the order the scopes began
+struct GpuFrameTimings {
+	int Frame = -1;				//-1 until a frame was read
+	double Milliseconds = 0.0;
+	std::vector<GpuScopeTiming> Scopes;
+};
+
+//Measures the GPU time of frames and of named scopes within them, like the board
+//and piece passes. Every boundary is a GL_TIMESTAMP written with glQueryCounter,
+//so scopes can nest. The queries of the last frames are kept in a ring and read
+//several frames later, once the GPU has passed them, so the pipeline never stalls.
+//Scopes are also pushed as debug groups, which frame debuggers show as markers
+class GpuProfiler {
+
+public:
+	static constexpr std::size_t MaxScopes = 32;		//Scopes timed per frame, further scopes are not timed
+	static constexpr std::size_t MaxDepth = 8;
+
+	//Times a scope until it goes out of scope, works as a debug group only without a profiler
+	class Scope {
+	public:
+		Scope(GpuProfiler* profiler, const char* name);
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		GpuProfiler* Profiler;
+	};
+
+	/**
+	* @param latency - Frames in flight, a frame is read back this many frames after it was timed
+	*/
+	explicit GpuProfiler(unsigned latency = 4);
+	~GpuProfiler();
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	//Starts timing a frame, the scopes pushed until EndFrame() belong to it
+	void BeginFrame(int frame);
+	void EndFrame();
+	void PushScope(const char* name);
+	void PopScope();
+
+	/**
+	* @brief Reads the oldest frame the GPU has finished
+	*
+	* @param timings - Filled with the times of the frame, also kept for GetLatest()
+	* @param wait - Whether to wait for the GPU when the frame is not finished yet
+	* @return bool - Whether a frame was read
+	*/
+	bool Collect(GpuFrameTimings& timings, bool wait = false);
+	//Times of the newest frame read by Collect()
+	const GpuFrameTimings& GetLatest() const { return Latest; }
+
+private:
+	struct ScopeRecord {
+		const char* Name;
+		int Depth;
+	};
+	struct FrameQueries {
+		GLuint Queries[2 + 2 * MaxScopes];	//Frame begin and end, then a begin and end pair per scope
+		ScopeRecord Scopes[MaxScopes];
+		std::size_t ScopeCount = 0;
+		int Frame = -1;
+		bool Pending = false;			//Written but not read yet
+	};
+
+	std::vector<FrameQueries> Frames;
+	std::size_t Current;			//Frame being timed
+	std::size_t Oldest;				//Oldest frame that may be pending
+	std::size_t OpenScopes[MaxDepth];	//Scopes pushed and not popped yet, SIZE_MAX when not timed
+	std::size_t Depth;
+	bool InFrame;
+	GpuFrameTimings Latest;
+};
+#endif
@@ -7,6 +7,7 @@
 */
 
 #include "IndexBuffer.h"
+#include "RenderStats.h"
 
 /**
 * @brief Generates the index buffer and fills it with the data sent from the parameters
@@ -16,9 +17,12 @@
 */
 IndexBuffer::IndexBuffer(GLuint *indices, GLsizei count) {
     Count = count;
+    Type = GL_UNSIGNED_INT;
     glGenBuffers(1, &IndexBufferID);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), indices, GL_STATIC_DRAW);
+    RENDER_STATS_ADD(BufferBinds, 1);
+    RENDER_STATS_ADD(BytesUploaded, count * sizeof(GLuint));
 }
 
 /**
@@ -29,9 +33,29 @@ IndexBuffer::IndexBuffer(GLuint *indices, GLsizei count) {
 */
 IndexBuffer::IndexBuffer(const void* indices, GLsizei count) {
     Count = count;
+    Type = GL_UNSIGNED_INT;
     glGenBuffers(1, &IndexBufferID);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), indices, GL_STATIC_DRAW);
+    RENDER_STATS_ADD(BufferBinds, 1);
+    RENDER_STATS_ADD(BytesUploaded, count * sizeof(GLuint));
+}
+
+/**
+* @brief Generates the index buffer and fills it with 16 bit indices, used for
+*        meshes with at most 65536 vertices to halve the index memory
+* 
+* @param indices - Indices that connects the vertices int he triangles
+* @param count - Number of indices
+*/
+IndexBuffer::IndexBuffer(const GLushort* indices, GLsizei count) {
+    Count = count;
+    Type = GL_UNSIGNED_SHORT;
+    glGenBuffers(1, &IndexBufferID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLushort), indices, GL_STATIC_DRAW);
+    RENDER_STATS_ADD(BufferBinds, 1);
+    RENDER_STATS_ADD(BytesUploaded, count * sizeof(GLushort));
 }
 
 /**
@@ -46,6 +70,7 @@ IndexBuffer::~IndexBuffer() {
 */
 void IndexBuffer::bind() const{
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IndexBufferID);
+    RENDER_STATS_ADD(BufferBinds, 1);
 }
 
 /**
@@ -53,4 +78,5 @@ void IndexBuffer::bind() const{
 */
 void IndexBuffer::unbind() const{
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    RENDER_STATS_ADD(BufferBinds, 1);
 }
\ No newline at end of file
@@ -8,14 +8,17 @@ class IndexBuffer {
 private:
 	GLuint IndexBufferID;
 	GLuint Count;
+	GLenum Type;
 
 public:
 	IndexBuffer(GLuint* indices, GLsizei count);
 	IndexBuffer(const void* indices, GLsizei count);
+	IndexBuffer(const GLushort* indices, GLsizei count);
 	~IndexBuffer();
 	void bind() const;
 	void unbind() const;
 	inline GLuint GetCount() const { return Count; }
+	inline GLenum GetType() const { return Type; }
 	inline GLuint GetIndexBufferID() const { return IndexBufferID; }
 };
 #endif
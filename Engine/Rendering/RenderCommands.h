@@ -3,24 +3,39 @@
 #include "glad/glad.h"
 #include "VertexArray.h"
 #include "IndexBuffer.h"
+#include "RenderStats.h"
 #include <glm/glm.hpp>
 
 namespace RenderCommands
 {
 	//Clears the color and depth buffers
 	inline void Clear(GLuint mode = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT) { glClear(mode); }
-	inline void SetPolygonMode(GLenum face, GLenum mode) { glPolygonMode(face, mode); } 
+	inline void SetPolygonMode(GLenum face, GLenum mode) { glPolygonMode(face, mode); RENDER_STATS_ADD(StateChanges, 1); } 
 	
 	//Draws elements bound by vertex array object
 	inline void DrawIndex(const std::shared_ptr<VertexArray>& vao, GLenum primitive) 
-							{ glDrawElements(primitive, vao->GetIndexBuffer()->GetCount(), GL_UNSIGNED_INT, nullptr); }
+							{ glDrawElements(primitive, vao->GetIndexBuffer()->GetCount(), 
+											 vao->GetIndexBuffer()->GetType(), nullptr);
+							  RENDER_STATS_ADD(DrawCalls, 1);
+							  RENDER_STATS_TRIANGLES(primitive, vao->GetIndexBuffer()->GetCount()); }
+
+	//Draws count vertices of the bound vertex array object without indices, from first
+	inline void DrawArrays(GLenum primitive, GLsizei count, GLint first = 0)
+							{ glDrawArrays(primitive, first, count);
+							  RENDER_STATS_ADD(DrawCalls, 1);
+							  RENDER_STATS_TRIANGLES(primitive, count); }
 
 	//sets background color to the vec4 parameter
 	inline void SetClearColor(const glm::vec4 clearColor) 
-					{ glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]); }
+					{ glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+					  RENDER_STATS_ADD(StateChanges, 1); }
+
+	//Named groups of commands, shown by frame debuggers and in the debug output
+	inline void PushDebugGroup(const char* name) { glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name); }
+	inline void PopDebugGroup() { glPopDebugGroup(); }
 
-	inline void SetWireframeMode() { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }   //Sets wireframe mode
-	inline void SetSolidMode() { glPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }		//Polygons are filled
+	inline void SetWireframeMode() { SetPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }   //Sets wireframe mode
+	inline void SetSolidMode() { SetPolygonMode(GL_FRONT_AND_BACK, GL_FILL); }		//Polygons are filled
 }
 
 
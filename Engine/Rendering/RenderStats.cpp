@@ -0,0 +1,53 @@
+/**
+* @file RenderStats.cpp
+*
+* @brief Ending the frames of the render counters and logging their summary
+*
+* @author Aleksander Solhaug
+*/
+
+#include "RenderStats.h"
+#include <Logger.h>
+
+RenderCounters& RenderCounters::operator+=(const RenderCounters& other)
+{
+	DrawCalls += other.DrawCalls;
+	Triangles += other.Triangles;
+	UniformUploads += other.UniformUploads;
+	ProgramBinds += other.ProgramBinds;
+	VertexArrayBinds += other.VertexArrayBinds;
+	BufferBinds += other.BufferBinds;
+	TextureBinds += other.TextureBinds;
+	StateChanges += other.StateChanges;
+	BytesUploaded += other.BytesUploaded;
+	return *this;
+}
+
+void RenderStats::EndFrame()
+{
+#ifdef RENDER_STATS
+	LastFrame = Frame;
+	Frame = RenderCounters();
+	if (!SummaryEnabled)
+		return;
+
+	Second += LastFrame;
+	SecondFrames++;
+	const auto now = std::chrono::steady_clock::now();
+	if (now < NextSummary)
+		return;
+	if (SecondFrames > 1) {					//The first frame only starts the clock
+		const double frames = static_cast<double>(SecondFrames);
+		Logger::GetInstance().Post(LogLevel::Info, 0,
+			"render %llu frames, per frame: %.0f draws %.0f tris %.0f uniforms %.0f programs %.0f vaos "
+			"%.0f buffers %.0f textures %.0f states %.0f bytes",
+			static_cast<unsigned long long>(SecondFrames), Second.DrawCalls / frames, Second.Triangles / frames,
+			Second.UniformUploads / frames, Second.ProgramBinds / frames, Second.VertexArrayBinds / frames,
+			Second.BufferBinds / frames, Second.TextureBinds / frames, Second.StateChanges / frames,
+			Second.BytesUploaded / frames);
+	}
+	Second = RenderCounters();
+	SecondFrames = 0;
+	NextSummary = now + std::chrono::seconds(1);
+#endif
+}
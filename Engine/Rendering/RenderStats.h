@@ -0,0 +1,66 @@
+#ifndef RenderStats_H
+#define RenderStats_H
+#include <chrono>
+#include <cstdint>
+
+//Work the Rendering library submitted to GL
+struct RenderCounters {
+	std::uint64_t DrawCalls = 0;
+	std::uint64_t Triangles = 0;
+	std::uint64_t UniformUploads = 0;
+	std::uint64_t ProgramBinds = 0;
+	std::uint64_t VertexArrayBinds = 0;
+	std::uint64_t BufferBinds = 0;
+	std::uint64_t TextureBinds = 0;
+	std::uint64_t StateChanges = 0;		//Fixed function state, like the clear color and polygon mode
+	std::uint64_t BytesUploaded = 0;	//Buffer and texture data
+
+	//Binds and fixed function state changes together
+	std::uint64_t GetTotalStateChanges() const
+	{
+		return ProgramBinds + VertexArrayBinds + BufferBinds + TextureBinds + StateChanges;
+	}
+	RenderCounters& operator+=(const RenderCounters& other);
+};
+
+//Registry of the render counters of a thread, so the render thread updates its own
+//without synchronization. The counters of the frame being drawn are moved to the
+//last frame by EndFrame(). Without RENDER_STATS defined the counting macros are
+//empty and every counter stays 0
+class RenderStats {
+public:
+	static RenderStats& Get() { thread_local RenderStats stats; return stats; }
+
+	//Counters of the frame being drawn
+	RenderCounters Frame;
+
+	/**
+	* @brief Ends the frame: its counters become the last frame and are added to the
+	*        summary, then they are reset for the next frame
+	*/
+	void EndFrame();
+	const RenderCounters& GetLastFrame() const { return LastFrame; }
+
+	//Whether a summary of the averages per frame is logged once a second from EndFrame()
+	void SetSummaryEnabled(bool enabled) { SummaryEnabled = enabled; }
+
+private:
+	RenderCounters LastFrame;
+	RenderCounters Second;			//Counters of the frames since the last summary
+	std::uint64_t SecondFrames = 0;
+	std::chrono::steady_clock::time_point NextSummary;
+	bool SummaryEnabled = false;
+};
+
+#ifdef RENDER_STATS
+#define RENDER_STATS_ADD(counter, amount) (RenderStats::Get().Frame.counter += (amount))
+#else
+#define RENDER_STATS_ADD(counter, amount) ((void)0)
+#endif
+
+//Triangles drawn by count vertices or indices of a primitive type
+#define RENDER_STATS_TRIANGLES(primitive, count) \
+	RENDER_STATS_ADD(Triangles, (primitive) == GL_TRIANGLES ? (count) / 3 : \
+		((primitive) == GL_TRIANGLE_STRIP || (primitive) == GL_TRIANGLE_FAN) && (count) > 2 ? (count) - 2 : 0)
+
+#endif
@@ -8,6 +8,10 @@
 */
 
 #include "Shader.h"
+#include <algorithm>
+#include "RenderStats.h"
+#include <Logger.h>
+#include <Profiler.h>
 
 /**
 * @brief Compiles the Shader sent as parameter
@@ -49,6 +53,7 @@ void Shader::CompileShader(GLenum shaderType, const std::string& shaderSource)
 */
 Shader::Shader(const std::string& vertexShaderSrc, const std::string& fragmentShaderSrc)
 {
+	PROFILE_ZONE("Shader::Shader");
 	ShaderProgram = glCreateProgram();
 
 	CompileShader(GL_VERTEX_SHADER, vertexShaderSrc);
@@ -76,6 +81,7 @@ Shader::~Shader()
 void Shader::Bind() const
 {
 	glUseProgram(ShaderProgram);
+	RENDER_STATS_ADD(ProgramBinds, 1);
 }
 
 /**
@@ -84,6 +90,7 @@ void Shader::Bind() const
 void Shader::Unbind() const
 {
 	glUseProgram(0);
+	RENDER_STATS_ADD(ProgramBinds, 1);
 }
 
 /**
@@ -92,9 +99,10 @@ void Shader::Unbind() const
 * @param name - Name of the variable in the shader
 * @param boolean - 0 or 1
 */
-void Shader::setInt(const std::string& name, const bool boolean)
+void Shader::setInt(const char* name, const bool boolean)
 {
 	glUniform1i(GetUniformLocation(name), boolean);
+	RENDER_STATS_ADD(UniformUploads, 1);
 }
 
 /**
@@ -103,9 +111,10 @@ void Shader::setInt(const std::string& name, const bool boolean)
 * @param name - Name of the variable in the shader
 * @param vector - vector with the 2 floats to be uploaded
 */
-void Shader::setUniformFloat2(const std::string& name, const glm::vec2& vector)
+void Shader::setUniformFloat2(const char* name, const glm::vec2& vector)
 {
 	glUniform2f(GetUniformLocation(name), vector.x, vector.y);
+	RENDER_STATS_ADD(UniformUploads, 1);
 }
 
 /**
@@ -114,9 +123,10 @@ void Shader::setUniformFloat2(const std::string& name, const glm::vec2& vector)
 * @param name - Name of the variable in the shader
 * @param vector - vector with the 4 floats to be uploaded
 */
-void Shader::SetUniform4fVector(const std::string& name, const glm::vec4& vector) 
+void Shader::SetUniform4fVector(const char* name, const glm::vec4& vector) 
 {
 	glUniform4f(GetUniformLocation(name), vector[0], vector[1], vector[2], vector[3]);
+	RENDER_STATS_ADD(UniformUploads, 1);
 }
 
 /**
@@ -125,23 +135,32 @@ void Shader::SetUniform4fVector(const std::string& name, const glm::vec4& vector
 * @param name - Name of the variable in the shader
 * @param matrix - matrix with the floats to be uploaded
 */
-void Shader::SetUniformMatrix4fv(const std::string& name, const glm::mat4& matrix) 
+void Shader::SetUniformMatrix4fv(const char* name, const glm::mat4& matrix) 
 {
 	glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]);
+	RENDER_STATS_ADD(UniformUploads, 1);
 }
 
 /**
-* @brief gets the location of the uniform ton be uploaded
+* @brief gets the location of the uniform ton be uploaded. The location is looked up
+*        in the program the first time and cached, a missing uniform is logged once.
+*        Names are passed as C strings, so setting a uniform never allocates.
 * 
 * @param name - Name of the variable in the shader
 * @return location - location of the uniform
 */
-GLint Shader::GetUniformLocation(const std::string& name) 
+GLint Shader::GetUniformLocation(const char* name) 
 {
-	GLint location = glGetUniformLocation(ShaderProgram, name.c_str());
-	if (location == -1)
-		std::cout << "\n\tUniform " << name << " does not  exist!\n";
-	else 
+	auto cached = std::find_if(UniformLocations.begin(), UniformLocations.end(),
+		[name](const std::pair<std::string, GLint>& uniform) { return uniform.first.compare(name) == 0; });
+	if (cached == UniformLocations.end()) {
+		const GLint location = glGetUniformLocation(ShaderProgram, name);
+		if (location == -1)
+			Logger::GetInstance().Post(LogLevel::Warning, 0, "Uniform %s does not exist", name);
+		UniformLocations.emplace_back(name, location);
+		cached = UniformLocations.end() - 1;
+	}
+	if (cached->second != -1)
 		Bind();
-	return location;
+	return cached->second;
 }
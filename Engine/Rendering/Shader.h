@@ -4,13 +4,18 @@
 #include <glm/glm.hpp>
 #include <string>
 #include <iostream>
+#include <utility>
+#include <vector>
 class Shader
 {
 private:
     GLuint VertexShader;
     GLuint FragmentShader;
     GLuint ShaderProgram;
-    GLint GetUniformLocation(const std::string& name);
+    //Looked up once per uniform, -1 if missing. A shader has few uniforms, so they are
+    //searched in order, which compares the names without building a std::string
+    std::vector<std::pair<std::string, GLint>> UniformLocations;
+    GLint GetUniformLocation(const char* name);
     void CompileShader(GLenum shaderType, const std::string& shaderSource);
 public:
     Shader(const std::string& vertexSrc, const std::string& fragmentSrc);
@@ -18,10 +23,10 @@ public:
 
     void Bind() const;
     void Unbind() const;
-    void setInt(const std::string& name, const bool boolean);
-    void setUniformFloat2(const std::string& name, const glm::vec2& vector);
-    void SetUniform4fVector(const std::string& name, const glm::vec4& vector);
-    void SetUniformMatrix4fv(const std::string& name, const glm::mat4& matrix);
+    void setInt(const char* name, const bool boolean);
+    void setUniformFloat2(const char* name, const glm::vec2& vector);
+    void SetUniform4fVector(const char* name, const glm::vec4& vector);
+    void SetUniformMatrix4fv(const char* name, const glm::mat4& matrix);
     inline GLuint getShaderProgram() const { return ShaderProgram; }
 };
 #endif
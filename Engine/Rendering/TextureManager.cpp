@@ -4,11 +4,14 @@
 * @author Rafael Palomar
 */
 #include "TextureManager.h"
+#include "RenderStats.h"
+#include <Profiler.h>
 
 #include <iostream>
 
 bool TextureManager::LoadTexture2DRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
 {
+	PROFILE_ZONE("TextureManager::LoadTexture2DRGBA");
 	int width, height, bpp;
 	auto data = this->LoadTextureImage(filePath, width, height, bpp, STBI_rgb_alpha);
 
@@ -22,6 +25,8 @@ bool TextureManager::LoadTexture2DRGBA(const std::string& name, const std::strin
 	glActiveTexture(GL_TEXTURE0 + unit); // Texture Unit
 	glBindTexture(GL_TEXTURE_2D, tex);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	RENDER_STATS_ADD(TextureBinds, 1);
+	RENDER_STATS_ADD(BytesUploaded, static_cast<std::uint64_t>(width) * height * 4);
 
 	if (mipMap)
 	{
@@ -53,6 +58,7 @@ bool TextureManager::LoadTexture2DRGBA(const std::string& name, const std::strin
 
 bool TextureManager::LoadCubeMapRGBA(const std::string& name, const std::string& filePath, GLuint unit, bool mipMap)
 {
+	PROFILE_ZONE("TextureManager::LoadCubeMapRGBA");
 	int width, height, bpp;
 	auto data = this->LoadTextureImage(filePath, width, height, bpp, STBI_rgb_alpha);
 
@@ -70,6 +76,8 @@ bool TextureManager::LoadCubeMapRGBA(const std::string& name, const std::string&
 	for (unsigned int i = 0; i < 6; i++) {
 		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 	}
+	RENDER_STATS_ADD(TextureBinds, 1);
+	RENDER_STATS_ADD(BytesUploaded, static_cast<std::uint64_t>(width) * height * 4 * 6);
 
 	if (mipMap)
 	{
@@ -7,6 +7,7 @@
 * @author Aleksander Solhaug
 */
 #include "VertexArray.h"
+#include "RenderStats.h"
 
 /**
 * @brief Generates the vertexArray and binds it
@@ -14,6 +15,7 @@
 VertexArray::VertexArray() {
 	glGenVertexArrays(1, &VertexArrayID);
 	glBindVertexArray(VertexArrayID);
+	RENDER_STATS_ADD(VertexArrayBinds, 1);
 }
 
 /**
@@ -30,6 +32,7 @@ VertexArray::~VertexArray() {
 void VertexArray::Bind() const
 {
 	glBindVertexArray(VertexArrayID);
+	RENDER_STATS_ADD(VertexArrayBinds, 1);
 }
 
 /**
@@ -38,6 +41,7 @@ void VertexArray::Bind() const
 void VertexArray::Unbind() const
 {
 	glBindVertexArray(0);
+	RENDER_STATS_ADD(VertexArrayBinds, 1);
 }
 
 /**
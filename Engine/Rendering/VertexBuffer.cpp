@@ -8,6 +8,7 @@
 */
 
 #include "VertexBuffer.h"
+#include "RenderStats.h"
 
 /**
 * @brief Genereates and fills the vertex buffer with data
@@ -20,6 +21,8 @@ VertexBuffer::VertexBuffer(const void* data, GLuint size) {
     glGenBuffers(1, &VertexBufferID);
     glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    RENDER_STATS_ADD(BufferBinds, 1);
+    RENDER_STATS_ADD(BytesUploaded, size);
 }
 
 /**
@@ -36,6 +39,7 @@ VertexBuffer::~VertexBuffer() {
 */
 void VertexBuffer::Bind() const{
     glBindBuffer(GL_ARRAY_BUFFER, VertexBufferID);
+    RENDER_STATS_ADD(BufferBinds, 1);
 } 
 
 /**
@@ -44,6 +48,7 @@ void VertexBuffer::Bind() const{
 */
 void VertexBuffer::Unbind() const{
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    RENDER_STATS_ADD(BufferBinds, 1);
 }
 
 /**
@@ -54,6 +59,7 @@ void VertexBuffer::Unbind() const{
 */
 void VertexBuffer::BufferSubData(GLintptr offset, GLsizeiptr size, const void* data) const{
     glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    RENDER_STATS_ADD(BytesUploaded, size);
 }
 
 
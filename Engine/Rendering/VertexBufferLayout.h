@@ -32,6 +32,10 @@ public:
 		: Attributes(attributes) { 
 		this->CalculateOffsetAndStride();
 	}
+	BufferLayout(const std::vector<BufferAttribute>& attributes)
+		: Attributes(attributes) {
+		this->CalculateOffsetAndStride();
+	}
 
 	inline const std::vector<BufferAttribute>& GetAttributes() const { return this->Attributes; }
 	inline GLsizei GetStride() const { return this->Stride; }
@@ -8,6 +8,7 @@
 *   - Place the cube on a new empty square by pressing space when a cube is selected
 *   - Move the camera around the chessboard
 *   - Zoom in and out on origin
+*   - Play against the engine, which thinks about its moves on a background thread
 */
 #include "AssignmentApplication.h"
 
@@ -16,8 +16,71 @@
 #include <GeometricTools.h>
 #include "Shader.cpp"
 #include <TextureManager.h>
+#include <MeshImporter.h>
+#include <MeshLOD.h>
+#include <MeshSimplifier.h>
+#include <FrameLimiter.h>
+#include <RenderThread.h>
+#include <InputQueue.h>
+#include <Framebuffer.h>
+#include <GpuProfiler.h>
+#include <RenderStats.h>
+#include <Profiler.h>
+#include <AllocationTracker.h>
+#include <BenchmarkRecorder.h>
+#include <MoveGen.h>
+#include <SearchThread.h>
+#include <Nnue.h>
+#include <OpeningBook.h>
+#include <Tablebase.h>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <thread>
 #include "KeyboardInput.cpp"
 
+/**
+* @brief Fits a piece mesh into the same space as the cube it replaces. Piece meshes
+*        are modelled with Y up, the cubes stand on the chessboard along their Z axis.
+*
+* @param mesh - Mesh with a Float3 position as its first attribute
+* @param size - Length of the longest side of the fitted mesh
+*/
+static void FitPieceMesh(MeshData& mesh, float size)
+{
+    const std::size_t stride = mesh.GetFloatsPerVertex();
+    const std::size_t vertexCount = mesh.GetVertexCount();
+    if (vertexCount == 0 || ShaderDataTypeComponentCount(mesh.Layout.GetAttributes()[0].Type) != 3)
+        return;
+
+    float boundsMin[3] = { mesh.Vertices[0], mesh.Vertices[1], mesh.Vertices[2] };
+    float boundsMax[3] = { mesh.Vertices[0], mesh.Vertices[1], mesh.Vertices[2] };
+    for (std::size_t v = 0; v < vertexCount; v++) {
+        for (int c = 0; c < 3; c++) {
+            boundsMin[c] = std::min(boundsMin[c], mesh.Vertices[v * stride + c]);
+            boundsMax[c] = std::max(boundsMax[c], mesh.Vertices[v * stride + c]);
+        }
+    }
+    float extent = 0.0f;
+    for (int c = 0; c < 3; c++)
+        extent = std::max(extent, boundsMax[c] - boundsMin[c]);
+    const float scale = extent > 0.0f ? size / extent : 1.0f;
+
+    for (std::size_t v = 0; v < vertexCount; v++) {
+        float* position = &mesh.Vertices[v * stride];
+        const float x = (position[0] - (boundsMin[0] + boundsMax[0]) * 0.5f) * scale;
+        const float y = (position[1] - (boundsMin[1] + boundsMax[1]) * 0.5f) * scale;
+        const float z = (position[2] - (boundsMin[2] + boundsMax[2]) * 0.5f) * scale;
+        position[0] = x;
+        position[1] = -z;
+        position[2] = y;
+    }
+}
+
 /**
 * @brief Constructor that passes the name and version to GLFWApplication
 * 
@@ -26,7 +89,17 @@
 * @see GLFWApplication::GLFWApplication(...)
 */
 Assignment::Assignment(const std::string name, const std::string version) 
-                                             :  GLFWApplication(name, version){}
+                                             :  GLFWApplication(name, version),
+    m_pieceMeshArg("m", "piece-mesh", "Mesh file (.obj, .glb or .mesh) drawn for the pieces instead of cubes", false, "", "path"),
+    m_proceduralBoardArg("p", "procedural-board", "Generate the chessboard in the vertex shader without vertex buffers", false),
+    m_computerArg("", "computer", "Side the engine plays: white, black or none", false, "black", "side"),
+    m_computerTimeArg("", "computer-time", "Milliseconds the engine thinks about a move", false, 1000, "ms"),
+    m_computerThreadsArg("", "computer-threads", "Threads the engine searches with, 0 for all cores", false, 0, "int"),
+    m_computerHashArg("", "computer-hash", "MB of transposition table the engine searches with", false, 64, "MB"),
+    m_computerNetArg("", "computer-net", "Network file (.nnue) the engine evaluates positions with", false, "", "path"),
+    m_computerBookArg("", "computer-book", "Polyglot opening book (.bin) the engine plays from", false, "", "path"),
+    m_computerTablebasesArg("", "computer-tablebases", "Endgame tablebase file (.tb) the engine plays endings from", false, "", "path"),
+    m_proceduralBoard(false), m_computerColor(Black), m_computerTime(1000), m_computerThreads(1), m_computerHash(64) {}
 
 /**
 * @brief Destructor that closes the application
@@ -40,9 +113,49 @@ Assignment::~Assignment() { GLFWApplication::~GLFWApplication(); }
 */
 unsigned int Assignment::ParseArguments(int argc, char** argv) {
     GLFWApplication::ParseArguments(argc, argv);
+    m_pieceMeshPath = m_pieceMeshArg.getValue();
+    m_proceduralBoard = m_proceduralBoardArg.getValue();
+    const std::string computer = m_computerArg.getValue();
+    if (computer == "white")
+        m_computerColor = White;
+    else if (computer == "black")
+        m_computerColor = Black;
+    else {
+        if (computer != "none")
+            std::cout << "Unknown side " << computer << " for the computer, both sides are played from the keyboard" << std::endl;
+        m_computerColor = ColorCount;
+    }
+    //The benchmark presses the keys for both sides, so the engine never plays in it
+    if (m_benchmarkFrames > 0)
+        m_computerColor = ColorCount;
+    m_computerTime = std::max(1, m_computerTimeArg.getValue());
+    //The game and render threads are mostly idle while the engine thinks, so it takes all cores by default
+    m_computerThreads = m_computerThreadsArg.getValue();
+    if (m_computerThreads <= 0)
+        m_computerThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    m_computerHash = std::max(1, m_computerHashArg.getValue());
+    m_computerNetPath = m_computerNetArg.getValue();
+    m_computerBookPath = m_computerBookArg.getValue();
+    m_computerTablebasesPath = m_computerTablebasesArg.getValue();
     return 0;
 }
 
+/**
+* @brief Adds the arguments of the assignment to the command line
+* @see GLFWApplication::AddArguments(...)
+*/
+void Assignment::AddArguments(TCLAP::CmdLine& cmd) {
+    cmd.add(m_pieceMeshArg);
+    cmd.add(m_proceduralBoardArg);
+    cmd.add(m_computerArg);
+    cmd.add(m_computerTimeArg);
+    cmd.add(m_computerThreadsArg);
+    cmd.add(m_computerHashArg);
+    cmd.add(m_computerNetArg);
+    cmd.add(m_computerBookArg);
+    cmd.add(m_computerTablebasesArg);
+}
+
 /**
 * @brief Initializes the application
 * @see GLFWApplication::Init()
@@ -52,41 +165,353 @@ unsigned Assignment::Init() {
     return 0;
 }
 
+//The game is updated in fixed steps of this many seconds, independent of the frame rate
+static const double SimulationStep = 1.0 / 60.0;
+
+//Keys the benchmark presses, one every BenchmarkKeyInterval steps and over again: the kingside
+//knights move out to f3 and f6 and back, the textures are toggled and the selector returns to a1
+static const int BenchmarkScript[] = {
+    GLFW_KEY_RIGHT, GLFW_KEY_RIGHT, GLFW_KEY_RIGHT, GLFW_KEY_RIGHT, GLFW_KEY_RIGHT, GLFW_KEY_RIGHT,
+    GLFW_KEY_SPACE, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_LEFT, GLFW_KEY_SPACE,                        //Ng1-f3
+    GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_RIGHT,
+    GLFW_KEY_SPACE, GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_SPACE,                    //Ng8-f6
+    GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_DOWN,
+    GLFW_KEY_SPACE, GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_RIGHT, GLFW_KEY_SPACE,                   //Nf3-g1
+    GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_LEFT,
+    GLFW_KEY_SPACE, GLFW_KEY_UP, GLFW_KEY_UP, GLFW_KEY_RIGHT, GLFW_KEY_SPACE,                       //Nf6-g8
+    GLFW_KEY_T,
+    GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_DOWN, GLFW_KEY_DOWN,
+    GLFW_KEY_LEFT, GLFW_KEY_LEFT, GLFW_KEY_LEFT, GLFW_KEY_LEFT, GLFW_KEY_LEFT, GLFW_KEY_LEFT };
+static const int BenchmarkKeyInterval = 15;
+static const int BenchmarkOrbitSteps = 600;     //Steps of one camera orbit around the board
+
 /**
-* @brief Creates everything that you can visibly see within the application
+* @brief Everything the render thread needs to draw a frame, built by the game loop
+*        after every simulation step and never changed once it is published
+*/
+struct FramePacket {
+    double stepTime;                    //Clock time of the step the packet was built by
+    double updateTime;                  //Milliseconds the step took, for the benchmark
+    std::uint64_t updateAllocations;    //Heap allocations of the step, for the benchmark
+    glm::vec3 previousCameraPosition;   //Camera position of the step before, interpolated from
+    glm::vec3 cameraPosition;
+    glm::vec2 selectorPosition;
+    int setTextures;
+    int pieceCount;                     //Pieces on the board, the first entries of the arrays are used
+    glm::mat4 modelCube[32];
+    glm::vec4 cubeColors[32];
+};
+
+/**
+* @brief Runs the game on the main thread and hands a frame packet to the render
+*        thread after every step that changed the scene. The main thread sleeps in
+*        glfwWaitEventsTimeout until the next step is due, or until the next event
+*        when nothing is moving, so an idle board costs next to no CPU or GPU time.
+*        The engine searches its moves on a thread of its own and wakes the loop up
+*        when it is done, the board is drawn and played on while it thinks.
+*        A benchmark runs one step per frame on a clock of its own, with the camera
+*        orbiting and the keys pressed by a script, so every run draws the same frames.
+*        Its steps and frames after the warm-up must not allocate, the run fails with
+*        the call stacks of the allocations otherwise.
 */
 unsigned Assignment::Run() const {
    
     glm::vec2 gridSize = { 8,8 };
 
-    //Creating the geometry of the chessboard
-    auto chessBoard = GeometricTools::UnitGridGeometry2DWTCoords(gridSize.x, gridSize.y);
-    auto chessBoardTopology = GeometricTools::UnitGridTopologyTriangles(gridSize.x, gridSize.y);
-    //Creating the geometry for the selector
-    auto selector = GeometricTools::unitSquare2DTest();
-    auto selectorTopology = GeometricTools::unitSquareTopologyTest();
+    //The game starts from the initial position, the selector in the bottom left square
+    Position position;
+    const Board& board = position.GetBoard();
+    Square selectorSquare = A1;
+    Square selectedSquare = NoSquare;       //Square of the piece picked up with space
+    //Keys of the positions before the current one for the engine to see repetitions, reserved
+    //for all the positions that can repeat, so playing a move does not allocate
+    std::vector<std::uint64_t> gameKeys;
+    gameKeys.reserve(100);
+
+    //The engine thinks on a thread of its own while the game keeps stepping and the render
+    //thread keeps drawing, and wakes up the game loop once it found its move
+    //The network and the tablebases are declared first, so they stay mapped until the engine has stopped searching with them
+    Nnue::Network network;
+    Tablebase::Tables tablebases;
+    SearchThread engine;
+    if (m_computerColor != ColorCount) {
+        engine.GetSearch().SetThreadCount(m_computerThreads);
+        if (!engine.GetSearch().SetHashSize(m_computerHash))
+            std::cout << "The engine searches with its default transposition table" << std::endl;
+        if (!m_computerNetPath.empty()) {
+            if (network.Load(m_computerNetPath)) {
+                engine.GetSearch().SetNetwork(&network);
+                std::cout << "The engine evaluates with the network " << network.GetDescription() << " on "
+                          << Nnue::GetSimdName(Nnue::GetSimdLevel()) << std::endl;
+            }
+            else
+                std::cout << "The engine evaluates without a network" << std::endl;
+        }
+        if (!m_computerTablebasesPath.empty() && tablebases.Load(m_computerTablebasesPath)) {
+            engine.GetSearch().SetTablebases(&tablebases);
+            std::cout << "The engine plays " << tablebases.GetTableCount() << " endings of up to "
+                      << tablebases.GetMaxPieces() << " pieces from the tablebases" << std::endl;
+        }
+    }
+    OpeningBook book;
+    if (m_computerColor != ColorCount && !m_computerBookPath.empty() && book.Load(m_computerBookPath))
+        std::cout << "The engine plays from a book of " << book.GetEntryCount() << " moves" << std::endl;
+    std::mt19937_64 bookRandom(std::random_device{}());
+    SearchLimits engineLimits;
+    engineLimits.MoveTimeMs = m_computerTime;
+
+    //Loading the piece mesh and building its levels of detail, the cubes are drawn without one.
+    //The render thread uploads the levels
+    std::vector<MeshData> pieceChain;
+    if (!m_pieceMeshPath.empty()) {
+        MeshData piece;
+        if (MeshImporter::Import(m_pieceMeshPath, piece)) {
+            FitPieceMesh(piece, 1.0f / 11);
+            pieceChain = MeshSimplifier::BuildLODChain(piece, 4);
+        }
+    }
+
+    //Creating the perspective camera for the scene
+    PerspectiveCamera* camera2 = new PerspectiveCamera(GLFWApplication::m_width, GLFWApplication::m_height);
+
+    //Setting the rotation and scale of the cubes, they are moved to their squares from the board
+    const glm::mat4 cubeRotation = glm::rotate(glm::mat4(1.0f), glm::radians(-89.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+    const glm::mat4 cubeScale = glm::scale(glm::mat4(1.0f), glm::vec3(4.0f, 4.0f, 4.0f));
+    glm::mat4 modelCube[32];
+    glm::vec4 cubeColors[32];
+    int pieceCount = 0;
+
+    glm::vec4 red = { 1.0f, 0.0f, 0.0f, 1.0f };
+    glm::vec4 blue = { 0.0f, 0.0f, 1.0f, 1.0f };
+    glm::vec4 squareColorC = { 0.0f, 0.7f, 0.0f, 1.0f };
+    glm::vec4 colorSelected = { 1.0f, 1.0f, 0.0f, 1.0f };
+
+    //Initializng variables related to key input
+    int setTextures = 0;
+    int lockL, lockH, lockP, lockO = 0;
+
+    const double maxFrameTime = 0.25;           //Longer stalls are skipped, so they do not run hundreds of steps
+    float dt = static_cast<float>(SimulationStep);
+    const bool benchmark = m_benchmarkFrames > 0;
+    double stepTime = benchmark ? 0.0 : glfwGetTime() - SimulationStep;   //Runs the first step right away
+    int step = 0;
+    const glm::vec3 orbitStart = camera2->GetPosition();
+    const double idleTimeout = 0.5;             //Longest sleep while nothing happens
+    bool damaged = true;                        //Whether the scene changed since the last published packet
+    bool cameraMoving = false;
+    bool quit = false;
+
+    //Key presses arrive as events from the GLFW callbacks
+    InputQueue input;
+    input.Attach(GLFWApplication::m_window);
+
+    //All GL work happens on the render thread, which draws the newest packet
+    FrameMailbox<FramePacket> mailbox;
+    bool passed = true;
+    PROFILE_THREAD("game");
+    RenderThread renderThread(GLFWApplication::m_window, [&](const RenderThread& thread) {
+        PROFILE_THREAD("render");
+        passed = RenderLoop(thread, mailbox, gridSize, pieceChain);
+    });
+
+    while (!glfwWindowShouldClose(GLFWApplication::m_window) && !quit)
+    {
+        const double currentTime = benchmark ? stepTime + SimulationStep : glfwGetTime();
+        stepTime = std::max(stepTime, currentTime - maxFrameTime);
+
+        bool stepped = false;
+        while (stepTime + SimulationStep <= currentTime) {
+            PROFILE_RESERVE();
+            PROFILE_ZONE("step");
+            const auto updateStart = std::chrono::steady_clock::now();
+            //The call stacks of allocations after the warm-up are kept to be reported
+            const bool measuredStep = benchmark && step >= m_benchmarkWarmUp;
+            if (benchmark && step == m_benchmarkWarmUp)
+                AllocationTracker::SetCapture(true);
+            AllocationScope stepAllocations;
+            stepTime += SimulationStep;
+            const glm::vec3 previousCameraPosition = camera2->GetPosition();
+            if (benchmark) {
+                PROFILE_ZONE("cameraInput");
+                const float angle = glm::two_pi<float>() * (step % BenchmarkOrbitSteps) / BenchmarkOrbitSteps;
+                camera2->SetPosition(glm::vec3(glm::rotate(glm::mat4(1.0f), angle, glm::vec3(0.0f, 1.0f, 0.0f)) *
+                                               glm::vec4(orbitStart, 1.0f)));
+                if (step % BenchmarkKeyInterval == 0) {
+                    const int scriptLength = sizeof(BenchmarkScript) / sizeof(BenchmarkScript[0]);
+                    processKeyPress(BenchmarkScript[(step / BenchmarkKeyInterval) % scriptLength], position,
+                                    gameKeys, true, selectorSquare, selectedSquare, setTextures);
+                }
+                step++;
+            }
+            else {
+                PROFILE_ZONE("cameraInput");
+                cameraInput(input, camera2, dt, lockL, lockH, lockP, lockO);
+            }
+            //A moving camera keeps the scene damaged until one step after it stops, so the
+            //last packet has the same previous and current position and the frame settles
+            const bool cameraMoved = camera2->GetPosition() != previousCameraPosition;
+            damaged |= cameraMoved || cameraMoving;
+            cameraMoving = cameraMoved;
+
+            //The key presses since the last frame are handled by its first step
+            if (!stepped && !benchmark) {
+                PROFILE_ZONE("processInput");
+                for (const KeyEvent& event : input.GetEvents()) {
+                    if (event.Action != GLFW_PRESS)
+                        continue;
+                    if (event.Key == GLFW_KEY_Q)        // Exit the loop if Q is pressed
+                        quit = true;
+                    processKeyPress(event.Key, position, gameKeys, position.GetSideToMove() != m_computerColor,
+                                    selectorSquare, selectedSquare, setTextures);
+                    damaged = true;
+                }
+                damaged |= input.IsRefreshRequested();
+                input.ClearEvents();
+            }
+            stepped = true;
+
+            //The engine starts thinking when its side is to move, its move is played the same way
+            //as a move from the keyboard once it is found
+            if (position.GetSideToMove() == m_computerColor) {
+                PROFILE_ZONE("engine");
+                SearchResult result;
+                if (engine.TakeResult(result) && !result.BestMove.IsNull()) {
+                    std::cout << "Engine plays " << result.BestMove.ToUci() << ", depth " << result.Depth
+                              << ", score " << result.Score << ", " << result.Nodes / std::max(result.Seconds, 1e-3) / 1000.0
+                              << " knps" << std::endl;
+                    playMove(position, result.BestMove, gameKeys);
+                    selectedSquare = NoSquare;
+                    damaged = true;
+                }
+                else if (!engine.IsBusy()) {
+                    //A move from the book is played at once, the engine only thinks once the book runs out
+                    const Move bookMove = book.IsLoaded() ? book.PickMove(position, bookRandom()) : Move();
+                    if (!bookMove.IsNull()) {
+                        std::cout << "Engine plays " << bookMove.ToUci() << " from the book" << std::endl;
+                        playMove(position, bookMove, gameKeys);
+                        selectedSquare = NoSquare;
+                        damaged = true;
+                    }
+                    else {
+                        //Once the game is over there is no move left to think about
+                        MoveList moves;
+                        GenerateLegalMoves(position, moves);
+                        if (moves.GetSize() > 0)
+                            engine.Start(position, engineLimits, gameKeys, []() { glfwPostEmptyEvent(); });
+                    }
+                }
+            }
+
+            PROFILE_ZONE("matrix updates");
+            //The cubes are placed on the occupied squares of the board, in square order
+            pieceCount = 0;
+            for (Bitboard pieces = board.GetOccupied(); pieces != 0; pieceCount++) {
+                const Square square = PopLowestSquare(pieces);
+                const glm::vec2 center = { -0.5f + (FileOf(square) + 0.5f) / gridSize.x,
+                                           -0.5f + (RankOf(square) + 0.5f) / gridSize.y };
+                modelCube[pieceCount] = cubeScale * cubeRotation *
+                                        glm::translate(glm::mat4(1.0f), glm::vec3(center.x, center.y, 0.07f));
+
+                //White pieces blue and black pieces red, green under the selector and yellow once picked up
+                if (square == selectedSquare)
+                    cubeColors[pieceCount] = colorSelected;
+                else if (square == selectorSquare)
+                    cubeColors[pieceCount] = squareColorC;
+                else cubeColors[pieceCount] = ColorOf(board.GetPiece(square)) == White ? blue : red;
+            }
+
+            //Only the last step of a frame is published, but it has to interpolate from the one before.
+            //Every step fills the packet, the writer owns the slot until it is published
+            FramePacket& packet = mailbox.GetWriteSlot();
+            packet.stepTime = stepTime;
+            packet.updateTime = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - updateStart).count();
+            packet.updateAllocations = stepAllocations.GetCounters().Allocations;
+            if (measuredStep && packet.updateAllocations > 0) {
+                std::cout << packet.updateAllocations << " heap allocations in step " << step - 1 << ":\n";
+                AllocationTracker::PrintCallSites(std::cout);
+            }
+            packet.previousCameraPosition = previousCameraPosition;
+            packet.cameraPosition = camera2->GetPosition();
+            //The shader places the selector from the corner of its square, in squares
+            packet.selectorPosition = { FileOf(selectorSquare) - 0.5f, RankOf(selectorSquare) - 0.5f };
+            packet.setTextures = setTextures;
+            packet.pieceCount = pieceCount;
+            std::copy(modelCube, modelCube + pieceCount, packet.modelCube);
+            std::copy(cubeColors, cubeColors + pieceCount, packet.cubeColors);
+        }
+        if (benchmark) {
+            //Every packet of the benchmark is drawn, the next one waits until the render thread took this one
+            PROFILE_ZONE("wait for render");
+            while (mailbox.IsPending() && !glfwWindowShouldClose(GLFWApplication::m_window)) {
+                glfwPollEvents();
+                std::this_thread::yield();
+            }
+            mailbox.Publish();
+            glfwPollEvents();
+            input.ClearEvents();
+            continue;
+        }
+        if (stepped && damaged) {
+            mailbox.Publish();
+            damaged = false;
+        }
+
+        //Without held keys or a moving camera only an event can change the scene, so the
+        //thread sleeps until one arrives and the clock restarts from there
+        PROFILE_ZONE("wait events");
+        if (!input.IsAnyKeyDown() && !cameraMoving) {
+            glfwWaitEventsTimeout(idleTimeout);
+            stepTime = std::max(stepTime, glfwGetTime() - SimulationStep);
+        }
+        else glfwWaitEventsTimeout(std::max(0.0, stepTime + SimulationStep - glfwGetTime()));
+    }
+
+    renderThread.Stop();
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+* @brief Creates all the GL resources and draws the newest frame packet until the
+*        render thread is stopped. Runs on the render thread, which owns the context.
+*
+* @param thread - The render thread running the loop
+* @param mailbox - Frame packets from the game loop
+* @param gridSize - Number of squares on each side of the chessboard
+* @param pieceChain - Levels of detail of the piece mesh, empty to draw cubes
+* @return bool - false when a benchmark frame after the warm-up allocated heap memory
+*/
+bool Assignment::RenderLoop(const RenderThread& thread, FrameMailbox<FramePacket>& mailbox,
+                            const glm::vec2& gridSize, const std::vector<MeshData>& pieceChain) const {
+
+    //Creating the geometry of the chessboard, split in tiles that fit 16 bit indices.
+    //The procedural board has no geometry, the vertex shader creates it from gl_VertexID
+    std::vector<GeometricTools::GridTile> chessBoardTiles;
+    if (!m_proceduralBoard)
+        chessBoardTiles = GeometricTools::UnitGridTiles(gridSize.x, gridSize.y);
     //Creating the geometry for the cube
     auto cube = GeometricTools::UnitCube3D;
     auto cubeTopology = GeometricTools::UnitCubeTopology;
 
-    //Setting selector starting point to bottom left of chessboard
-    //0 and 1 always starts in bottom left = (-0.5, -0.5), same y coordinate for 3
-    selector[2] = -0.5f + (1.0f / gridSize.x);
-    selector[4] = selector[2];  selector[5] = -0.5f + (1.0f / gridSize.y);
-    selector[7] = selector[5];
-
-    //Creating the buffers and the vertexArray to contain the geometry of the chessboard
-    auto gridIndexBuffer = std::make_shared<IndexBuffer>(chessBoardTopology.data(),
-        chessBoardTopology.size());
+    //Creating the buffers and a vertexArray for each tile of the chessboard
     auto gridBufferLayout = BufferLayout({ {ShaderDataType::Float2, "gridPosition"}, 
                                             {ShaderDataType::Float2, "gridTextureCords"} });
-    auto gridVertexBuffer = std::make_shared<VertexBuffer>(chessBoard.data(),
-                                            chessBoard.size() * sizeof(chessBoard[0]));
-    gridVertexBuffer->SetLayout(gridBufferLayout);
-    auto chessBoardvertexArray = std::make_shared<VertexArray>();
-    chessBoardvertexArray->AddVertexBuffer(gridVertexBuffer, gridBufferLayout);
-    chessBoardvertexArray->SetIndexBuffer(gridIndexBuffer);
-    chessBoardvertexArray->Unbind();
+    std::vector<std::shared_ptr<VertexArray>> chessBoardVertexArrays;
+    for (const auto& tile : chessBoardTiles) {
+        auto gridIndexBuffer = std::make_shared<IndexBuffer>(tile.indices.data(), tile.indices.size());
+        auto gridVertexBuffer = std::make_shared<VertexBuffer>(tile.vertices.data(),
+                                                tile.vertices.size() * sizeof(tile.vertices[0]));
+        gridVertexBuffer->SetLayout(gridBufferLayout);
+        auto chessBoardvertexArray = std::make_shared<VertexArray>();
+        chessBoardvertexArray->AddVertexBuffer(gridVertexBuffer, gridBufferLayout);
+        chessBoardvertexArray->SetIndexBuffer(gridIndexBuffer);
+        chessBoardvertexArray->Unbind();
+        chessBoardVertexArrays.push_back(chessBoardvertexArray);
+    }
+    //Core profile draws need a vertex array, even one without buffers
+    auto proceduralBoardVertexArray = std::make_shared<VertexArray>();
+    proceduralBoardVertexArray->Unbind();
+    const GLsizei proceduralBoardVertices = static_cast<GLsizei>(gridSize.x * gridSize.y * 6);
 
     
     //Sizing down the cube geometry
@@ -105,10 +530,17 @@ unsigned Assignment::Run() const {
     cubeVertexArray->AddVertexBuffer(cubeVertexBuffer, cubeBufferLayout);
     cubeVertexArray->SetIndexBuffer(cubeIndexBuffer);
     cubeVertexArray->Unbind();
+
+    //Uploading the levels of detail of the piece mesh
+    std::unique_ptr<MeshLOD> pieceLOD;
+    if (!pieceChain.empty())
+        pieceLOD = std::make_unique<MeshLOD>(pieceChain);
     
 
     //Creating the shaders
-    auto chessBoardShader = std::make_shared<Shader>(chessBoardShaderSrc.c_str(), chessBoardFragmentShaderSrc.c_str());
+    auto chessBoardShader = std::make_shared<Shader>(m_proceduralBoard ? proceduralChessBoardShaderSrc.c_str()
+                                                                       : chessBoardShaderSrc.c_str(),
+                                                     chessBoardFragmentShaderSrc.c_str());
     auto cubeShader = std::make_shared<Shader>(cubeVertexShaderSrc.c_str(), cubeFragmentShaderSrc.c_str());
     //Defining and uploading the colors that wont change during runtime to the shaders
     glm::vec4 squareColorA = { 1.0f, 1.0f,1.0f, 1.0f };
@@ -128,10 +560,10 @@ unsigned Assignment::Run() const {
                       std::string(TEXTURE_DIR) + std::string("cube_texture.png"), 1);
 
 
-    //Creating the perspective camera for the scene
-    PerspectiveCamera* camera2 = new PerspectiveCamera(GLFWApplication::m_width, GLFWApplication::m_height);
-    glm::mat4 projMatrix = camera2->GetProjectionMatrix();
-    glm::mat4 viewMatrix = camera2->GetViewMatrix();
+    //Creating the camera the frames are drawn with, placed where the packets say
+    PerspectiveCamera renderCamera(GLFWApplication::m_width, GLFWApplication::m_height);
+    glm::mat4 projMatrix = renderCamera.GetProjectionMatrix();
+    glm::mat4 viewMatrix = renderCamera.GetViewMatrix();
     //Uploading the matrices created by the perspectiveCamera constructor to the shaders
     chessBoardShader->SetUniformMatrix4fv("u_projMatrix", projMatrix);
     chessBoardShader->SetUniformMatrix4fv("u_viewMatrix", viewMatrix);
@@ -147,105 +579,59 @@ unsigned Assignment::Run() const {
     chessBoardShader->SetUniformMatrix4fv("u_modelMatrix", chessBoardModelMatrix);
 
 
-    glm::mat4 modelCube[32];
-    for (int i = 0; i < 32; i++)
-        modelCube[i] = glm::mat4(1.0f);
-    //Setting the initial rotation and scale of the cubes
-    auto cubeRotation = glm::rotate(modelCube[0], glm::radians(-89.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    auto cubeScale = glm::scale(modelCube[0], glm::vec3(4.0f, 4.0f, 4.0f));
-
-    //Initializing for each cube to the identity matrix
-    glm::mat4 cubeTranslation[32];
-    for (int i = 0; i < 32; i++) {
-        cubeTranslation[i] = glm::mat4(1.0f);
+    glm::vec4 gray = { 161.0f/255.0f, 161.0f / 255.0f, 161.0f / 255.0f, 1.0f };
+    FrameLimiter frameLimiter(m_frameRateLimit);
+    bool interpolating = false;                 //Whether the camera is still between two packets
+    bool hasPacket = false;
+    int frame = 0;
+
+    //A benchmark draws every packet once and records the frames after its warm-up
+    const bool benchmark = m_benchmarkFrames > 0;
+    std::unique_ptr<BenchmarkRecorder> recorder;
+    if (benchmark)
+        recorder = std::make_unique<BenchmarkRecorder>(m_benchmarkFrames);
+    std::uint64_t measuredAllocations = 0;      //Heap allocations of the steps and frames after the warm-up
+
+    //The GPU time of every pass is measured for the benchmark and the GPU profile log. Without
+    //a profiler the passes are still marked as debug groups for frame debuggers
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    std::ofstream gpuProfileLog;
+    if (benchmark || !m_gpuProfilePath.empty())
+        gpuProfiler = std::make_unique<GpuProfiler>();
+    if (!m_gpuProfilePath.empty()) {
+        gpuProfileLog.open(m_gpuProfilePath);
+        gpuProfileLog << std::fixed << std::setprecision(3);
     }
-
-    //Initializing the cornervectors for the first chessboard square
-    glm::vec3 cornerVector1 = { -0.5f, -0.5f, -0.5f };
-    glm::vec3 cornerVector2 = { -0.5f, -0.5f, -0.5f };
-    glm::vec3 cornerVector3 = { -0.5f, -0.375f, -0.375f };
-    glm::vec3 cornerVector4 = { -0.5f, -0.375f, -0.375f };
-    glm::vec3 middleOfSquare = { 0.0f, 0.0f, 0.0f };
-    std::vector <glm::vec3> translationVectors;
-    translationVectors.resize(32);
-
-    float dSquare = 1.0f / 8;                  //distance between each square
-
-    //Setting all the translation matrices for the cubes
-    for (int i = 0; i < 32; i++) {
-
-        //Moving the corner vectors x coordinate dSquare distance along the row
-        //for each iteration of the loop
-        if (i == 0 || i == 8 || i == 16 || i == 24) {
-            cornerVector2.x += dSquare;
-            cornerVector3.x += dSquare;
-        }
-        else {
-            cornerVector1.x += dSquare;
-            cornerVector2.x += dSquare;
-            cornerVector3.x += dSquare;
-            cornerVector4.x += dSquare;
-        }
-
-        //Finding the distance to the middle of the square
-        middleOfSquare = (cornerVector1 + cornerVector2 + cornerVector3 + cornerVector4);
-        middleOfSquare.x /= 4;
-        middleOfSquare.y /= 4;
-        middleOfSquare.z /= 4;
-
-        //Setting the translation vector to the middle of the square
-        cubeTranslation[i] = glm::translate(glm::mat4(1.0f), glm::vec3(middleOfSquare.x, middleOfSquare.y, 0.07f));
-        translationVectors[i] = glm::vec3(middleOfSquare);
-        //Resetting the corners to the start positions of the next row
-        if (i == 7) {
-            cornerVector1 = { -0.5f, -0.375f, -0.375f };
-            cornerVector2 = { -0.5f, -0.375f, -0.375f };
-            cornerVector3 = { -0.5f, -0.25f,  -0.25f };
-            cornerVector4 = { -0.5f, -0.25f,  -0.25f };
-        }
-        if (i == 15) {                                  //Same as above
-            cornerVector1 = { -0.5f, 0.25f,  0.25f };
-            cornerVector2 = { -0.5f, 0.25f,  0.25f };
-            cornerVector3 = { -0.5f, 0.375f, 0.375f };
-            cornerVector4 = { -0.5f, 0.375f, 0.375f };
-        }
-        if (i == 23) {                                  //Same as above
-            cornerVector1 = { -0.5f, 0.375f, 0.375f };
-            cornerVector2 = { -0.5f, 0.375f, 0.375f };
-            cornerVector3 = { -0.5f, 0.5f,  0.5f };
-            cornerVector4 = { -0.5f, 0.5f,  0.5f };
+    GpuFrameTimings gpuTimings;
+    gpuTimings.Scopes.reserve(GpuProfiler::MaxScopes);     //Collecting the timings must not allocate
+    auto collectGpuTimes = [&](bool wait) {
+        while (gpuProfiler->Collect(gpuTimings, wait)) {
+            if (benchmark && gpuTimings.Frame >= m_benchmarkWarmUp)
+                recorder->GetSample(gpuTimings.Frame - m_benchmarkWarmUp).GpuTime = gpuTimings.Milliseconds;
+            if (gpuProfileLog.is_open()) {
+                gpuProfileLog << "frame " << gpuTimings.Frame << " total " << gpuTimings.Milliseconds << " ms";
+                for (const GpuScopeTiming& scope : gpuTimings.Scopes)
+                    gpuProfileLog << " | " << std::string(scope.Depth, '>') << scope.Name << " " << scope.Milliseconds;
+                gpuProfileLog << '\n';
+            }
         }
+    };
+    auto presentTime = std::chrono::steady_clock::now();
+
+    //Headless there is no window to draw into, the frames go to an offscreen framebuffer
+    std::unique_ptr<Framebuffer> offscreen;
+    if (m_headless) {
+        offscreen = std::make_unique<Framebuffer>(GLFWApplication::m_width, GLFWApplication::m_height);
+        offscreen->Bind();
     }
-    //Initilaizing the modelmatrix for all the cubes
-    for (int i = 0; i < 32; i++) {
-        modelCube[i] = cubeScale * cubeRotation * cubeTranslation[i];
+    if (!m_dumpDirectory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(m_dumpDirectory, error);
     }
-    
-    glm::vec4 red = { 1.0f, 0.0f, 0.0f, 1.0f };
-    glm::vec4 blue = { 0.0f, 0.0f, 1.0f, 1.0f };
-    glm::vec4 gray = { 161.0f/255.0f, 161.0f / 255.0f, 161.0f / 255.0f, 1.0f };
-    glm::vec4 colorSelected = { 1.0f, 1.0f, 0.0f, 1.0f };
-    glm::vec2 selectorCenter = { 0, 0 };
-    glm::vec2 selectorCenter2 = { 0,0 };
-    glm::vec2 cubePos = { 0 ,0 };
 
-    
-    //Initializng variables related to key input
-    float deltaYpress = 0;
-    float deltaXpress = 0;
-    bool pressed = false;
-    int setTextures = 0;
-    int wPress, aPress, sPress, dPress = 0;
-    bool spacePressed = false;
-    bool recalculateModelMatrix = false;
-    bool noCubeSwapp = false;
-    int selectedCube = 0;
-    int cubeToTransalte = 0;
-    int lockL, lockH, lockP, lockO = 0;
-    float dt = 0.0f;
-    float currentTime = 0.0f;
-    float lastTime = 0.0f;
-    
+    //The counters of the frames are logged once a second when asked for
+    RenderStats::Get().SetSummaryEnabled(m_renderStatsSummary);
+
     RenderCommands::SetSolidMode();
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
@@ -253,100 +639,166 @@ unsigned Assignment::Run() const {
     // the function used here is s*apha + d(1-alpha)
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    while (!glfwWindowShouldClose(GLFWApplication::m_window))
+    while (thread.IsRunning())
     {
+        if (m_frameCount > 0 && frame >= m_frameCount) {    //Waiting to be stopped after the last frame
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
 
-        currentTime = glfwGetTime();
-        dt = currentTime - lastTime;
-        lastTime = currentTime;
-        glfwPollEvents();
-        RenderCommands::SetClearColor(gray);
-        RenderCommands::Clear();
-        glm::mat4 viewMatrix = camera2->GetViewMatrix();
-
-        cameraInput(GLFWApplication::m_window, camera2, dt, lockL, lockH, lockP, lockO);
-
-        //Setting the position for the selector 
-        if (selector[0] == -0.5f && selector[1] == -0.5f)
-            selectorCenter = { selector[0], selector[1] };
-        else if (selector[0] != -0.5f && selector[1] == -0.5f)
-            selectorCenter = { selector[0] + deltaXpress, selector[1] };
-        else if (selector[0] == -0.5f && selector[1] != -0.5f)
-            selectorCenter = { selector[0], selector[1] + deltaYpress };
-        else selectorCenter = { selector[0] + deltaXpress,  selector[1] + deltaYpress };
-        selectorCenter2 = { selector[0], selector[1] };
-
-        processInput(GLFWApplication::m_window, selector, pressed, wPress, aPress, sPress, dPress, spacePressed,
-                      deltaXpress, deltaYpress, gridSize, setTextures, translationVectors, selectedCube, cubeToTransalte,
-                                                                                    recalculateModelMatrix, noCubeSwapp);
-
-        chessBoardShader->Bind();
-        chessBoardShader->setUniformFloat2("u_selectorPosition", selectorCenter);
-        chessBoardShader->SetUniformMatrix4fv("u_viewMatrix", viewMatrix);
-        chessBoardShader->setInt("u_SetTextures", setTextures);
-        chessBoardvertexArray->Bind();
-        RenderCommands::DrawIndex(chessBoardvertexArray, GL_TRIANGLES);
-
-
-        cubeShader->Bind();
-        cubeShader->SetUniformMatrix4fv("u_viewMatrix", viewMatrix);
-        cubeShader->setInt("u_SetTextures", setTextures);
-        cubeVertexArray->Bind();
-
-        //If cube is moved
-        if (recalculateModelMatrix == true) {
-            //Update the model matrix with the new translation matrix for the selected cube
-            cubeTranslation[cubeToTransalte - 1] = glm::translate(glm::mat4(1.0f),
-                                                   glm::vec3(translationVectors[cubeToTransalte - 1].x,
-                                                   translationVectors[cubeToTransalte - 1].y, 0.07f));
-
-            modelCube[cubeToTransalte - 1] = cubeScale * cubeRotation * cubeTranslation[cubeToTransalte - 1];
-            recalculateModelMatrix = false;
-            cubeToTransalte = 0;
+        //In a window the last frame is still up to date until a new packet arrives, so there is
+        //nothing to draw. Headless every frame is drawn, they are rendered to be saved or timed.
+        //The benchmark draws each of its packets exactly once
+        const bool drawFrame = mailbox.Acquire() || (hasPacket && !benchmark && (interpolating || m_headless));
+        if (!drawFrame && !mailbox.WaitForPacket(std::chrono::milliseconds(100)))
+            continue;
+        hasPacket = true;
+        PROFILE_RESERVE();
+        PROFILE_ZONE("frame");
+        if (benchmark && frame == m_benchmarkWarmUp)
+            AllocationTracker::SetCapture(true);
+        AllocationScope frameAllocations;
+        const FramePacket& packet = mailbox.GetReadSlot();
+        const auto renderStart = std::chrono::steady_clock::now();
+        if (gpuProfiler)
+            gpuProfiler->BeginFrame(frame);
+
+        //Drawing the scene with the camera between the last two steps, by how far the clock is into the next.
+        //The benchmark steps are not on the clock, its frames show the newest step
+        const float alpha = benchmark ? 1.0f :
+                            static_cast<float>(glm::clamp((glfwGetTime() - packet.stepTime) / SimulationStep, 0.0, 1.0));
+        renderCamera.SetPosition(glm::mix(packet.previousCameraPosition, packet.cameraPosition, alpha));
+        interpolating = alpha < 1.0f && packet.previousCameraPosition != packet.cameraPosition;
+        glm::mat4 viewMatrix = renderCamera.GetViewMatrix();
+
+        {
+            GpuProfiler::Scope pass(gpuProfiler.get(), "clear");
+            RenderCommands::SetClearColor(gray);
+            RenderCommands::Clear();
         }
 
-        for (int i = 0; i < 32; i++) {
-            //Setting variable to the center of the square the cube will be drawn in
-            cubePos.x = translationVectors[i].x;
-            cubePos.y = translationVectors[i].y;
-            cubeShader->SetUniformMatrix4fv("u_modelMatrix", modelCube[i]);
-
-            if (i < 16)                             //Half of the cubes blue other red
-                cubeShader->SetUniform4fVector("u_Color", blue);
-            else cubeShader->SetUniform4fVector("u_Color", red);
-
-            //Cube becomes green when selector is on the same square
-            if (selectorCenter2.x <= cubePos.x &&
-                selectorCenter2.x + (1 / gridSize.x) >= cubePos.x &&
-                selectorCenter2.y <= cubePos.y &&
-                selectorCenter2.y + (1 / gridSize.y) >= cubePos.y) {
-                cubeShader->SetUniform4fVector("u_Color", squareColorC);
+        {
+            GpuProfiler::Scope pass(gpuProfiler.get(), "board");
+            PROFILE_ZONE("board draw");
+            chessBoardShader->Bind();
+            chessBoardShader->setUniformFloat2("u_selectorPosition", packet.selectorPosition);
+            chessBoardShader->SetUniformMatrix4fv("u_viewMatrix", viewMatrix);
+            chessBoardShader->setInt("u_SetTextures", packet.setTextures);
+            if (m_proceduralBoard) {
+                proceduralBoardVertexArray->Bind();
+                RenderCommands::DrawArrays(GL_TRIANGLES, proceduralBoardVertices);
+            }
+            for (const auto& chessBoardvertexArray : chessBoardVertexArrays) {
+                chessBoardvertexArray->Bind();
+                RenderCommands::DrawIndex(chessBoardvertexArray, GL_TRIANGLES);
             }
+        }
 
-            //Cubes becomes a different color when space is pressed on top of it
-            if (selectorCenter2.x <= cubePos.x &&
-                selectorCenter2.x + (1 / gridSize.x) >= cubePos.x &&
-                selectorCenter2.y <= cubePos.y &&
-                selectorCenter2.y + (1 / gridSize.y) >= cubePos.y &&
-                spacePressed == true && noCubeSwapp == false) {
-                cubeShader->SetUniform4fVector("u_Color", colorSelected);
-                selectedCube = i + 1;
-                noCubeSwapp = true;
+        {
+            GpuProfiler::Scope pass(gpuProfiler.get(), "pieces");
+            PROFILE_ZONE("cube draw");
+            cubeShader->Bind();
+            cubeShader->SetUniformMatrix4fv("u_viewMatrix", viewMatrix);
+            cubeShader->setInt("u_SetTextures", packet.setTextures);
+            cubeVertexArray->Bind();
+
+            for (int i = 0; i < packet.pieceCount; i++) {
+                cubeShader->SetUniformMatrix4fv("u_modelMatrix", packet.modelCube[i]);
+                cubeShader->SetUniform4fVector("u_Color", packet.cubeColors[i]);
+
+                if (pieceLOD) {
+                    //Level of detail from the size of the piece on screen, scaled like the cubes
+                    const glm::vec4 center = packet.modelCube[i] * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+                    const int level = pieceLOD->SelectLevel(renderCamera, { center.x, center.y, center.z },
+                                                            pieceLOD->GetBoundingRadius() * 4.0f, m_height);
+                    pieceLOD->GetLevel(level)->Bind();
+                    RenderCommands::DrawIndex(pieceLOD->GetLevel(level), GL_TRIANGLES);
+                }
+                else RenderCommands::DrawIndex(cubeVertexArray, GL_TRIANGLES);
             }
-            //Cube is still selected color, even when selector is not under it
-            if (spacePressed == true && selectedCube != 0 && selectedCube - 1 == i)
-                cubeShader->SetUniform4fVector("u_Color", colorSelected);
-            
-            RenderCommands::DrawIndex(cubeVertexArray, GL_TRIANGLES);
         }
 
-        glfwSwapBuffers(GLFWApplication::m_window);
+        if (!m_dumpDirectory.empty()) {
+            GpuProfiler::Scope pass(gpuProfiler.get(), "frame dump");
+            PROFILE_ZONE("frame dump");
+            if (offscreen)
+                offscreen->SaveImage(GetFrameDumpPath(frame));
+            else {
+                //The window has no framebuffer object to read from, the back buffer is copied into one
+                Framebuffer copy(GLFWApplication::m_width, GLFWApplication::m_height);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, copy.GetFramebufferID());
+                glBlitFramebuffer(0, 0, GLFWApplication::m_width, GLFWApplication::m_height,
+                                  0, 0, GLFWApplication::m_width, GLFWApplication::m_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                copy.SaveImage(GetFrameDumpPath(frame));
+            }
+        }
 
-        // Exit the loop if escape is pressed
-        if (glfwGetKey(GLFWApplication::m_window, GLFW_KEY_Q) == GLFW_PRESS) break;
-    }
+        if (gpuProfiler)
+            gpuProfiler->EndFrame();
+        RenderStats::Get().EndFrame();
+        FrameSample* sample = nullptr;
+        if (benchmark && frame >= m_benchmarkWarmUp) {
+            sample = &recorder->GetSample(frame - m_benchmarkWarmUp);
+            sample->UpdateTime = packet.updateTime;
+            sample->RenderTime = std::chrono::duration<double, std::milli>(
+                                     std::chrono::steady_clock::now() - renderStart).count();
+            sample->Counters = RenderStats::Get().GetLastFrame();
+        }
+
+        {
+            PROFILE_ZONE("swap");
+            if (offscreen)
+                glFinish();                     //Stands in for the swap, one frame is finished before the next
+            else glfwSwapBuffers(GLFWApplication::m_window);
+        }
+        {
+            PROFILE_ZONE("frame limiter");
+            frameLimiter.Wait();
+        }
+
+        const auto previousPresentTime = presentTime;
+        presentTime = std::chrono::steady_clock::now();
+        if (gpuProfiler)
+            collectGpuTimes(frame + 1 == m_frameCount);
+        if (sample) {
+            sample->FrameTime = std::chrono::duration<double, std::milli>(presentTime - previousPresentTime).count();
+            const std::uint64_t allocations = frameAllocations.GetCounters().Allocations;
+            if (allocations > 0) {
+                std::cout << allocations << " heap allocations in frame " << frame << ":\n";
+                AllocationTracker::PrintCallSites(std::cout);
+            }
+            sample->Allocations = allocations + packet.updateAllocations;
+            measuredAllocations += sample->Allocations;
+        }
+        if (benchmark) {
+            if (frame + 1 == m_frameCount) {
+                recorder->WriteJson(m_benchmarkOutput, {
+                    { "application", m_name + " " + m_version },
+                    { "renderer", reinterpret_cast<const char*>(glGetString(GL_RENDERER)) },
+                    { "glVersion", reinterpret_cast<const char*>(glGetString(GL_VERSION)) },
+                    { "resolution", std::to_string(m_width) + "x" + std::to_string(m_height) },
+                    { "headless", m_headless ? "true" : "false" },
+                    { "presentMode", m_presentMode == PresentMode::VSync ? "vsync" :
+                                     m_presentMode == PresentMode::Adaptive ? "adaptive" : "uncapped" },
+                    { "warmUpFrames", std::to_string(m_benchmarkWarmUp) },
+                    { "pieceMesh", m_pieceMeshPath },
+                    { "proceduralBoard", m_proceduralBoard ? "true" : "false" },
+                    { "allocationTracker", AllocationTracker::IsEnabled() ? "true" : "false" } });
+                std::cout << "Benchmark results written to " << m_benchmarkOutput << std::endl;
+                if (measuredAllocations > 0)
+                    std::cout << "Benchmark failed: " << measuredAllocations << " heap allocations after the warm-up, "
+                              << "frames must not allocate" << std::endl;
+            }
+        }
 
-    return EXIT_SUCCESS;
+        //Closing the window wakes the game loop on the main thread, which stops this thread
+        if (++frame == m_frameCount) {
+            glfwSetWindowShouldClose(GLFWApplication::m_window, GLFW_TRUE);
+            glfwPostEmptyEvent();
+        }
+    }
+    return measuredAllocations == 0;
 }
 
 
@@ -1,14 +1,46 @@
 #ifndef AssignmentApplication_H_
 #define AssignmentApplication_H_
 #include <GLFWApplication.h>
+#include <FrameMailbox.h>
+#include <MeshData.h>
+#include <ChessTypes.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class RenderThread;
+struct FramePacket;
 
 class Assignment : public GLFWApplication {
 public:
 	Assignment(const std::string name, const std::string version);
 	~Assignment();
 	virtual unsigned int ParseArguments(int argc, char** argv);
+	virtual void AddArguments(TCLAP::CmdLine& cmd) override;
 	virtual unsigned Init();
 	virtual unsigned Run() const override;
+
+private:
+	bool RenderLoop(const RenderThread& thread, FrameMailbox<FramePacket>& mailbox,
+					const glm::vec2& gridSize, const std::vector<MeshData>& pieceChain) const;
+
+	TCLAP::ValueArg<std::string> m_pieceMeshArg;
+	TCLAP::SwitchArg m_proceduralBoardArg;
+	TCLAP::ValueArg<std::string> m_computerArg;
+	TCLAP::ValueArg<int> m_computerTimeArg;
+	TCLAP::ValueArg<int> m_computerThreadsArg;
+	TCLAP::ValueArg<int> m_computerHashArg;
+	TCLAP::ValueArg<std::string> m_computerNetArg;
+	TCLAP::ValueArg<std::string> m_computerBookArg;
+	TCLAP::ValueArg<std::string> m_computerTablebasesArg;
+	std::string m_pieceMeshPath;	// Mesh file drawn instead of the cubes
+	bool m_proceduralBoard;			// Board generated in the vertex shader, without vertex buffers
+	Color m_computerColor;			// Side the engine plays, ColorCount when both sides play from the keyboard
+	int m_computerTime;				// Milliseconds the engine thinks about a move
+	int m_computerThreads;			// Threads the engine searches with
+	int m_computerHash;				// MB of transposition table the engine searches with
+	std::string m_computerNetPath;	// Network file the engine evaluates with instead of the handcrafted evaluation
+	std::string m_computerBookPath;	// Polyglot book the engine plays its moves from while it has them
+	std::string m_computerTablebasesPath;	// Tablebase file the engine scores the endings it has with
 };
 
 #endif
\ No newline at end of file
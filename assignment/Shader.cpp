@@ -28,6 +28,32 @@ void main()
 }
 )";
 
+// Vertex shader of the procedural chessboard, drawn with glDrawArrays and an empty vertex array.
+// Every square is two triangles, six vertices, with the corners derived from gl_VertexID so
+// the board has the same positions and texture coordinates as UnitGridGeometry2DWTCoords
+const std::string proceduralChessBoardShaderSrc = R"(
+#version 460 core
+
+out vec2 vsTexCoords;
+uniform mat4 u_modelMatrix;
+uniform mat4 u_viewMatrix;
+uniform mat4 u_projMatrix;
+uniform vec2 u_gridSize;
+out vec2 positionGrid;
+const ivec2 corners[6] = ivec2[6](ivec2(0, 0), ivec2(1, 0), ivec2(1, 1),
+                                  ivec2(0, 0), ivec2(1, 1), ivec2(0, 1));
+void main()
+{ 
+    int square = gl_VertexID / 6;
+    int columns = int(u_gridSize.x);
+    ivec2 corner = ivec2(square % columns, square / columns) + corners[gl_VertexID % 6];
+    vec2 position = vec2(corner) / u_gridSize - 0.5f;
+    positionGrid = position;
+    gl_Position = u_projMatrix * u_viewMatrix * u_modelMatrix * vec4(position, 0.0, 1.0);
+    vsTexCoords = position + 1.0f;
+}
+)";
+
 // Fragment shader code
 const std::string chessBoardFragmentShaderSrc = R"(
 #version 460 core
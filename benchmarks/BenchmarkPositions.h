@@ -0,0 +1,45 @@
+/**
+* @file BenchmarkPositions.h
+*
+* @brief Positions the chess benchmarks share: the six positions of the usual perft
+*        suite, which cover castling, en passant, promotions and checks, and walking
+*        the move tree below them.
+*
+* @author Aleksander Solhaug
+*/
+
+#ifndef BENCHMARKPOSITIONS_H_
+#define BENCHMARKPOSITIONS_H_
+
+#include <MoveGen.h>
+
+#include <vector>
+
+namespace BenchmarkPositions {
+	const char* const StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+	const char* const KiwipeteFen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+	const char* const Position3Fen = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
+	const char* const Position4Fen = "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1";
+	const char* const Position5Fen = "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8";
+	const char* const Position6Fen = "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10";
+
+	const char* const PerftFens[] = { StartFen, KiwipeteFen, Position3Fen, Position4Fen, Position5Fen, Position6Fen };
+
+	//Adds the position and every position up to depth plies below it
+	inline void Collect(Position& position, int depth, std::vector<Position>& positions)
+	{
+		positions.push_back(position);
+		if (depth == 0)
+			return;
+		MoveList moves;
+		GenerateLegalMoves(position, moves);
+		for (const Move move : moves) {
+			MoveUndo undo;
+			position.MakeMove(move, undo);
+			Collect(position, depth - 1, positions);
+			position.UnmakeMove(move, undo);
+		}
+	}
+}
+
+#endif // BENCHMARKPOSITIONS_H_
@@ -0,0 +1,132 @@
+/**
+* @file EvalBench.cpp
+*
+* @brief Evaluation benchmark. Compares the evaluation from the sums the positions
+*        keep up to date as they move against summing all pieces of every position:
+*        once over a set of stored positions, which times the evaluation alone, and
+*        once walking the move tree with an evaluation at every node, which also
+*        pays for keeping the sums in make and unmake. The evaluations of a walk are
+*        checked against the full ones, the run fails when any differs.
+*
+* Usage: evalbench [--depth 4] [--repeat 20]
+*
+* @author Aleksander Solhaug
+*/
+
+#include "BenchmarkPositions.h"
+
+#include <Evaluate.h>
+#include <MoveGen.h>
+#include <tclap/CmdLine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace {
+	/**
+	* @brief Walks the move tree and evaluates every node
+	*
+	* @param full - Whether to evaluate by summing all pieces instead of from the kept sums
+	* @param sum - Sum of all evaluations, so the compiler can not leave them out
+	* @param mismatches - Counts the nodes where the two evaluations differ, when not null
+	* @return std::uint64_t - Nodes evaluated
+	*/
+	std::uint64_t Walk(Position& position, int depth, bool full, std::int64_t& sum, std::uint64_t* mismatches)
+	{
+		const int score = full ? EvaluateFull(position) : Evaluate(position);
+		sum += score;
+		if (mismatches && score != EvaluateFull(position))
+			(*mismatches)++;
+		if (depth == 0)
+			return 1;
+		std::uint64_t nodes = 1;
+		MoveList moves;
+		GenerateLegalMoves(position, moves);
+		for (const Move move : moves) {
+			MoveUndo undo;
+			position.MakeMove(move, undo);
+			nodes += Walk(position, depth - 1, full, sum, mismatches);
+			position.UnmakeMove(move, undo);
+		}
+		return nodes;
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int depth = 0;
+	int repeat = 0;
+	try {
+		TCLAP::CmdLine cmd("Times the incrementally kept evaluation against summing all pieces", ' ', "1.0");
+		TCLAP::ValueArg<int> depthArg("d", "depth", "Depth of the move trees walked from every position", false, 4, "int");
+		TCLAP::ValueArg<int> repeatArg("r", "repeat", "Times the stored positions are evaluated", false, 20, "int");
+		cmd.add(depthArg);
+		cmd.add(repeatArg);
+		cmd.parse(argc, argv);
+		depth = std::max(0, depthArg.getValue());
+		repeat = std::max(1, repeatArg.getValue());
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Position> roots(std::size(BenchmarkPositions::PerftFens));
+	for (std::size_t i = 0; i < roots.size(); i++)
+		roots[i].SetFen(BenchmarkPositions::PerftFens[i]);
+
+	//The stored positions are a shallower tree, they would not fit in memory at the depth of the walk
+	std::vector<Position> positions;
+	for (Position root : roots)
+		BenchmarkPositions::Collect(root, std::min(depth, 3), positions);
+
+	std::printf("%-22s %14s %9s %12s\n", "", "evaluations", "seconds", "Mevals/s");
+	std::int64_t sums[2] = { 0, 0 };
+	double rates[2][2] = {};
+	for (const bool full : { false, true }) {
+		const auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeat; r++)
+			for (const Position& position : positions)
+				sums[full] += full ? EvaluateFull(position) : Evaluate(position);
+		const double seconds = SecondsSince(start);
+		const double evaluations = static_cast<double>(positions.size()) * repeat;
+		rates[0][full] = evaluations / std::max(seconds, 1e-9);
+		std::printf("%-22s %14.0f %9.3f %12.2f\n", full ? "stored, full" : "stored, incremental", evaluations, seconds,
+					rates[0][full] / 1e6);
+	}
+	for (const bool full : { false, true }) {
+		std::uint64_t nodes = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (Position root : roots)
+			nodes += Walk(root, depth, full, sums[full], nullptr);
+		const double seconds = SecondsSince(start);
+		rates[1][full] = nodes / std::max(seconds, 1e-9);
+		std::printf("%-22s %14llu %9.3f %12.2f\n", full ? "tree walk, full" : "tree walk, incremental",
+					static_cast<unsigned long long>(nodes), seconds, rates[1][full] / 1e6);
+	}
+	std::printf("incremental is %.2fx as fast on stored positions, %.2fx in the tree walk\n",
+				rates[0][0] / rates[0][1], rates[1][0] / rates[1][1]);
+
+	std::uint64_t mismatches = 0;
+	std::int64_t checkSum = 0;
+	for (Position root : roots)
+		Walk(root, std::min(depth, 3), false, checkSum, &mismatches);
+	if (sums[0] != sums[1] || mismatches > 0) {
+		std::printf("MISMATCH: %llu positions evaluate differently from the full sum\n",
+					static_cast<unsigned long long>(mismatches));
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+/**
+* @file GridGeneration.cpp
+*
+* @brief Benchmark of the grid generation in GeometricTools, comparing the
+*        single threaded UnitGridGeometry2DWTCoords + UnitGridTopologyTriangles
+*        with the parallel tiled UnitGridTiles, for grids from 8x8 to 4096x4096.
+*
+* Usage: gridbench [threads]
+*
+* @author Aleksander Solhaug
+*/
+
+#include <GeometricTools.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <functional>
+
+/**
+* @brief Runs the function until enough time has passed to get a stable average
+*
+* @param function - Function to time
+* @return milliseconds - Average time of one call
+*/
+static double TimeMilliseconds(const std::function<void()>& function)
+{
+	using Clock = std::chrono::steady_clock;
+	int repetitions = 0;
+	const auto start = Clock::now();
+	auto elapsed = Clock::duration::zero();
+	do {
+		function();
+		repetitions++;
+		elapsed = Clock::now() - start;
+	} while (elapsed < std::chrono::milliseconds(200) && repetitions < 1000);
+	return std::chrono::duration<double, std::milli>(elapsed).count() / repetitions;
+}
+
+/**
+* @brief Checks that the tiles hold the same vertices as the single threaded grid
+*/
+static bool TilesMatchGrid(std::size_t size)
+{
+	const auto grid = GeometricTools::UnitGridGeometry2DWTCoords(size, size);
+	const auto tiles = GeometricTools::UnitGridTiles(size, size);
+	for (const auto& tile : tiles) {
+		std::size_t v = 0;
+		for (std::size_t i = tile.firstRow; i <= tile.firstRow + tile.rows; i++) {
+			for (std::size_t j = tile.firstColumn; j <= tile.firstColumn + tile.columns; j++) {
+				for (std::size_t f = 0; f < 4; f++) {
+					if (tile.vertices[v++] != grid[((size + 1) * i + j) * 4 + f])
+						return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned threads = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1]))
+									  : std::max(1u, std::thread::hardware_concurrency());
+	const std::size_t sizes[] = { 8, 64, 256, 1024, 2048, 4096 };
+
+	for (std::size_t size : { std::size_t(8), std::size_t(300), std::size_t(600) }) {
+		if (!TilesMatchGrid(size)) {
+			std::printf("Tiled grid %zux%zu does not match UnitGridGeometry2DWTCoords\n", size, size);
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::printf("%-11s %12s %6s %12s %12s %12s %10s\n", "grid", "vertices", "tiles",
+				"scalar ms", "tiled 1T ms", "tiled ms", "Mvert/s");
+	for (std::size_t size : sizes) {
+		const double vertices = double(size + 1) * double(size + 1);
+		const std::size_t tilesPerSide = (size + GeometricTools::MaxTileSquares - 1) / GeometricTools::MaxTileSquares;
+		const std::size_t tileCount = tilesPerSide * tilesPerSide;
+
+		const double scalar = TimeMilliseconds([&]() {
+			auto geometry = GeometricTools::UnitGridGeometry2DWTCoords(size, size);
+			auto topology = GeometricTools::UnitGridTopologyTriangles(size, size);
+		});
+		const double tiledSingle = TimeMilliseconds([&]() {
+			auto tiles = GeometricTools::UnitGridTiles(size, size, true, 1);
+		});
+		const double tiled = TimeMilliseconds([&]() {
+			auto tiles = GeometricTools::UnitGridTiles(size, size, true, threads);
+		});
+
+		char grid[32];
+		std::snprintf(grid, sizeof(grid), "%zux%zu", size, size);
+		std::printf("%-11s %12.0f %6zu %12.3f %12.3f %12.3f %10.1f\n", grid, vertices, tileCount,
+					scalar, tiledSingle, tiled, vertices / (tiled * 1000.0));
+	}
+	return EXIT_SUCCESS;
+}
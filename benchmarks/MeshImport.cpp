@@ -0,0 +1,166 @@
+/**
+* @file MeshImport.cpp
+*
+* @brief Benchmark of the OBJ and glTF binary importers in MB/s, single threaded
+*        and with all hardware threads. Without arguments a large OBJ and GLB
+*        sphere are generated in the working directory and imported.
+*
+* Usage: importbench [mesh.obj|mesh.glb ...]
+*
+* @author Aleksander Solhaug
+*/
+
+#include <MeshImporter.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	constexpr int Rings = 1200, Segments = 2400;	// ~2.9M vertices, ~200 MB as OBJ
+
+	//Vertex (x, y, z, u, v, nx, ny, nz) of a unit sphere
+	void SphereVertex(int ring, int segment, float* out)
+	{
+		const double theta = 3.14159265358979 * ring / Rings;
+		const double phi = 2.0 * 3.14159265358979 * segment / Segments;
+		out[0] = out[5] = static_cast<float>(std::sin(theta) * std::cos(phi));
+		out[1] = out[6] = static_cast<float>(std::cos(theta));
+		out[2] = out[7] = static_cast<float>(std::sin(theta) * std::sin(phi));
+		out[3] = static_cast<float>(segment) / Segments;
+		out[4] = static_cast<float>(ring) / Rings;
+	}
+
+	std::uint32_t SphereIndex(int ring, int segment) { return ring * (Segments + 1) + segment; }
+
+	void WriteSphereOBJ(const std::string& path)
+	{
+		std::FILE* file = std::fopen(path.c_str(), "wb");
+		if (!file)
+			return;
+		float v[8];
+		for (int r = 0; r <= Rings; r++)
+			for (int s = 0; s <= Segments; s++) {
+				SphereVertex(r, s, v);
+				std::fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+					v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+			}
+		for (int r = 0; r < Rings; r++)
+			for (int s = 0; s < Segments; s++) {
+				const auto a = SphereIndex(r, s) + 1, b = a + 1, c = SphereIndex(r + 1, s) + 1, d = c + 1;
+				std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, c, c, c, d, d, d, b, b, b);
+			}
+		std::fclose(file);
+	}
+
+	void WriteSphereGLB(const std::string& path)
+	{
+		std::vector<float> positions, texCoords, normals;
+		float v[8];
+		for (int r = 0; r <= Rings; r++)
+			for (int s = 0; s <= Segments; s++) {
+				SphereVertex(r, s, v);
+				positions.insert(positions.end(), v, v + 3);
+				texCoords.insert(texCoords.end(), v + 3, v + 5);
+				normals.insert(normals.end(), v + 5, v + 8);
+			}
+		std::vector<std::uint32_t> indices;
+		for (int r = 0; r < Rings; r++)
+			for (int s = 0; s < Segments; s++) {
+				const auto a = SphereIndex(r, s), b = a + 1, c = SphereIndex(r + 1, s), d = c + 1;
+				indices.insert(indices.end(), { a, c, d, a, d, b });
+			}
+
+		const std::size_t vertexCount = positions.size() / 3;
+		const std::size_t positionBytes = positions.size() * 4, texCoordBytes = texCoords.size() * 4;
+		const std::size_t normalBytes = normals.size() * 4, indexBytes = indices.size() * 4;
+		const std::size_t binSize = positionBytes + texCoordBytes + normalBytes + indexBytes;
+		const std::string json =
+			"{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],"
+			"\"nodes\":[{\"mesh\":0}],\"meshes\":[{\"primitives\":[{\"attributes\":"
+			"{\"POSITION\":0,\"TEXCOORD_0\":1,\"NORMAL\":2},\"indices\":3}]}],"
+			"\"buffers\":[{\"byteLength\":" + std::to_string(binSize) + "}],\"bufferViews\":["
+			"{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(positionBytes) + "},"
+			"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes) + ",\"byteLength\":" + std::to_string(texCoordBytes) + "},"
+			"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes + texCoordBytes) + ",\"byteLength\":" + std::to_string(normalBytes) + "},"
+			"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes + texCoordBytes + normalBytes) + ",\"byteLength\":" + std::to_string(indexBytes) + "}],"
+			"\"accessors\":["
+			"{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+			"{\"bufferView\":1,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC2\"},"
+			"{\"bufferView\":2,\"componentType\":5126,\"count\":" + std::to_string(vertexCount) + ",\"type\":\"VEC3\"},"
+			"{\"bufferView\":3,\"componentType\":5125,\"count\":" + std::to_string(indices.size()) + ",\"type\":\"SCALAR\"}]}";
+		const std::uint32_t jsonLength = static_cast<std::uint32_t>((json.size() + 3) & ~std::size_t(3));
+		const std::uint32_t binLength = static_cast<std::uint32_t>(binSize);
+
+		std::ofstream file(path, std::ios::binary);
+		auto write32 = [&](std::uint32_t value) { file.write(reinterpret_cast<const char*>(&value), 4); };
+		write32(0x46546C67);
+		write32(2);
+		write32(12 + 8 + jsonLength + 8 + binLength);
+		write32(jsonLength);
+		write32(0x4E4F534A);
+		file.write(json.data(), json.size());
+		for (std::size_t i = json.size(); i < jsonLength; i++)
+			file.put(' ');
+		write32(binLength);
+		write32(0x004E4942);
+		file.write(reinterpret_cast<const char*>(positions.data()), positionBytes);
+		file.write(reinterpret_cast<const char*>(texCoords.data()), texCoordBytes);
+		file.write(reinterpret_cast<const char*>(normals.data()), normalBytes);
+		file.write(reinterpret_cast<const char*>(indices.data()), indexBytes);
+	}
+
+	double FileMegabytes(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		return file ? static_cast<double>(file.tellg()) / (1024.0 * 1024.0) : 0.0;
+	}
+
+	bool Benchmark(const std::string& path, unsigned threads)
+	{
+		const bool glb = path.size() > 4 && path.compare(path.size() - 4, 4, ".glb") == 0;
+		const double megabytes = FileMegabytes(path);
+		for (unsigned threadCount : { 1u, threads }) {
+			MeshData mesh;
+			const auto start = std::chrono::steady_clock::now();
+			const bool imported = glb ? MeshImporter::ImportGLB(path, mesh, threadCount)
+									  : MeshImporter::ImportOBJ(path, mesh, threadCount);
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (!imported)
+				return false;
+			std::printf("%-24s %8.1f MB %3u threads %9.3f s %9.1f MB/s %10zu vertices %10zu triangles\n",
+				path.c_str(), megabytes, threadCount, seconds, megabytes / seconds,
+				mesh.GetVertexCount(), mesh.GetTriangleCount());
+			if (threads == 1)
+				break;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::string> paths(argv + 1, argv + argc);
+	if (paths.empty()) {
+		paths = { "importbench_sphere.obj", "importbench_sphere.glb" };
+		std::printf("Generating %s and %s\n", paths[0].c_str(), paths[1].c_str());
+		WriteSphereOBJ(paths[0]);
+		WriteSphereGLB(paths[1]);
+	}
+
+	for (const auto& path : paths) {
+		if (!Benchmark(path, threads)) {
+			std::printf("Failed to import %s\n", path.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
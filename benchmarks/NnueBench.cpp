@@ -0,0 +1,208 @@
+/**
+* @file NnueBench.cpp
+*
+* @brief Network evaluation benchmark. Times the inferences per second of every
+*        instruction set the processor supports, once over a set of stored positions
+*        with their accumulators computed in advance, which times the dense layers
+*        alone, and once walking the move tree with the accumulators updated by every
+*        move and an evaluation at every node. The handcrafted evaluation is timed
+*        the same way for comparison. Every instruction set has to give the same
+*        evaluations, and the accumulators of the walk have to match ones computed
+*        from all pieces, the run fails otherwise.
+*
+* Usage: nnuebench [--net chess.nnue] [--depth 3] [--repeat 100]
+*
+* Without --net a network of seeded noise is written to the temporary directory and timed.
+*
+* @author Aleksander Solhaug
+*/
+
+#include "BenchmarkPositions.h"
+
+#include <Evaluate.h>
+#include <MoveGen.h>
+#include <Nnue.h>
+#include <tclap/CmdLine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+	/**
+	* @brief Walks the move tree and evaluates every node, with the network when there
+	*        are accumulators and with the handcrafted evaluation when there are not
+	*
+	* @param sum - Sum of all evaluations, so the compiler can not leave them out
+	* @param mismatches - Counts the nodes where the kept accumulator differs from a
+	*                     refreshed one, when not null
+	* @return std::uint64_t - Nodes evaluated
+	*/
+	std::uint64_t Walk(Position& position, int depth, const Nnue::Network& network, Nnue::AccumulatorStack* accumulators,
+					   std::int64_t& sum, std::uint64_t* mismatches)
+	{
+		sum += accumulators ? accumulators->Evaluate(position) : Evaluate(position);
+		if (mismatches) {
+			Nnue::Accumulator fresh;
+			network.Refresh(position, White, fresh);
+			network.Refresh(position, Black, fresh);
+			const Nnue::Accumulator& kept = accumulators->Top();
+			if (std::memcmp(fresh.Values, kept.Values, sizeof(fresh.Values)) != 0 ||
+				std::memcmp(fresh.Psqt, kept.Psqt, sizeof(fresh.Psqt)) != 0)
+				(*mismatches)++;
+		}
+		if (depth == 0)
+			return 1;
+		std::uint64_t nodes = 1;
+		MoveList moves;
+		GenerateLegalMoves(position, moves);
+		for (const Move move : moves) {
+			MoveUndo undo;
+			position.MakeMove(move, undo);
+			if (accumulators)
+				accumulators->Push(position, move, undo);
+			nodes += Walk(position, depth - 1, network, accumulators, sum, mismatches);
+			if (accumulators)
+				accumulators->Pop();
+			position.UnmakeMove(move, undo);
+		}
+		return nodes;
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string netPath;
+	int depth = 0;
+	int repeat = 0;
+	try {
+		TCLAP::CmdLine cmd("Times network evaluations per second on every supported instruction set", ' ', "1.0");
+		TCLAP::ValueArg<std::string> netArg("n", "net", "Network file to time instead of a generated one", false, "", "path");
+		TCLAP::ValueArg<int> depthArg("d", "depth", "Depth of the move trees walked from every position", false, 3, "int");
+		TCLAP::ValueArg<int> repeatArg("r", "repeat", "Times the stored positions are evaluated", false, 100, "int");
+		cmd.add(netArg);
+		cmd.add(depthArg);
+		cmd.add(repeatArg);
+		cmd.parse(argc, argv);
+		netPath = netArg.getValue();
+		depth = std::max(0, depthArg.getValue());
+		repeat = std::max(1, repeatArg.getValue());
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	//A generated network has noise in every layer, so every layer changes the evaluations the instruction sets are compared by
+	const bool generated = netPath.empty();
+	if (generated) {
+		netPath = (std::filesystem::temp_directory_path() / "nnuebench.nnue").string();
+		if (!Nnue::Network::Write(netPath, Nnue::NetworkWeights::Generate(1, 4)))
+			return EXIT_FAILURE;
+	}
+	Nnue::Network network;
+	const bool loaded = network.Load(netPath);
+	if (generated)
+		std::filesystem::remove(netPath);
+	if (!loaded)
+		return EXIT_FAILURE;
+
+	std::vector<Position> roots(std::size(BenchmarkPositions::PerftFens));
+	for (std::size_t i = 0; i < roots.size(); i++)
+		roots[i].SetFen(BenchmarkPositions::PerftFens[i]);
+
+	//Few enough stored positions for their accumulators to stay in the cache, which leaves the dense layers to be timed
+	std::vector<Position> positions;
+	for (Position root : roots)
+		BenchmarkPositions::Collect(root, std::min(depth, 2), positions);
+	std::vector<Nnue::Accumulator> accumulators(positions.size());
+	for (std::size_t i = 0; i < positions.size(); i++) {
+		network.Refresh(positions[i], White, accumulators[i]);
+		network.Refresh(positions[i], Black, accumulators[i]);
+	}
+
+	std::printf("network \"%s\", %zu stored positions, tree walks of depth %d\n", network.GetDescription(),
+				positions.size(), depth);
+	std::printf("%-12s %14s %9s %12s %14s %9s %12s\n", "", "inferences", "seconds", "Minf/s", "walk nodes", "seconds",
+				"Mnodes/s");
+
+	//The handcrafted evaluation keeps its sums in the position, it has nothing to time apart from the walk
+	{
+		std::int64_t sum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeat; r++)
+			for (const Position& position : positions)
+				sum += Evaluate(position);
+		const double seconds = SecondsSince(start);
+		const double evaluations = static_cast<double>(positions.size()) * repeat;
+		std::uint64_t nodes = 0;
+		start = std::chrono::steady_clock::now();
+		for (Position root : roots)
+			nodes += Walk(root, depth, network, nullptr, sum, nullptr);
+		const double walkSeconds = SecondsSince(start);
+		std::printf("%-12s %14.0f %9.3f %12.2f %14llu %9.3f %12.2f\n", "handcrafted", evaluations, seconds,
+					evaluations / std::max(seconds, 1e-9) / 1e6, static_cast<unsigned long long>(nodes), walkSeconds,
+					nodes / std::max(walkSeconds, 1e-9) / 1e6);
+	}
+
+	const Nnue::SimdLevel supported = Nnue::GetSupportedSimdLevel();
+	std::vector<std::int64_t> storedSums, walkSums;
+	Nnue::AccumulatorStack stack;
+	for (int level = Nnue::ScalarSimd; level <= supported; level++) {
+		Nnue::SetSimdLevel(static_cast<Nnue::SimdLevel>(level));
+		std::int64_t sum = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeat; r++)
+			for (std::size_t i = 0; i < positions.size(); i++)
+				sum += network.Evaluate(accumulators[i], positions[i].GetSideToMove());
+		const double seconds = SecondsSince(start);
+		const double evaluations = static_cast<double>(positions.size()) * repeat;
+		storedSums.push_back(sum);
+
+		sum = 0;
+		std::uint64_t nodes = 0;
+		start = std::chrono::steady_clock::now();
+		for (Position root : roots) {
+			stack.Reset(network, root);
+			nodes += Walk(root, depth, network, &stack, sum, nullptr);
+		}
+		const double walkSeconds = SecondsSince(start);
+		walkSums.push_back(sum);
+		std::printf("%-12s %14.0f %9.3f %12.2f %14llu %9.3f %12.2f\n", Nnue::GetSimdName(static_cast<Nnue::SimdLevel>(level)),
+					evaluations, seconds, evaluations / std::max(seconds, 1e-9) / 1e6,
+					static_cast<unsigned long long>(nodes), walkSeconds, nodes / std::max(walkSeconds, 1e-9) / 1e6);
+	}
+
+	std::uint64_t mismatches = 0;
+	std::int64_t checkSum = 0;
+	for (Position root : roots) {
+		stack.Reset(network, root);
+		Walk(root, std::min(depth, 3), network, &stack, checkSum, &mismatches);
+	}
+	bool failed = false;
+	for (std::size_t i = 1; i < storedSums.size(); i++)
+		if (storedSums[i] != storedSums[0] || walkSums[i] != walkSums[0]) {
+			std::printf("MISMATCH: %s evaluates differently from scalar\n", Nnue::GetSimdName(static_cast<Nnue::SimdLevel>(i)));
+			failed = true;
+		}
+	if (mismatches > 0) {
+		std::printf("MISMATCH: %llu accumulators differ from the ones computed from all pieces\n",
+					static_cast<unsigned long long>(mismatches));
+		failed = true;
+	}
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/**
+* @file Perft.cpp
+*
+* @brief Move generation benchmark. Counts the leaf nodes of the move tree of the
+*        standard perft positions, checks them against the known counts and
+*        reports the nodes per second. The root moves are split over a pool of
+*        threads, and the hash mode caches subtree counts in a table shared by
+*        all threads.
+*
+* Usage: perft [--depth 5] [--threads 8] [--hash 256] [--fen "<fen>" --divide]
+*
+* Without --depth every position is counted to the depth its reference count is
+* listed for. A --fen position has no reference count and is only timed.
+*
+* @author Aleksander Solhaug
+*/
+
+#include "BenchmarkPositions.h"
+
+#include <MoveGen.h>
+#include <tclap/CmdLine.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	struct PerftPosition {
+		const char* Name;
+		const char* Fen;
+		int DefaultDepth;
+		std::vector<std::uint64_t> Counts;	//Leaf nodes from depth 1 up
+	};
+
+	const PerftPosition Positions[] = {
+		{ "start", BenchmarkPositions::StartFen, 6,
+		  { 20, 400, 8902, 197281, 4865609, 119060324, 3195901860ULL } },
+		{ "kiwipete", BenchmarkPositions::KiwipeteFen, 5,
+		  { 48, 2039, 97862, 4085603, 193690690, 8031647685ULL } },
+		{ "position3", BenchmarkPositions::Position3Fen, 7,
+		  { 14, 191, 2812, 43238, 674624, 11030083, 178633661, 3009794393ULL } },
+		{ "position4", BenchmarkPositions::Position4Fen, 5,
+		  { 6, 264, 9467, 422333, 15833292, 706045033 } },
+		{ "position5", BenchmarkPositions::Position5Fen, 5,
+		  { 44, 1486, 62379, 2103487, 89941194 } },
+		{ "position6", BenchmarkPositions::Position6Fen, 5,
+		  { 46, 2079, 89890, 3894594, 164075551, 6923051137ULL } },
+	};
+
+	/**
+	* @brief Subtree counts shared by all threads without locks. An entry stores the key
+	*        XORed with its data next to the data, so an entry torn by two threads writing
+	*        at once fails the key check instead of returning a wrong count.
+	*/
+	class PerftTable {
+	public:
+		explicit PerftTable(std::size_t megabytes)
+		{
+			std::size_t count = 1;
+			while (count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024)
+				count *= 2;
+			Entries = std::make_unique<Entry[]>(count);
+			Mask = count - 1;
+		}
+
+		//The data packs the depth into the low 8 bits and the count above it
+		bool Probe(std::uint64_t key, int depth, std::uint64_t& count) const
+		{
+			const Entry& entry = Entries[key & Mask];
+			const std::uint64_t data = entry.Data.load(std::memory_order_relaxed);
+			if ((entry.Check.load(std::memory_order_relaxed) ^ data) != key || static_cast<int>(data & 0xFF) != depth)
+				return false;
+			count = data >> 8;
+			return true;
+		}
+
+		void Store(std::uint64_t key, int depth, std::uint64_t count)
+		{
+			Entry& entry = Entries[key & Mask];
+			const std::uint64_t data = count << 8 | static_cast<std::uint64_t>(depth);
+			entry.Check.store(key ^ data, std::memory_order_relaxed);
+			entry.Data.store(data, std::memory_order_relaxed);
+		}
+
+	private:
+		struct Entry {
+			std::atomic<std::uint64_t> Check{ 0 };
+			std::atomic<std::uint64_t> Data{ 0 };
+		};
+
+		std::unique_ptr<Entry[]> Entries;
+		std::size_t Mask = 0;
+	};
+
+	std::uint64_t Perft(Position& position, int depth, PerftTable* table)
+	{
+		MoveList moves;
+		GenerateLegalMoves(position, moves);
+		if (depth == 1)
+			return moves.GetSize();
+
+		std::uint64_t key = 0, nodes = 0;
+		if (table) {
+			key = position.GetKey();
+			if (table->Probe(key, depth, nodes))
+				return nodes;
+		}
+		for (const Move move : moves) {
+			MoveUndo undo;
+			position.MakeMove(move, undo);
+			nodes += Perft(position, depth - 1, table);
+			position.UnmakeMove(move, undo);
+		}
+		if (table)
+			table->Store(key, depth, nodes);
+		return nodes;
+	}
+
+	/**
+	* @brief Counts the nodes below every root move, the threads take the next root
+	*        move not counted yet until all are done
+	*/
+	std::uint64_t SplitPerft(const Position& root, int depth, unsigned threadCount, PerftTable* table,
+							 std::vector<std::uint64_t>* divide)
+	{
+		MoveList moves;
+		GenerateLegalMoves(root, moves);
+		if (depth <= 1) {
+			if (divide)
+				divide->assign(moves.GetSize(), 1);
+			return depth == 1 ? moves.GetSize() : 1;
+		}
+
+		std::vector<std::uint64_t> counts(moves.GetSize(), 0);
+		std::atomic<int> next(0);
+		auto worker = [&]() {
+			Position position = root;
+			for (int i = next++; i < moves.GetSize(); i = next++) {
+				MoveUndo undo;
+				position.MakeMove(moves.Moves[i], undo);
+				counts[i] = Perft(position, depth - 1, table);
+				position.UnmakeMove(moves.Moves[i], undo);
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+		worker();
+		for (std::thread& thread : threads)
+			thread.join();
+
+		std::uint64_t nodes = 0;
+		for (const std::uint64_t count : counts)
+			nodes += count;
+		if (divide)
+			*divide = counts;
+		return nodes;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int depth = 0;
+	unsigned threads = 1;
+	std::size_t hashMegabytes = 0;
+	std::string fen;
+	bool divide = false;
+	try {
+		TCLAP::CmdLine cmd("Counts the move tree of the perft positions and reports nodes per second", ' ', "1.0");
+		TCLAP::ValueArg<int> depthArg("d", "depth", "Depth to count every position to", false, 0, "int");
+		TCLAP::ValueArg<unsigned> threadsArg("t", "threads", "Threads the root moves are split over, 0 for all cores",
+			false, 1, "int");
+		TCLAP::ValueArg<std::size_t> hashArg("", "hash", "MB of shared table caching subtree counts, 0 to count every node",
+			false, 0, "MB");
+		TCLAP::ValueArg<std::string> fenArg("f", "fen", "Position to count instead of the standard ones", false, "", "fen");
+		TCLAP::SwitchArg divideArg("", "divide", "Print the count below every root move");
+
+		cmd.add(depthArg);
+		cmd.add(threadsArg);
+		cmd.add(hashArg);
+		cmd.add(fenArg);
+		cmd.add(divideArg);
+		cmd.parse(argc, argv);
+
+		depth = depthArg.getValue();
+		threads = threadsArg.getValue();
+		hashMegabytes = hashArg.getValue();
+		fen = fenArg.getValue();
+		divide = divideArg.getValue();
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<PerftPosition> positions(std::begin(Positions), std::end(Positions));
+	if (!fen.empty())
+		positions = { { "fen", fen.c_str(), 5, {} } };
+
+	std::printf("%u threads, %s\n", threads,
+				hashMegabytes ? (std::to_string(hashMegabytes) + " MB hash").c_str() : "no hash");
+	std::printf("%-10s %5s %14s %14s %9s %9s\n", "position", "depth", "nodes", "expected", "seconds", "Mnps");
+
+	bool passed = true;
+	std::uint64_t totalNodes = 0;
+	double totalSeconds = 0.0;
+	for (const PerftPosition& entry : positions) {
+		Position position;
+		if (!position.SetFen(entry.Fen)) {
+			std::printf("Invalid FEN %s\n", entry.Fen);
+			return EXIT_FAILURE;
+		}
+		const int positionDepth = depth > 0 ? depth : entry.DefaultDepth;
+
+		//Every position starts from an empty table, so the counts of one do not speed up the next
+		std::unique_ptr<PerftTable> table;
+		if (hashMegabytes > 0)
+			table = std::make_unique<PerftTable>(hashMegabytes);
+
+		std::vector<std::uint64_t> rootCounts;
+		const auto start = std::chrono::steady_clock::now();
+		const std::uint64_t nodes = SplitPerft(position, positionDepth, threads, table.get(), divide ? &rootCounts : nullptr);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		totalNodes += nodes;
+		totalSeconds += seconds;
+
+		if (divide) {
+			MoveList moves;
+			GenerateLegalMoves(position, moves);
+			for (int i = 0; i < moves.GetSize(); i++)
+				std::printf("  %-6s %14llu\n", moves.Moves[i].ToUci().c_str(), static_cast<unsigned long long>(rootCounts[i]));
+		}
+
+		const bool known = positionDepth >= 1 && positionDepth <= static_cast<int>(entry.Counts.size());
+		const std::uint64_t expected = known ? entry.Counts[positionDepth - 1] : 0;
+		std::printf("%-10s %5d %14llu %14s %9.3f %9.1f%s\n", entry.Name, positionDepth,
+					static_cast<unsigned long long>(nodes), known ? std::to_string(expected).c_str() : "-",
+					seconds, nodes / std::max(seconds, 1e-9) / 1e6, known && nodes != expected ? "  MISMATCH" : "");
+		passed &= !known || nodes == expected;
+	}
+
+	std::printf("total %llu nodes in %.3f s, %.1f Mnps\n", static_cast<unsigned long long>(totalNodes), totalSeconds,
+				totalNodes / std::max(totalSeconds, 1e-9) / 1e6);
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
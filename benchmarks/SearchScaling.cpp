@@ -0,0 +1,125 @@
+/**
+* @file SearchScaling.cpp
+*
+* @brief Parallel search benchmark. Searches a set of positions to a fixed depth with
+*        1, 2, 4 and so on up to the given number of threads, and reports the nodes per
+*        second and the time to reach the depth of every thread count, and both of them
+*        relative to one thread. Every search starts from a cleared transposition table.
+*
+* Usage: searchbench [--threads 32] [--depth 10] [--hash 256] [--no-huge-pages] [--fen "<fen>"]
+*
+* @author Aleksander Solhaug
+*/
+
+#include "BenchmarkPositions.h"
+
+#include <Search.h>
+#include <tclap/CmdLine.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+	const char* const Positions[] = {
+		BenchmarkPositions::StartFen,
+		BenchmarkPositions::KiwipeteFen,
+		BenchmarkPositions::Position6Fen,
+		"r1bq1rk1/pp2bppp/2n1pn2/2pp4/3P4/2PBPN2/PP1N1PPP/R1BQ1RK1 w - - 0 8",
+		BenchmarkPositions::Position3Fen,
+	};
+
+	struct Measurement {
+		double Seconds = 0.0;
+		std::uint64_t Nodes = 0;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	int maxThreads = 0;
+	int depth = 0;
+	std::size_t hashMegabytes = 0;
+	bool hugePages = true;
+	std::string fen;
+	try {
+		TCLAP::CmdLine cmd("Searches positions to a fixed depth with a growing number of threads", ' ', "1.0");
+		TCLAP::ValueArg<int> threadsArg("t", "threads", "Most threads to search with, 0 for all cores", false, 0, "int");
+		TCLAP::ValueArg<int> depthArg("d", "depth", "Depth every position is searched to", false, 9, "int");
+		TCLAP::ValueArg<std::size_t> hashArg("", "hash", "MB of transposition table shared by the threads", false, 64, "MB");
+		TCLAP::SwitchArg smallPagesArg("", "no-huge-pages", "Back the transposition table with normal pages");
+		TCLAP::ValueArg<std::string> fenArg("f", "fen", "Position to search instead of the standard ones", false, "", "fen");
+
+		cmd.add(threadsArg);
+		cmd.add(depthArg);
+		cmd.add(hashArg);
+		cmd.add(smallPagesArg);
+		cmd.add(fenArg);
+		cmd.parse(argc, argv);
+
+		maxThreads = threadsArg.getValue();
+		depth = depthArg.getValue();
+		hashMegabytes = hashArg.getValue();
+		hugePages = !smallPagesArg.getValue();
+		fen = fenArg.getValue();
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (maxThreads <= 0)
+		maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	std::vector<Position> positions;
+	std::vector<std::string> fens(std::begin(Positions), std::end(Positions));
+	if (!fen.empty())
+		fens = { fen };
+	for (const std::string& text : fens) {
+		positions.emplace_back();
+		if (!positions.back().SetFen(text)) {
+			std::printf("Invalid FEN %s\n", text.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	//Powers of two up to the most threads, which is measured too when it is not one
+	std::vector<int> threadCounts;
+	for (int threads = 1; threads < maxThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(maxThreads);
+
+	Search search;
+	if (!search.SetHashSize(hashMegabytes, hugePages))
+		return EXIT_FAILURE;
+	SearchLimits limits;
+	limits.MaxDepth = depth;
+
+	std::printf("depth %d, %zu MB hash on %s pages, %zu positions\n", depth, hashMegabytes, hugePages ? "huge" : "normal",
+				positions.size());
+	std::printf("%7s %14s %9s %9s %12s %10s\n", "threads", "nodes", "seconds", "Mnps", "nps scaling", "speedup");
+	Measurement single;
+	for (const int threads : threadCounts) {
+		search.SetThreadCount(threads);
+		Measurement total;
+		for (const Position& position : positions) {
+			search.ClearHash();
+			const SearchResult result = search.Run(position, limits);
+			total.Seconds += result.Seconds;
+			total.Nodes += result.Nodes;
+		}
+		if (threads == 1)
+			single = total;
+
+		//The speedup is in time to depth, which helpers only improve by the work they save the main thread
+		const double nps = total.Nodes / std::max(total.Seconds, 1e-9);
+		const double singleNps = single.Nodes / std::max(single.Seconds, 1e-9);
+		std::printf("%7d %14llu %9.3f %9.2f %11.2fx %9.2fx\n", threads, static_cast<unsigned long long>(total.Nodes),
+					total.Seconds, nps / 1e6, nps / singleNps, single.Seconds / std::max(total.Seconds, 1e-9));
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,283 @@
+/**
+* @file BookBuilder.cpp
+*
+* @brief Command line tool that turns collections of games in PGN into a Polyglot
+*        opening book. The files are memory mapped and split into games, which the
+*        threads take in turns. Every thread counts the moves of its games by
+*        position on its own, and the counts of all threads are merged at the end.
+*        A move is weighted by the points it scored, two for a win and one for a
+*        draw, and moves that never scored are left out.
+*
+* Usage: bookbuild -o book.bin [--threads 0] [--max-ply 24] [--min-games 1] games.pgn [more.pgn ...]
+*
+* @author Aleksander Solhaug
+*/
+
+#include <OpeningBook.h>
+#include <MappedFile.h>
+#include <tclap/CmdLine.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+//Times a move was played in a position and the points it scored
+struct MoveCount {
+	std::uint64_t Key;
+	std::uint16_t EncodedMove;
+	std::uint32_t Games;
+	std::uint32_t Points;
+};
+
+enum GameResult { WhiteWins, BlackWins, Draw, UnknownResult };
+
+/**
+* @brief Splits the text of a PGN file into its games. A game starts with the first
+*        tag after the moves of the game before it
+*/
+static void SplitGames(std::string_view text, std::vector<std::string_view>& games)
+{
+	std::size_t gameStart = 0;
+	bool inMoves = false;
+	std::size_t lineStart = 0;
+	while (lineStart < text.size()) {
+		std::size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos)
+			lineEnd = text.size();
+		const std::size_t first = text.find_first_not_of(" \t\r", lineStart);
+		if (first < lineEnd) {
+			if (text[first] == '[') {
+				if (inMoves) {
+					games.push_back(text.substr(gameStart, lineStart - gameStart));
+					gameStart = lineStart;
+					inMoves = false;
+				}
+			}
+			else inMoves = true;
+		}
+		lineStart = lineEnd + 1;
+	}
+	if (gameStart < text.size())
+		games.push_back(text.substr(gameStart));
+}
+
+//Value of a tag of the game, empty when the game does not have it
+static std::string_view GetTag(std::string_view game, std::string_view name)
+{
+	const std::string key = "[" + std::string(name) + " \"";
+	const std::size_t start = game.find(key);
+	if (start == std::string_view::npos)
+		return {};
+	const std::size_t valueStart = start + key.size();
+	const std::size_t valueEnd = game.find('"', valueStart);
+	return valueEnd == std::string_view::npos ? std::string_view() : game.substr(valueStart, valueEnd - valueStart);
+}
+
+static GameResult ParseResult(std::string_view result)
+{
+	if (result == "1-0")
+		return WhiteWins;
+	if (result == "0-1")
+		return BlackWins;
+	if (result == "1/2-1/2")
+		return Draw;
+	return UnknownResult;
+}
+
+/**
+* @brief Plays the moves of a game and counts every one of its first plies
+*
+* @param game - Text of the game, its tags and its moves
+* @param maxPly - Plies of the game counted
+* @param counts - Counts of the moves, one added for every ply of a counted game
+* @return bool - Whether the game was counted, games without a result or with a
+*                move that can not be read are not and add nothing to the counts
+*/
+static bool CountGame(std::string_view game, int maxPly, std::vector<MoveCount>& counts)
+{
+	const GameResult result = ParseResult(GetTag(game, "Result"));
+	if (result == UnknownResult)
+		return false;
+	Position position;
+	const std::string_view fen = GetTag(game, "FEN");
+	if (!fen.empty() && !position.SetFen(std::string(fen)))
+		return false;
+
+	//The moves start on the first line that is not a tag, comments among them may hold brackets too
+	std::size_t i = 0;
+	while (i < game.size()) {
+		const std::size_t first = game.find_first_not_of(" \t\r\n", i);
+		if (first == std::string_view::npos || game[first] != '[')
+			break;
+		const std::size_t lineEnd = game.find('\n', first);
+		i = lineEnd == std::string_view::npos ? game.size() : lineEnd + 1;
+	}
+	//The counts of the game are taken back when one of its moves can not be read
+	const std::size_t firstCount = counts.size();
+	int ply = 0;
+	int depth = 0;		//Of the variations around the current token, only the main line is counted
+	while (i < game.size() && ply < maxPly) {
+		const char c = game[i];
+		if (c == '{') {
+			const std::size_t end = game.find('}', i);
+			i = end == std::string_view::npos ? game.size() : end + 1;
+			continue;
+		}
+		if (c == ';') {
+			const std::size_t end = game.find('\n', i);
+			i = end == std::string_view::npos ? game.size() : end + 1;
+			continue;
+		}
+		if (c == '(' || c == ')') {
+			depth += c == '(' ? 1 : -1;
+			i++;
+			continue;
+		}
+		if (std::strchr(" \t\r\n", c)) {
+			i++;
+			continue;
+		}
+
+		const std::size_t end = std::min(game.find_first_of(" \t\r\n{}();", i), game.size());
+		std::string_view token = game.substr(i, end - i);
+		//A closing brace without an opening one is skipped on its own
+		i = std::max(end, i + 1);
+		if (token.empty() || depth > 0 || token[0] == '$')
+			continue;
+		//Results end the game, move numbers like 12. and 12... may be written against the move
+		if (token == "*" || ParseResult(token) != UnknownResult)
+			break;
+		const std::size_t moveStart = token.find_first_not_of("0123456789.");
+		if (moveStart == std::string_view::npos)
+			continue;
+		token.remove_prefix(moveStart);
+
+		const Move move = position.ParseSanMove(std::string(token));
+		if (move.IsNull()) {
+			counts.resize(firstCount);
+			return false;
+		}
+		const Color mover = position.GetSideToMove();
+		const std::uint32_t points = result == Draw ? 1 : (result == WhiteWins) == (mover == White) ? 2 : 0;
+		counts.push_back({ OpeningBook::GetKey(position), OpeningBook::EncodeMove(move), 1, points });
+		MoveUndo undo;
+		position.MakeMove(move, undo);
+		ply++;
+	}
+	return true;
+}
+
+//Sorts the counts by position and move and adds up the counts of the same move
+static void MergeCounts(std::vector<MoveCount>& counts)
+{
+	std::sort(counts.begin(), counts.end(), [](const MoveCount& a, const MoveCount& b) {
+		return a.Key != b.Key ? a.Key < b.Key : a.EncodedMove < b.EncodedMove;
+	});
+	std::size_t merged = 0;
+	for (std::size_t i = 0; i < counts.size(); i++) {
+		if (merged > 0 && counts[merged - 1].Key == counts[i].Key && counts[merged - 1].EncodedMove == counts[i].EncodedMove) {
+			counts[merged - 1].Games += counts[i].Games;
+			counts[merged - 1].Points += counts[i].Points;
+		}
+		else counts[merged++] = counts[i];
+	}
+	counts.resize(merged);
+}
+
+int main(int argc, char* argv[])
+{
+	std::string output;
+	std::vector<std::string> inputs;
+	int threadCount = 0, maxPly = 24, minGames = 1;
+	try {
+		TCLAP::CmdLine cmd("Builds a Polyglot opening book from games in PGN", ' ', "1.0");
+		TCLAP::ValueArg<std::string> outputArg("o", "output", "Book file to write", true, "", "path");
+		TCLAP::ValueArg<int> threadsArg("t", "threads", "Threads reading the games, 0 for all cores", false, 0, "int");
+		TCLAP::ValueArg<int> plyArg("p", "max-ply", "Plies of every game put into the book", false, 24, "int");
+		TCLAP::ValueArg<int> gamesArg("g", "min-games", "Games a move has to be played in to be put into the book", false, 1, "int");
+		TCLAP::UnlabeledMultiArg<std::string> inputArg("pgn", "PGN files to read the games from", true, "path");
+		cmd.add(outputArg);
+		cmd.add(threadsArg);
+		cmd.add(plyArg);
+		cmd.add(gamesArg);
+		cmd.add(inputArg);
+		cmd.parse(argc, argv);
+
+		output = outputArg.getValue();
+		inputs = inputArg.getValue();
+		threadCount = threadsArg.getValue();
+		maxPly = std::max(1, plyArg.getValue());
+		minGames = std::max(1, gamesArg.getValue());
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (threadCount <= 0)
+		threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	if (!OpeningBook::HasStandardKeys()) {
+		std::cout << "The Polyglot random numbers do not give the published keys\n";
+		return EXIT_FAILURE;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<MappedFile> files(inputs.size());
+	std::vector<std::string_view> games;
+	for (std::size_t i = 0; i < inputs.size(); i++) {
+		if (!files[i].Open(inputs[i]))
+			return EXIT_FAILURE;
+		SplitGames(std::string_view(reinterpret_cast<const char*>(files[i].GetData()), files[i].GetSize()), games);
+	}
+
+	//Games differ a lot in length, so the threads take the next game as they finish one instead of a fixed share
+	std::atomic<std::size_t> nextGame(0);
+	std::atomic<std::size_t> countedGames(0);
+	std::vector<std::vector<MoveCount>> threadCounts(threadCount);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; t++)
+		threads.emplace_back([&, t]() {
+			std::vector<MoveCount>& counts = threadCounts[t];
+			std::size_t counted = 0;
+			for (std::size_t game = nextGame++; game < games.size(); game = nextGame++)
+				counted += CountGame(games[game], maxPly, counts);
+			MergeCounts(counts);
+			countedGames += counted;
+		});
+	for (std::thread& thread : threads)
+		thread.join();
+
+	std::vector<MoveCount> counts;
+	for (std::vector<MoveCount>& local : threadCounts) {
+		counts.insert(counts.end(), local.begin(), local.end());
+		std::vector<MoveCount>().swap(local);
+	}
+	MergeCounts(counts);
+
+	//Weights have 16 bits, the points of all moves are scaled down together when the most played one has more
+	std::uint32_t maxPoints = 1;
+	for (const MoveCount& count : counts)
+		if (count.Games >= static_cast<std::uint32_t>(minGames))
+			maxPoints = std::max(maxPoints, count.Points);
+	const double scale = std::min(1.0, 65535.0 / maxPoints);
+	std::vector<OpeningBook::Entry> entries;
+	for (const MoveCount& count : counts) {
+		const auto weight = static_cast<std::uint16_t>(count.Points * scale);
+		if (count.Games >= static_cast<std::uint32_t>(minGames) && weight > 0)
+			entries.push_back({ count.Key, count.EncodedMove, weight, 0 });
+	}
+	if (!OpeningBook::Write(output, entries))
+		return EXIT_FAILURE;
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Read " << countedGames.load() << " of " << games.size() << " games with " << threadCount
+			  << " threads and wrote " << entries.size() << " moves to " << output << " in " << seconds << " s\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/**
+* @file MeshConverter.cpp
+*
+* @brief Command line tool that writes meshes into the binary mesh format,
+*        so they can be memory mapped by MeshFile at runtime.
+*
+* Usage: meshconv --builtin cube|square|grid [--grid-size 8] -o mesh.mesh
+*        meshconv --input piece.obj|piece.glb|piece.mesh --lods 4 -o piece.mesh
+*
+* With --lods, level k > 0 of the LOD chain is written next to the output as
+* <output>_lod<k>.mesh, each level with --ratio of the triangles of the previous.
+*
+* @author Aleksander Solhaug
+*/
+
+#include <GeometricTools.h>
+#include <MeshData.h>
+#include <MeshFile.h>
+#include <MeshImporter.h>
+#include <MeshSimplifier.h>
+#include <tclap/CmdLine.h>
+
+#include <iostream>
+#include <vector>
+
+/**
+* @brief Path for a level of the LOD chain, level 0 keeps the output path
+*/
+static std::string LevelPath(const std::string& output, int level)
+{
+	if (level == 0)
+		return output;
+	const auto dot = output.find_last_of('.');
+	const auto slash = output.find_last_of("/\\");
+	const bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+	const std::string stem = hasExtension ? output.substr(0, dot) : output;
+	const std::string extension = hasExtension ? output.substr(dot) : ".mesh";
+	return stem + "_lod" + std::to_string(level) + extension;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string builtin, input, output;
+	int gridSize = 8, lods = 1;
+	float ratio = 0.5f;
+	try {
+		TCLAP::CmdLine cmd("Converts meshes into the binary mesh format", ' ', "1.0");
+		std::vector<std::string> builtins = { "cube", "square", "grid" };
+		TCLAP::ValuesConstraint<std::string> builtinConstraint(builtins);
+		TCLAP::ValueArg<std::string> builtinArg("b", "builtin", "GeometricTools mesh to convert",
+			true, "cube", &builtinConstraint);
+		TCLAP::ValueArg<std::string> inputArg("i", "input", "Mesh file to convert (.obj, .glb or .mesh)", true, "", "path");
+		TCLAP::ValueArg<int> gridArg("s", "grid-size", "Squares per side of the grid", false, 8, "int");
+		TCLAP::ValueArg<int> lodsArg("l", "lods", "Number of levels of detail to write", false, 1, "int");
+		TCLAP::ValueArg<float> ratioArg("r", "ratio", "Triangles kept from one level to the next", false, 0.5f, "float");
+		TCLAP::ValueArg<std::string> outputArg("o", "output", "Mesh file to write", true, "", "path");
+
+		cmd.xorAdd(builtinArg, inputArg);
+		cmd.add(gridArg);
+		cmd.add(lodsArg);
+		cmd.add(ratioArg);
+		cmd.add(outputArg);
+		cmd.parse(argc, argv);
+
+		builtin = builtinArg.isSet() ? builtinArg.getValue() : "";
+		input = inputArg.getValue();
+		gridSize = gridArg.getValue();
+		lods = lodsArg.getValue();
+		ratio = ratioArg.getValue();
+		output = outputArg.getValue();
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	MeshData mesh;
+	if (!input.empty()) {
+		if (!MeshImporter::Import(input, mesh))
+			return EXIT_FAILURE;
+	}
+	else if (builtin == "cube") {
+		mesh.Vertices.assign(GeometricTools::UnitCube3D.begin(), GeometricTools::UnitCube3D.end());
+		mesh.Indices.assign(GeometricTools::UnitCubeTopology.begin(), GeometricTools::UnitCubeTopology.end());
+		mesh.Layout = BufferLayout({ {ShaderDataType::Float3, "position"} });
+	}
+	else if (builtin == "square") {
+		mesh.Vertices.assign(GeometricTools::UnitSquare2D.begin(), GeometricTools::UnitSquare2D.end());
+		for (float index : GeometricTools::UnitSquareTopology)
+			mesh.Indices.push_back(static_cast<GLuint>(index));
+		mesh.Layout = BufferLayout({ {ShaderDataType::Float2, "position"} });
+	}
+	else {
+		mesh.Vertices = GeometricTools::UnitGridGeometry2DWTCoords(gridSize, gridSize);
+		mesh.Indices = GeometricTools::UnitGridTopologyTriangles(gridSize, gridSize);
+		mesh.Layout = BufferLayout({ {ShaderDataType::Float2, "gridPosition"},
+									 {ShaderDataType::Float2, "gridTextureCords"} });
+	}
+
+	const auto chain = MeshSimplifier::BuildLODChain(mesh, std::max(1, lods), ratio);
+	for (int level = 0; level < static_cast<int>(chain.size()); level++) {
+		const auto path = LevelPath(output, level);
+		if (!chain[level].Write(path))
+			return EXIT_FAILURE;
+		std::cout << "Wrote " << chain[level].GetVertexCount() << " vertices and "
+				  << chain[level].GetTriangleCount() << " triangles to " << path << "\n";
+	}
+	return EXIT_SUCCESS;
+}
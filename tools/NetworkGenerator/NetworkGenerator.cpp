@@ -0,0 +1,52 @@
+/**
+* @file NetworkGenerator.cpp
+*
+* @brief Command line tool that writes a network file the engine can evaluate with
+*        before a trained network exists. The piece-square part of the network holds
+*        the middlegame values of the handcrafted evaluation, the other layers hold
+*        seeded noise, which only reaches the score when --noise is above 0.
+*
+* Usage: nnuegen -o chess.nnue [--seed 1] [--noise 0]
+*
+* @author Aleksander Solhaug
+*/
+
+#include <Nnue.h>
+#include <tclap/CmdLine.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[])
+{
+	std::string output;
+	unsigned int seed = 1;
+	int noise = 0;
+	try {
+		TCLAP::CmdLine cmd("Writes a piece-square network into the network file format", ' ', "1.0");
+		TCLAP::ValueArg<std::string> outputArg("o", "output", "Network file to write", true, "", "path");
+		TCLAP::ValueArg<unsigned int> seedArg("s", "seed", "Seed of the weights of the hidden layers", false, 1, "int");
+		TCLAP::ValueArg<int> noiseArg("n", "noise", "Largest output weight of the hidden layers, 0 for none", false, 0, "int");
+		cmd.add(outputArg);
+		cmd.add(seedArg);
+		cmd.add(noiseArg);
+		cmd.parse(argc, argv);
+
+		output = outputArg.getValue();
+		seed = seedArg.getValue();
+		noise = std::clamp(noiseArg.getValue(), 0, 127);
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const Nnue::NetworkWeights weights = Nnue::NetworkWeights::Generate(seed, noise);
+	if (!Nnue::Network::Write(output, weights))
+		return EXIT_FAILURE;
+	std::cout << "Wrote the network \"" << weights.Description << "\" to " << output << "\n";
+	return EXIT_SUCCESS;
+}
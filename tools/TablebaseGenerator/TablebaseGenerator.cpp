@@ -0,0 +1,116 @@
+/**
+* @file TablebaseGenerator.cpp
+*
+* @brief Command line tool that generates endgame tablebases into a file the engine
+*        probes while it searches. The endings are given by name, or all of them up
+*        to a number of pieces, and every ending a capture or a promotion leads to is
+*        generated with them. The time and the size of every ending are reported.
+*
+* Usage: tbgen -o endings.tb [--threads 0] [--max-pieces 0] [KQK KRK KBNK KPK ...]
+*
+* @author Aleksander Solhaug
+*/
+
+#include <TablebaseGenerator.h>
+#include <tclap/CmdLine.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//Names of all endings with the given pieces besides the kings, every one of them once or twice
+static void AddEndings(int pieces, std::vector<std::string>& names)
+{
+	const std::string letters = "QRBNP";
+	//The pieces of both sides as indices into the letters, white ones below 5, never decreasing
+	std::vector<int> choice(pieces, 0);
+	while (true) {
+		std::string white, black;
+		for (const int piece : choice)
+			(piece < 5 ? white : black) += letters[piece % 5];
+		names.push_back("K" + white + "K" + black);
+
+		int i = pieces - 1;
+		while (i >= 0 && choice[i] == 9)
+			i--;
+		if (i < 0)
+			break;
+		choice[i]++;
+		for (int j = i + 1; j < pieces; j++)
+			choice[j] = choice[i];
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string output;
+	std::vector<std::string> names;
+	int threadCount = 0, maxPieces = 0;
+	try {
+		TCLAP::CmdLine cmd("Generates endgame tablebases by retrograde analysis", ' ', "1.0");
+		TCLAP::ValueArg<std::string> outputArg("o", "output", "Tablebase file to write", true, "", "path");
+		TCLAP::ValueArg<int> threadsArg("t", "threads", "Threads generating the endings, 0 for all cores", false, 0, "int");
+		TCLAP::ValueArg<int> piecesArg("p", "max-pieces", "Generate all endings with up to this many pieces, kings included", false, 0, "int");
+		TCLAP::UnlabeledMultiArg<std::string> endingArg("ending", "Endings to generate, like KQK or KRKP. KQK, KRK, KBNK and KPK when none are given",
+														false, "name");
+		cmd.add(outputArg);
+		cmd.add(threadsArg);
+		cmd.add(piecesArg);
+		cmd.add(endingArg);
+		cmd.parse(argc, argv);
+
+		output = outputArg.getValue();
+		threadCount = threadsArg.getValue();
+		maxPieces = piecesArg.getValue();
+		names = endingArg.getValue();
+	}
+	catch (TCLAP::ArgException& e)
+	{
+		std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (maxPieces > Tablebase::MaxPieces) {
+		std::cerr << "Endings have at most " << Tablebase::MaxPieces << " pieces\n";
+		return EXIT_FAILURE;
+	}
+	for (int pieces = 1; pieces <= maxPieces - 2; pieces++)
+		AddEndings(pieces, names);
+	if (names.empty())
+		names = { "KQK", "KRK", "KBNK", "KPK" };
+
+	const auto start = std::chrono::steady_clock::now();
+	Tablebase::Generator generator(threadCount);
+	for (const std::string& name : names)
+		if (!generator.Generate(name)) {
+			std::cerr << name << " is not an ending of up to " << Tablebase::MaxPieces << " pieces\n";
+			return EXIT_FAILURE;
+		}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (!Tablebase::Tables::Write(output, generator.GetTables()))
+		return EXIT_FAILURE;
+
+	//One line per ending, in the order they were generated
+	std::cout << std::left << std::setw(8) << "Ending" << std::right << std::setw(12) << "Positions" << std::setw(7) << "Win %"
+			  << std::setw(7) << "Draw %" << std::setw(7) << "Loss %" << std::setw(8) << "Mate" << std::setw(8) << "Passes"
+			  << std::setw(10) << "KB" << std::setw(10) << "Seconds" << "\n";
+	std::uint64_t totalBytes = 0;
+	const std::vector<Tablebase::TableData>& tables = generator.GetTables();
+	const std::vector<Tablebase::GenerationStats>& stats = generator.GetStats();
+	for (std::size_t i = 0; i < tables.size(); i++) {
+		const Tablebase::GenerationStats& ending = stats[i];
+		const std::uint64_t bytes = 2 * tables[i].Pieces.GetPositionCount();
+		const double percent = ending.Positions > 0 ? 100.0 / ending.Positions : 0.0;
+		totalBytes += bytes;
+		std::cout << std::left << std::setw(8) << tables[i].Pieces.GetName() << std::right << std::setw(12) << ending.Positions
+				  << std::fixed << std::setprecision(1) << std::setw(7) << ending.Wins * percent << std::setw(7)
+				  << ending.Draws * percent << std::setw(7) << ending.Losses * percent << std::setw(8) << ending.LongestMate
+				  << std::setw(8) << ending.Passes << std::setw(10) << bytes / 1024 << std::setprecision(2) << std::setw(10)
+				  << ending.Seconds << "\n";
+	}
+	std::cout << "Generated " << tables.size() << " endings with " << generator.GetThreadCount() << " threads in "
+			  << std::setprecision(2) << seconds << " s and wrote " << totalBytes / 1024 << " KB to " << output << "\n";
+	return EXIT_SUCCESS;
+}